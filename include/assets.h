@@ -0,0 +1,43 @@
+/*
+ * assets.h - Embedded Asset Bundle
+ *
+ * Every file under assets/ is packed by tools/mkbundle.py into one
+ * archive with a hashed index, linked into the .assets section
+ * (__assets_start/__assets_end, see linker.ld). Lookups return
+ * pointers into the image itself; nothing is copied. Data is 16-byte
+ * aligned. Files ending in .txt are string tables: one NUL-terminated
+ * string per line, read with asset_string().
+ *
+ * Layout (must match tools/mkbundle.py):
+ *   asset_header_t, then 'slots' asset_slot_t (open addressing on the
+ *   FNV-1a hash of the name, linear probing), then names and data.
+ */
+
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include "types.h"
+
+#define ASSET_MAGIC         0x444E4241      /* "ABND" */
+#define ASSET_EMPTY         0xFFFFFFFF      /* name_off of an unused slot */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t count;
+    uint32_t slots;             /* Power of two */
+    uint32_t size;              /* Whole bundle, bytes */
+} asset_header_t;
+
+typedef struct {
+    uint32_t hash;              /* FNV-1a of the name */
+    uint32_t name_off;          /* Offsets from the bundle start */
+    uint32_t data_off;
+    uint32_t size;
+} asset_slot_t;
+
+/* Functions */
+bool assets_valid(void);
+const void *asset_find(const char *name, uint32_t *size);
+const char *asset_string(const char *table, uint32_t index);
+
+#endif /* ASSETS_H */
@@ -0,0 +1,32 @@
+/*
+ * bcache.h - SD Block Cache
+ *
+ * Fixed pool of 512-byte blocks with LRU replacement and a hash for
+ * lookup. A miss that continues the previous miss counts as sequential
+ * and pulls in BCACHE_READAHEAD blocks with one multi-block read.
+ * Read-only: the filesystem layer never writes.
+ */
+
+#ifndef BCACHE_H
+#define BCACHE_H
+
+#include "types.h"
+
+#define BCACHE_BLOCKS       128     /* 64 KB */
+#define BCACHE_READAHEAD    16
+#define BCACHE_HASH_SIZE    64
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t readaheads;        /* Multi-block fills */
+    uint32_t prefetched;        /* Blocks brought in ahead of use */
+} bcache_stats_t;
+
+/* Functions */
+void bcache_init(void);
+bool bcache_read(uint32_t lba, uint32_t offset, void *dst, uint32_t len);
+void bcache_invalidate(void);
+void bcache_get_stats(bcache_stats_t *stats);
+
+#endif /* BCACHE_H */
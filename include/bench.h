@@ -0,0 +1,37 @@
+/*
+ * bench.h - In-kernel Benchmarks
+ *
+ * Benchmarks run on demand ('b' over serial, or at boot with
+ * make BENCH_ON_BOOT=1) and report over the UART.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "types.h"
+
+/* Serial command that runs all benchmarks from the main loop */
+#define BENCH_TRIGGER_KEY   'b'
+
+/* Functions */
+void bench_run_all(void);
+void bench_header(const char *title);
+void bench_result(const char *name, uint32_t cores, uint64_t ops, uint64_t ticks);
+void bench_note(const char *name, const char *text);
+
+/* Individual suites */
+void syncbench_run(void);
+void schedbench_run(void);
+void fiberbench_run(void);
+void fsbench_run(void);
+void qoibench_run(void);
+void gpiobench_run(void);
+void fmtbench_run(void);
+void tracebench_run(void);
+void gfxbench_run(void);
+void dlbench_run(void);
+void mboxbench_run(void);
+void ipibench_run(void);
+void membench_run(void);
+
+#endif /* BENCH_H */
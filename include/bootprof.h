@@ -0,0 +1,35 @@
+/*
+ * bootprof.h - Boot Phase Timeline
+ *
+ * Records generic-timer timestamps at the end of each boot phase,
+ * starting from the first instruction of _start (captured in boot.S).
+ */
+
+#ifndef BOOTPROF_H
+#define BOOTPROF_H
+
+#include "types.h"
+
+#define BOOTPROF_MAX_MARKS  16
+
+/* A phase ends at `ticks`; it started at the previous mark */
+typedef struct {
+    const char *name;
+    uint64_t ticks;
+} boot_mark_t;
+
+/* Written by boot.S */
+extern uint64_t boot_ts_entry;
+extern uint64_t boot_ts_bss;
+extern uint64_t boot_ts_stub;   /* LZ4 stub entry, 0 for a plain image */
+
+/* Functions */
+void bootprof_init(void);
+uint32_t boot_mark(const char *name);
+uint32_t bootprof_count(void);
+const boot_mark_t *bootprof_get(uint32_t index);
+uint64_t bootprof_elapsed_us(uint32_t index);
+uint64_t bootprof_phase_us(uint32_t index);
+void bootprof_report(void);
+
+#endif /* BOOTPROF_H */
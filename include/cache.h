@@ -0,0 +1,43 @@
+/*
+ * cache.h - Cache Maintenance
+ *
+ * Range operations on the data and instruction caches by virtual
+ * address (identity mapped, see mmu.h). Line sizes come from CTR_EL0.
+ * All range operations complete (dsb) before returning.
+ *
+ * Memory shared with the VideoCore or a DMA engine either lives in the
+ * non-cacheable .dma section (__dma) or is maintained with these:
+ *   CPU wrote, device reads:    dcache_clean_range() before handing over
+ *   device wrote, CPU reads:    dcache_invalidate_range() before reading
+ *   code written as data:       icache_sync_range() before executing
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "types.h"
+
+/* Place a variable in the non-cacheable .dma section (not zeroed at boot) */
+#define __dma   __attribute__((section(".dma")))
+
+/* Smallest D-cache / I-cache line in bytes (CTR_EL0 DminLine / IminLine) */
+static inline uint32_t dcache_line_size(void) {
+    uint64_t ctr;
+    asm volatile("mrs %0, ctr_el0" : "=r"(ctr));
+    return 4u << ((ctr >> 16) & 0xF);
+}
+
+static inline uint32_t icache_line_size(void) {
+    uint64_t ctr;
+    asm volatile("mrs %0, ctr_el0" : "=r"(ctr));
+    return 4u << (ctr & 0xF);
+}
+
+/* Functions */
+void dcache_clean_range(const void *start, size_t len);
+void dcache_invalidate_range(void *start, size_t len);
+void dcache_clean_invalidate_range(const void *start, size_t len);
+void icache_sync_range(const void *start, size_t len);
+void icache_invalidate_all(void);
+
+#endif /* CACHE_H */
@@ -0,0 +1,47 @@
+/*
+ * cpustat.h - Per-core Idle Accounting
+ *
+ * Every idle loop brackets its wait with cpustat_idle_enter() and
+ * cpustat_idle_exit(): cores 1-3 in their dispatch loop and scheduler
+ * workers, core 0 while its main fiber (fiber_run) has nothing else to
+ * run. Utilization over an interval is 1 - idle / elapsed. Wakeups
+ * count idle exits, the nearest thing to an interrupt rate in this
+ * polled kernel.
+ */
+
+#ifndef CPUSTAT_H
+#define CPUSTAT_H
+
+#include "types.h"
+#include "smp.h"
+#include "timer.h"
+
+/* Written only by its own core */
+typedef struct {
+    volatile uint64_t idle_ticks;       /* Completed idle periods */
+    volatile uint64_t idle_since;       /* Start of the current one, 0 if busy */
+    volatile uint64_t wakeups;
+} __attribute__((aligned(64))) cpustat_t;
+
+extern cpustat_t cpustats[NUM_CORES];
+
+/* No-op if the core is already idle (fiber_run re-enters every pass) */
+static inline void cpustat_idle_enter(uint32_t core) {
+    if (!cpustats[core].idle_since) {
+        cpustats[core].idle_since = timer_ticks();
+    }
+}
+
+static inline void cpustat_idle_exit(uint32_t core) {
+    uint64_t since = cpustats[core].idle_since;
+    if (since) {
+        cpustats[core].idle_ticks += timer_ticks() - since;
+        cpustats[core].idle_since = 0;
+        cpustats[core].wakeups++;
+    }
+}
+
+/* Functions */
+uint64_t cpustat_idle_ticks(uint32_t core);
+
+#endif /* CPUSTAT_H */
@@ -0,0 +1,30 @@
+/*
+ * cursor.h - VideoCore Hardware Cursor
+ *
+ * The firmware composites a small ARGB sprite over the display; it is
+ * not part of the framebuffer. The image is uploaded once with
+ * cursor_init(), after which moving, showing or hiding the cursor is a
+ * single SET_CURSOR_STATE mailbox call and never touches framebuffer
+ * pixels.
+ *
+ * Not every firmware (nor QEMU) implements the cursor tags; callers
+ * should fall back to drawing when cursor_init() fails.
+ */
+
+#ifndef CURSOR_H
+#define CURSOR_H
+
+#include "types.h"
+
+/* Largest cursor image (pixels per side) */
+#define CURSOR_MAX_SIZE     64
+
+/* Functions */
+bool cursor_init(const uint32_t *pixels, uint32_t width, uint32_t height,
+                 uint32_t hot_x, uint32_t hot_y);
+bool cursor_move(uint32_t x, uint32_t y);
+bool cursor_show(bool visible);
+bool cursor_available(void);
+bool cursor_visible(void);
+
+#endif /* CURSOR_H */
@@ -0,0 +1,79 @@
+/*
+ * dlist.h - Tile-binned Display List
+ *
+ * Drawing commands are recorded instead of executed, binned into
+ * DL_TILE_SIZE square screen tiles, and dl_render() then draws each
+ * tile into a per-core scratch buffer that stays in L1 and stores it
+ * to the target exactly once. A clear, a box and the text over them
+ * cost one framebuffer write per pixel instead of three, and the
+ * (non-cacheable) framebuffer sees whole-row bursts instead of
+ * scattered stores.
+ *
+ * An opaque fill covering a whole tile drops the commands binned to
+ * that tile before it. Tiles no command touches are not written; a
+ * tile that is touched but not fully covered is read back from the
+ * target first. Tiles are spread over the cores with parallel_for().
+ */
+
+#ifndef DLIST_H
+#define DLIST_H
+
+#include "types.h"
+#include "gfx.h"
+
+#define DL_TILE_SIZE        64
+#define DL_MAX_TILES        1024        /* 2048x2048 at 64x64 */
+#define DL_MAX_CMDS         1024
+#define DL_MAX_REFS         8192        /* Command-in-tile entries */
+#define DL_TEXT_SIZE        8192        /* Bytes of copied strings */
+
+/* Command types */
+#define DL_FILL             0
+#define DL_RECT             1
+#define DL_LINE             2
+#define DL_TEXT             3
+#define DL_BLIT             4
+
+typedef struct {
+    uint32_t type;
+    int32_t x0, y0, x1, y1;         /* Rect: x, y, w, h; line: endpoints */
+    color_t fg, bg;
+    union {
+        const char *text;
+        const uint32_t *pixels;     /* DL_BLIT, rows of x1 pixels... */
+    };
+    uint32_t stride;                /* ...stride pixels apart */
+} dl_cmd_t;
+
+/* Traffic of the last dl_render() (bytes) */
+typedef struct {
+    uint64_t direct_bytes;          /* Immediate drawing would have stored */
+    uint64_t written_bytes;         /* Tile write-back */
+    uint64_t read_bytes;            /* Partially covered tiles read back */
+    uint32_t tiles_written;
+} dl_stats_t;
+
+typedef struct {
+    const gfx_surface_t *target;
+    uint32_t tiles_x, tiles_y;
+    uint32_t ncmds, nrefs, text_used;
+    bool overflow;                  /* A command did not fit and was dropped */
+    dl_stats_t stats;
+    uint16_t head[DL_MAX_TILES], tail[DL_MAX_TILES];
+    bool covered[DL_MAX_TILES];     /* Fully painted: no read-back */
+    uint16_t ref_cmd[DL_MAX_REFS], ref_next[DL_MAX_REFS];
+    dl_cmd_t cmds[DL_MAX_CMDS];
+    char text[DL_TEXT_SIZE];
+} dlist_t;
+
+/* Functions */
+bool dl_begin(dlist_t *dl, const gfx_surface_t *target);
+bool dl_fill(dlist_t *dl, int32_t x, int32_t y, int32_t w, int32_t h, color_t color);
+bool dl_rect(dlist_t *dl, int32_t x, int32_t y, int32_t w, int32_t h, color_t color);
+bool dl_line(dlist_t *dl, int32_t x0, int32_t y0, int32_t x1, int32_t y1, color_t color);
+bool dl_text(dlist_t *dl, int32_t x, int32_t y, const char *str, color_t fg, color_t bg);
+bool dl_blit(dlist_t *dl, int32_t x, int32_t y, uint32_t w, uint32_t h,
+             const uint32_t *pixels, uint32_t stride);
+void dl_render(dlist_t *dl);
+
+#endif /* DLIST_H */
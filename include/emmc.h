@@ -0,0 +1,81 @@
+/*
+ * emmc.h - SD Card over the EMMC (Arasan SDHCI) Controller
+ *
+ * The SD slot is wired to GPIO 48-53; ALT3 routes it to the Arasan
+ * controller (ALT0 would select the custom SDHOST block). Under QEMU
+ * raspi3b the card given with -drive if=sd sits on the same controller.
+ * Polled, read-only, 512-byte blocks.
+ */
+
+#ifndef EMMC_H
+#define EMMC_H
+
+#include "types.h"
+#include "gpio.h"
+
+/* EMMC Registers */
+#define EMMC_BASE           (PERIPHERAL_BASE + 0x300000)
+
+#define EMMC_ARG2           ((volatile uint32_t*)(EMMC_BASE + 0x00))
+#define EMMC_BLKSIZECNT     ((volatile uint32_t*)(EMMC_BASE + 0x04))
+#define EMMC_ARG1           ((volatile uint32_t*)(EMMC_BASE + 0x08))
+#define EMMC_CMDTM          ((volatile uint32_t*)(EMMC_BASE + 0x0C))
+#define EMMC_RESP0          ((volatile uint32_t*)(EMMC_BASE + 0x10))
+#define EMMC_RESP1          ((volatile uint32_t*)(EMMC_BASE + 0x14))
+#define EMMC_RESP2          ((volatile uint32_t*)(EMMC_BASE + 0x18))
+#define EMMC_RESP3          ((volatile uint32_t*)(EMMC_BASE + 0x1C))
+#define EMMC_DATA           ((volatile uint32_t*)(EMMC_BASE + 0x20))
+#define EMMC_STATUS         ((volatile uint32_t*)(EMMC_BASE + 0x24))
+#define EMMC_CONTROL0       ((volatile uint32_t*)(EMMC_BASE + 0x28))
+#define EMMC_CONTROL1       ((volatile uint32_t*)(EMMC_BASE + 0x2C))
+#define EMMC_INTERRUPT      ((volatile uint32_t*)(EMMC_BASE + 0x30))
+#define EMMC_IRPT_MASK      ((volatile uint32_t*)(EMMC_BASE + 0x34))
+#define EMMC_IRPT_EN        ((volatile uint32_t*)(EMMC_BASE + 0x38))
+#define EMMC_CONTROL2       ((volatile uint32_t*)(EMMC_BASE + 0x3C))
+#define EMMC_SLOTISR_VER    ((volatile uint32_t*)(EMMC_BASE + 0xFC))
+
+/* STATUS Bits */
+#define EMMC_STATUS_CMD_INHIBIT     (1 << 0)
+#define EMMC_STATUS_DAT_INHIBIT     (1 << 1)
+
+/* CONTROL0 Bits */
+#define EMMC_C0_DWIDTH_4            (1 << 1)
+
+/* CONTROL1 Bits */
+#define EMMC_C1_CLK_INTLEN          (1 << 0)
+#define EMMC_C1_CLK_STABLE          (1 << 1)
+#define EMMC_C1_CLK_EN              (1 << 2)
+#define EMMC_C1_CLK_DIV_MASK        0xFFC0
+#define EMMC_C1_TOUNIT_MAX          (0xE << 16)
+#define EMMC_C1_SRST_HC             (1 << 24)
+#define EMMC_C1_SRST_CMD            (1 << 25)
+#define EMMC_C1_SRST_DATA           (1 << 26)
+
+/* INTERRUPT Bits */
+#define EMMC_INT_CMD_DONE           (1 << 0)
+#define EMMC_INT_DATA_DONE          (1 << 1)
+#define EMMC_INT_READ_RDY           (1 << 5)
+#define EMMC_INT_ERR                (1 << 15)
+#define EMMC_INT_CMD_TIMEOUT        (1 << 16)
+#define EMMC_INT_ALL                0xFFFFFFFF
+
+/* Block size used for every transfer */
+#define EMMC_BLOCK_SIZE     512
+
+/* Largest count for one CMD18 (16-bit BLKCNT field) */
+#define EMMC_MAX_BLOCKS     0xFFFF
+
+/* Transfer counters since emmc_init() */
+typedef struct {
+    uint32_t commands;          /* CMD17/CMD18 issued */
+    uint32_t blocks;            /* 512-byte blocks transferred */
+    uint32_t errors;
+} emmc_stats_t;
+
+/* Functions */
+bool emmc_init(void);
+bool emmc_ready(void);
+bool emmc_read(uint32_t lba, uint32_t count, void *buf);
+void emmc_get_stats(emmc_stats_t *stats);
+
+#endif /* EMMC_H */
@@ -0,0 +1,68 @@
+/*
+ * fat32.h - Read-only FAT32
+ *
+ * Mounts the first FAT32 partition of the SD card (or an unpartitioned
+ * FAT32 volume). Paths are '/'-separated, matched case-insensitively
+ * against both an entry's long name and its 8.3 alias (so "PROGRA~1"
+ * finds "Program Files").
+ *
+ * Opening a file walks its cluster chain once and keeps it as a list
+ * of contiguous extents, so reads never touch the FAT again and can
+ * issue one multi-block SD read per extent.
+ */
+
+#ifndef FAT32_H
+#define FAT32_H
+
+#include "types.h"
+
+#define FAT_MAX_EXTENTS     16
+#define FAT_NAME_MAX        64
+#define FAT_ALIAS_MAX       13      /* "NAME.EXT" and the NUL */
+
+/* Directory entry attributes */
+#define FAT_ATTR_READ_ONLY  0x01
+#define FAT_ATTR_HIDDEN     0x02
+#define FAT_ATTR_SYSTEM     0x04
+#define FAT_ATTR_VOLUME_ID  0x08
+#define FAT_ATTR_DIRECTORY  0x10
+#define FAT_ATTR_ARCHIVE    0x20
+#define FAT_ATTR_LFN        0x0F
+
+/* Run of contiguous clusters */
+typedef struct {
+    uint32_t cluster;           /* First cluster of the run */
+    uint32_t count;
+} fat_extent_t;
+
+/* Open file or directory */
+typedef struct {
+    uint32_t size;              /* Bytes (directories: whole chain) */
+    uint32_t pos;
+    uint32_t clusters;          /* Chain length */
+    bool is_dir;
+    bool chain_complete;        /* All clusters are in extents[] */
+    uint32_t nextents;
+    fat_extent_t extents[FAT_MAX_EXTENTS];
+} fat_file_t;
+
+/* Entry returned by fat_readdir() */
+typedef struct {
+    char name[FAT_NAME_MAX];    /* Long name if present, else the alias */
+    char alias[FAT_ALIAS_MAX];  /* 8.3 name */
+    uint32_t size;
+    uint32_t cluster;
+    uint8_t attr;
+} fat_dirent_t;
+
+/* Functions */
+bool fat_mount(void);
+bool fat_mounted(void);
+uint32_t fat_cluster_size(void);
+uint32_t fat_volume_mb(void);
+bool fat_open(const char *path, fat_file_t *file);
+int32_t fat_read(fat_file_t *file, void *buf, uint32_t len);
+bool fat_seek(fat_file_t *file, uint32_t pos);
+bool fat_readdir(fat_file_t *dir, fat_dirent_t *entry);
+
+#endif /* FAT32_H */
@@ -0,0 +1,69 @@
+/*
+ * fiber.h - Cooperative Fibers
+ *
+ * Stackful fibers with a per-core round-robin run queue. A fiber runs
+ * until it calls fiber_yield(), fiber_wait_until() or fiber_sleep_us()
+ * (or returns). Each core's original execution context ("main fiber")
+ * is part of its run queue, so kernel code can yield too.
+ *
+ * Fibers never migrate: they run on the core that created them, and
+ * only that core touches its run queue.
+ */
+
+#ifndef FIBER_H
+#define FIBER_H
+
+#include "types.h"
+
+/* Stack pool */
+#define FIBER_MAX           16
+#define FIBER_STACK_SIZE    8192
+
+/* Longest idle wfe before condition waits are polled again (event stream) */
+#define FIBER_IDLE_POLL_US  100
+
+/* Callee-saved state, layout shared with context.S */
+typedef struct {
+    uint64_t x19_x28[10];
+    uint64_t fp;                /* x29 */
+    uint64_t lr;                /* x30 */
+    uint64_t sp;
+} fiber_context_t;
+
+typedef void (*fiber_fn_t)(void *arg);
+typedef bool (*fiber_cond_t)(void *arg);
+
+/* Fiber states */
+#define FIBER_FREE      0
+#define FIBER_READY     1
+#define FIBER_DONE      2
+
+typedef struct fiber {
+    fiber_context_t ctx;
+    struct fiber *next;         /* Run queue ring */
+    const char *name;
+    fiber_fn_t fn;
+    void *arg;
+    fiber_cond_t wait_fn;       /* Runnable only once this returns true */
+    void *wait_arg;
+    uint64_t wake_at;           /* Runnable only after this tick (0 = any) */
+    uint64_t switches;          /* Times switched in */
+    uint32_t state;
+    uint32_t core;
+    uint8_t *stack;
+} fiber_t;
+
+/* Functions */
+fiber_t *fiber_create(const char *name, fiber_fn_t fn, void *arg);
+void fiber_yield(void);
+void fiber_wait_until(fiber_cond_t cond, void *arg);
+void fiber_sleep_us(uint64_t us);
+void fiber_exit(void);
+void fiber_run(void);
+fiber_t *fiber_self(void);
+uint32_t fiber_count(uint32_t core);
+
+/* context.S */
+void fiber_switch(fiber_context_t *from, fiber_context_t *to);
+
+#endif /* FIBER_H */
@@ -0,0 +1,67 @@
+/*
+ * frame.h - Vsync-paced Frame Scheduler
+ *
+ * frame_fiber() runs one frame per display refresh: every registered
+ * client's update callback with the time since its previous update,
+ * then its render callback while the frame budget allows. Pacing comes
+ * from the firmware's wait-for-vsync tag when frame_init() finds it
+ * working, otherwise from the generic timer at the configured rate.
+ *
+ * The vsync tag blocks inside the mailbox call, so the fiber sleeps
+ * (letting the other fibers run) until FRAME_VSYNC_LEAD_US before the
+ * predicted vsync and only blocks for the remainder.
+ *
+ * A render is skipped when the client's recent cost would take the
+ * frame past its budget; a client is never skipped more than
+ * FRAME_MAX_SKIPS frames in a row. Frame-to-frame intervals go into a
+ * histogram, printed with 'f' over serial.
+ */
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include "types.h"
+
+/* Serial command: print the frame statistics */
+#define FRAME_STATS_KEY         'f'
+
+/* Timer-paced rate without vsync (make FRAME_HZ=n) */
+#ifndef FRAME_HZ
+#define FRAME_HZ                60
+#endif
+
+/* Work budget as a share of the frame period */
+#define FRAME_BUDGET_PCT        75
+
+#define FRAME_MAX_CLIENTS       8
+#define FRAME_MAX_SKIPS         4
+#define FRAME_VSYNC_LEAD_US     2000
+
+/* Interval histogram: 1 ms buckets, the last one collects the rest */
+#define FRAME_HIST_BUCKETS      34
+
+/* Advances client state; dt_us covers any skipped renders */
+typedef void (*frame_update_fn)(uint64_t dt_us, void *arg);
+/* Draws the client; may be skipped to stay within the budget */
+typedef void (*frame_render_fn)(void *arg);
+
+typedef struct {
+    uint64_t frames;
+    uint64_t missed;            /* Refreshes passed without a frame */
+    uint64_t overruns;          /* Frames whose work exceeded the budget */
+    uint64_t skipped;           /* Renders skipped for the budget */
+    uint64_t max_work_ticks;
+    uint64_t total_work_ticks;
+    uint32_t hist[FRAME_HIST_BUCKETS];
+} frame_stats_t;
+
+/* Functions */
+void frame_init(uint32_t hz);
+bool frame_register(const char *name, frame_update_fn update, frame_render_fn render, void *arg);
+bool frame_vsync(void);
+uint32_t frame_period_us(void);
+const frame_stats_t *frame_get_stats(void);
+void frame_report(void);
+void frame_fiber(void *arg);
+
+#endif /* FRAME_H */
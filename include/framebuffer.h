@@ -44,7 +44,11 @@ framebuffer_t *fb_get_info(void);
 void fb_put_pixel(uint32_t x, uint32_t y, color_t color);
 void fb_fill_rect(uint32_t x, uint32_t y, uint32_t w, uint32_t h, color_t color);
 void fb_clear(color_t color);
+const uint8_t *fb_glyph(char c);
 void fb_draw_char(uint32_t x, uint32_t y, char c, color_t fg, color_t bg);
 void fb_draw_string(uint32_t x, uint32_t y, const char *str, color_t fg, color_t bg);
+size_t fb_printf(uint32_t x, uint32_t y, color_t fg, color_t bg, const char *fmt, ...)
+    __attribute__((format(printf, 5, 6)));
+bool fb_draw_qoi(uint32_t x, uint32_t y, const uint8_t *data, uint32_t size);
 
 #endif /* FRAMEBUFFER_H */
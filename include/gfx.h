@@ -0,0 +1,61 @@
+/*
+ * gfx.h - 2D Primitives
+ *
+ * Lines, rectangles, rounded rectangles, circles and polygons, drawn
+ * into a surface: the screen (gfx_screen) or any 32-bit pixel buffer.
+ * Every primitive is broken into horizontal spans which are clipped
+ * once and filled with 64-bit stores, so no shape goes through
+ * fb_put_pixel(). Coordinates are signed screen coordinates; shapes
+ * may extend past the surface.
+ *
+ * Text uses the framebuffer font (fb_glyph) with an opaque background.
+ * Outlines are one pixel wide. Polygons are filled with the even-odd
+ * rule (concave and self-intersecting shapes work), sampling pixel
+ * centres with a top-left rule so shared edges are not drawn twice.
+ */
+
+#ifndef GFX_H
+#define GFX_H
+
+#include "types.h"
+#include "framebuffer.h"
+
+/* Most vertices gfx_fill_polygon() accepts */
+#define GFX_POLY_MAX        64
+
+/* 32-bit pixel target */
+typedef struct {
+    uint32_t *pixels;       /* Pixel at (x, y) */
+    uint32_t stride;        /* Pixels per row */
+    int32_t x, y;           /* Screen position of the top-left pixel */
+    uint32_t width, height;
+} gfx_surface_t;
+
+typedef struct {
+    int32_t x, y;
+} gfx_point_t;
+
+/* color_t as stored in the framebuffer (BGRA bytes, little endian) */
+static inline uint32_t gfx_pixel(color_t c) {
+    return ((uint32_t)c.a << 24) | ((uint32_t)c.r << 16) | ((uint32_t)c.g << 8) | c.b;
+}
+
+/* Functions */
+void gfx_screen(gfx_surface_t *s);
+void gfx_fill_words(uint32_t *dst, uint32_t count, uint32_t pixel);
+void gfx_hspan(const gfx_surface_t *s, int32_t x0, int32_t x1, int32_t y, uint32_t pixel);
+void gfx_line(const gfx_surface_t *s, int32_t x0, int32_t y0, int32_t x1, int32_t y1, color_t color);
+void gfx_rect(const gfx_surface_t *s, int32_t x, int32_t y, int32_t w, int32_t h, color_t color);
+void gfx_fill_rect(const gfx_surface_t *s, int32_t x, int32_t y, int32_t w, int32_t h, color_t color);
+void gfx_round_rect(const gfx_surface_t *s, int32_t x, int32_t y, int32_t w, int32_t h,
+                    int32_t r, color_t color);
+void gfx_fill_round_rect(const gfx_surface_t *s, int32_t x, int32_t y, int32_t w, int32_t h,
+                         int32_t r, color_t color);
+void gfx_circle(const gfx_surface_t *s, int32_t cx, int32_t cy, int32_t r, color_t color);
+void gfx_fill_circle(const gfx_surface_t *s, int32_t cx, int32_t cy, int32_t r, color_t color);
+void gfx_text(const gfx_surface_t *s, int32_t x, int32_t y, const char *str,
+              color_t fg, color_t bg);
+void gfx_polygon(const gfx_surface_t *s, const gfx_point_t *pts, uint32_t n, color_t color);
+bool gfx_fill_polygon(const gfx_surface_t *s, const gfx_point_t *pts, uint32_t n, color_t color);
+
+#endif /* GFX_H */
@@ -0,0 +1,47 @@
+/*
+ * governor.h - ARM Clock Governor
+ *
+ * Sets CLOCK_ID_ARM through the mailbox clock tags according to a
+ * policy, with a thermal cap that steps the clock down when the SoC
+ * runs hot and back up once it cools.
+ */
+
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include "types.h"
+
+/* Policies */
+typedef enum {
+    GOV_PERFORMANCE,            /* Always max (thermal cap permitting) */
+    GOV_ONDEMAND,               /* Max while busy, min while idle */
+    GOV_POWERSAVE               /* Always min */
+} gov_policy_t;
+
+/* Thermal back-off (millidegrees C) and step size */
+#define GOV_TEMP_HOT        75000
+#define GOV_TEMP_COOL       65000
+#define GOV_THERMAL_STEP    100000000   /* 100 MHz */
+
+/* Governor state */
+typedef struct {
+    gov_policy_t policy;
+    uint32_t min_rate;          /* Hz, from firmware */
+    uint32_t max_rate;
+    uint32_t cap;               /* Thermal ceiling, min..max */
+    uint32_t rate;              /* Rate last set (as reported back) */
+    bool busy;
+    uint32_t transitions;       /* Number of SET_CLOCK_RATE calls */
+} governor_t;
+
+/* Functions */
+bool governor_init(gov_policy_t policy);
+void governor_set_policy(gov_policy_t policy);
+void governor_busy(void);
+void governor_idle(void);
+void governor_thermal(uint32_t temp_mc);
+const governor_t *governor_get(void);
+const char *governor_policy_name(gov_policy_t policy);
+gov_policy_t governor_parse_policy(const char *name);
+
+#endif /* GOVERNOR_H */
@@ -1,8 +1,15 @@
 /*
- * gpio.h - BCM2710 GPIO Definitions
+ * gpio.h - BCM2710 GPIO Definitions and Driver
  * 
  * Note: Pi Zero 2 W uses BCM2710 which has peripheral base at 0x3F000000
  * (same as BCM2835/2836 low peripheral mode, NOT the 0xFE000000 of BCM2711)
+ *
+ * Pins 0-53 are split into bank 0 (0-31) and bank 1 (32-53). Output and
+ * input go through whole-bank masks: one GPSET/GPCLR store changes any
+ * number of pins of a bank at once, one GPLEV load reads them all. The
+ * mask operations are inline and lock-free (the set/clear registers
+ * only affect the bits written); configuration is read-modify-write and
+ * serialized in gpio.c.
  */
 
 #ifndef GPIO_H
@@ -32,10 +39,27 @@
 #define GPLEV0              ((volatile uint32_t*)(GPIO_BASE + 0x34))
 #define GPLEV1              ((volatile uint32_t*)(GPIO_BASE + 0x38))
 
+#define GPEDS0              ((volatile uint32_t*)(GPIO_BASE + 0x40))
+#define GPEDS1              ((volatile uint32_t*)(GPIO_BASE + 0x44))
+
+#define GPREN0              ((volatile uint32_t*)(GPIO_BASE + 0x4C))
+#define GPFEN0              ((volatile uint32_t*)(GPIO_BASE + 0x58))
+#define GPHEN0              ((volatile uint32_t*)(GPIO_BASE + 0x64))
+#define GPLEN0              ((volatile uint32_t*)(GPIO_BASE + 0x70))
+#define GPAREN0             ((volatile uint32_t*)(GPIO_BASE + 0x7C))
+#define GPAFEN0             ((volatile uint32_t*)(GPIO_BASE + 0x88))
+
 #define GPPUD               ((volatile uint32_t*)(GPIO_BASE + 0x94))
 #define GPPUDCLK0           ((volatile uint32_t*)(GPIO_BASE + 0x98))
 #define GPPUDCLK1           ((volatile uint32_t*)(GPIO_BASE + 0x9C))
 
+/* Per-bank register: GPIO_BANK_REG(GPSET0, 1) == GPSET1 */
+#define GPIO_BANK_REG(reg0, bank)   ((reg0) + (bank))
+
+#define GPIO_NUM_PINS       54
+#define GPIO_BANK(pin)      ((pin) >> 5)
+#define GPIO_BIT(pin)       (1u << ((pin) & 31))
+
 /* GPIO Function Select Values */
 #define GPIO_FUNC_INPUT     0
 #define GPIO_FUNC_OUTPUT    1
@@ -46,6 +70,19 @@
 #define GPIO_FUNC_ALT4      3
 #define GPIO_FUNC_ALT5      2
 
+/* GPPUD values */
+#define GPIO_PULL_NONE      0
+#define GPIO_PULL_DOWN      1
+#define GPIO_PULL_UP        2
+
+/* Event detect sources (gpio_enable_events), latched in GPEDS */
+#define GPIO_EVENT_RISING           (1 << 0)    /* Synchronous edges */
+#define GPIO_EVENT_FALLING          (1 << 1)
+#define GPIO_EVENT_HIGH             (1 << 2)    /* Levels */
+#define GPIO_EVENT_LOW              (1 << 3)
+#define GPIO_EVENT_ASYNC_RISING     (1 << 4)    /* Unsampled, short pulses */
+#define GPIO_EVENT_ASYNC_FALLING    (1 << 5)
+
 /* Delay function */
 static inline void delay(uint32_t count) {
     while (count--) {
@@ -53,4 +90,59 @@ static inline void delay(uint32_t count) {
     }
 }
 
+/* Drive the masked pins of a bank high / low: one store */
+static inline void gpio_set_mask(uint32_t bank, uint32_t mask) {
+    *GPIO_BANK_REG(GPSET0, bank) = mask;
+}
+
+static inline void gpio_clear_mask(uint32_t bank, uint32_t mask) {
+    *GPIO_BANK_REG(GPCLR0, bank) = mask;
+}
+
+/* Masked pins take the matching bits of value, others are untouched */
+static inline void gpio_write_mask(uint32_t bank, uint32_t mask, uint32_t value) {
+    uint32_t set = mask & value;
+    uint32_t clr = mask & ~value;
+    if (set) {
+        *GPIO_BANK_REG(GPSET0, bank) = set;
+    }
+    if (clr) {
+        *GPIO_BANK_REG(GPCLR0, bank) = clr;
+    }
+}
+
+static inline void gpio_write(uint32_t pin, bool high) {
+    if (high) {
+        gpio_set_mask(GPIO_BANK(pin), GPIO_BIT(pin));
+    } else {
+        gpio_clear_mask(GPIO_BANK(pin), GPIO_BIT(pin));
+    }
+}
+
+/* Levels of all pins of a bank */
+static inline uint32_t gpio_read_bank(uint32_t bank) {
+    return *GPIO_BANK_REG(GPLEV0, bank);
+}
+
+static inline bool gpio_read(uint32_t pin) {
+    return (gpio_read_bank(GPIO_BANK(pin)) & GPIO_BIT(pin)) != 0;
+}
+
+/* Latched events of a bank; acknowledge with gpio_clear_events() */
+static inline uint32_t gpio_events(uint32_t bank) {
+    return *GPIO_BANK_REG(GPEDS0, bank);
+}
+
+static inline void gpio_clear_events(uint32_t bank, uint32_t mask) {
+    *GPIO_BANK_REG(GPEDS0, bank) = mask;    /* Write 1 to clear */
+}
+
+/* Functions */
+void gpio_set_function(uint32_t pin, uint32_t func);
+void gpio_set_function_mask(uint32_t bank, uint32_t mask, uint32_t func);
+void gpio_set_pull_mask(uint32_t bank, uint32_t mask, uint32_t pull);
+void gpio_set_pull(uint32_t pin, uint32_t pull);
+void gpio_enable_events(uint32_t bank, uint32_t mask, uint32_t events);
+void gpio_disable_events(uint32_t bank, uint32_t mask, uint32_t events);
+
 #endif /* GPIO_H */
@@ -0,0 +1,57 @@
+/*
+ * ipi.h - Inter-core Messages over the BCM2836 Local Mailboxes
+ *
+ * The ARM-local block gives each core four 32-bit mailboxes. Mailbox
+ * N of core C carries messages from core N to core C, so every
+ * sender/receiver pair has its own register and no lock is needed: a
+ * sender waits until the register is clear, sets the message bits and
+ * issues sev; the receiver reads the message, writes it back to clear
+ * it and dispatches on the type.
+ *
+ * A message is a 4-bit type in bits 0-3 and either a 28-bit value
+ * (IPI_MSG) or a 16-byte aligned pointer below 4 GB (IPI_PTR_MSG).
+ *
+ * The kernel keeps IRQs masked, so messages are handled where a core
+ * polls: the wfe loops of cores 1-3 (dispatch loop and scheduler
+ * workers) and core 0's main fiber. The mailbox interrupt is still
+ * enabled in the local controller, so a core in wfi wakes as well.
+ */
+
+#ifndef IPI_H
+#define IPI_H
+
+#include "types.h"
+#include "smp.h"
+
+/* ARM-local peripherals */
+#define ARM_LOCAL_BASE          0x40000000ul
+#define LOCAL_MBOX_CTRL(core)   ((volatile uint32_t *)(ARM_LOCAL_BASE + 0x50 + 4 * (core)))
+#define LOCAL_MBOX_SET(core, n) ((volatile uint32_t *)(ARM_LOCAL_BASE + 0x80 + 16 * (core) + 4 * (n)))
+#define LOCAL_MBOX_CLR(core, n) ((volatile uint32_t *)(ARM_LOCAL_BASE + 0xC0 + 16 * (core) + 4 * (n)))
+
+/* Message types */
+#define IPI_CALL                1       /* Pointer to an smp_call item */
+#define IPI_PING                2       /* Value echoed back as IPI_PONG */
+#define IPI_PONG                3
+#define IPI_TYPE_USER           4       /* First type free for ipi_register() */
+#define IPI_TYPES               16
+
+#define IPI_TYPE_MASK           0xF
+#define IPI_MSG(type, value)    (((uint32_t)(value) << 4) | (type))
+#define IPI_PTR_MSG(type, ptr)  ((uint32_t)(uint64_t)(ptr) | (type))
+#define IPI_VALUE(msg)          ((msg) >> 4)
+#define IPI_PTR(msg)            ((void *)(uint64_t)((msg) & ~IPI_TYPE_MASK))
+
+/* Message handler: runs on the receiving core at its poll point */
+typedef void (*ipi_handler_t)(uint32_t from, uint32_t msg);
+
+/* Functions */
+void ipi_init(void);
+bool ipi_register(uint32_t type, ipi_handler_t handler);
+bool ipi_send(uint32_t core, uint32_t msg);
+uint32_t ipi_poll(void);
+bool ipi_pending(void);
+bool ipi_ping(uint32_t core);
+bool smp_call(uint32_t core, smp_fn_t fn, void *arg);
+
+#endif /* IPI_H */
@@ -0,0 +1,44 @@
+/*
+ * kprintf.h - Formatted Output
+ *
+ * printf-style formatting in one pass over the format string, straight
+ * into a caller buffer (kformat) or a sink (kprintf to the UART,
+ * fb_printf to the screen). No intermediate strcat: literal runs go out
+ * as one chunk, each conversion is built in a small stack buffer.
+ *
+ * Conversions: %d %i %u %x %X %p %s %c %%
+ * Flags:       '-' (left-align), '0' (zero pad)
+ * Width:       number or '*'
+ * Precision:   '.N' or '.*' - minimum digits for integers (so fixed
+ *              point is "%u.%03u"), maximum characters for %s
+ * Length:      l, ll, z (64-bit); default 32-bit
+ *
+ * Decimal conversion uses a two-digit table and constant divisors
+ * (compiled to multiply-high by the reciprocal, no udiv); hex is
+ * shifts and masks.
+ */
+
+#ifndef KPRINTF_H
+#define KPRINTF_H
+
+#include "types.h"
+#include "stdarg.h"
+
+/* Receives formatted output in chunks (not NUL-terminated) */
+typedef void (*ksink_t)(void *ctx, const char *s, size_t len);
+
+/* Room for any 64-bit number in any supported base */
+#define KFMT_NUM_MAX    24
+
+/* Functions */
+size_t kvprintf_sink(ksink_t sink, void *ctx, const char *fmt, va_list ap);
+size_t kformat(char *buf, size_t size, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+size_t kvformat(char *buf, size_t size, const char *fmt, va_list ap);
+size_t kprintf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/* Number to digits, written backwards ending at @end; returns the first digit */
+char *kfmt_dec(char *end, uint64_t value);
+char *kfmt_hex(char *end, uint64_t value, bool upper);
+
+#endif /* KPRINTF_H */
@@ -14,21 +14,17 @@
 
 /* Initialize ACT LED GPIO as output */
 static inline void led_init(void) {
-    /* GPIO 29 is in GPFSEL2 (pins 20-29), bits 27-29 */
-    uint32_t sel = *GPFSEL2;
-    sel &= ~(7 << 27);          /* Clear bits 27-29 */
-    sel |= (1 << 27);           /* Set as output (001) */
-    *GPFSEL2 = sel;
+    gpio_set_function(ACT_LED_PIN, GPIO_FUNC_OUTPUT);
 }
 
 /* Turn LED on (active low) */
 static inline void led_on(void) {
-    *GPCLR0 = (1 << ACT_LED_PIN);
+    gpio_clear_mask(GPIO_BANK(ACT_LED_PIN), GPIO_BIT(ACT_LED_PIN));
 }
 
 /* Turn LED off */
 static inline void led_off(void) {
-    *GPSET0 = (1 << ACT_LED_PIN);
+    gpio_set_mask(GPIO_BANK(ACT_LED_PIN), GPIO_BIT(ACT_LED_PIN));
 }
 
 /* Blink LED n times */
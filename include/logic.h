@@ -0,0 +1,105 @@
+/*
+ * logic.h - GPIO Logic Analyzer
+ *
+ * One core (LOGIC_CORE) is given over to sampling GPLEV0/GPLEV1 in a
+ * tight loop. Only changes are stored: a record holds the levels of the
+ * captured pins, the index of the sample where they changed and a
+ * generic-timer timestamp, so a record's run length is the distance to
+ * the next one. Records go into a ring of LOGIC_RECORDS; a trigger
+ * (level or edge on pins of one bank) keeps up to LOGIC_PRE_RECORDS
+ * changes from before it and fills the rest of the ring after it.
+ *
+ * Capture stops when the ring is full, the window after the trigger
+ * has elapsed, the trigger did not come within the timeout, or on
+ * logic_abort(). logic_fiber() then reports the sustained sample rate
+ * over serial and draws the waveforms full screen. Send 'l' over serial
+ * to capture with the defaults below, again to stop early or go back.
+ */
+
+#ifndef LOGIC_H
+#define LOGIC_H
+
+#include "types.h"
+#include "gpio.h"
+#include "led.h"
+#include "smp.h"
+
+/* Serial command: capture, stop, back to the spec sheet */
+#define LOGIC_TRIGGER_KEY       'l'
+
+/* Sampling core: busy for the whole capture, IPIs wait until it ends and
+   sched_start() leaves it out */
+#define LOGIC_CORE              (NUM_CORES - 1)
+
+/* Ring size (16 bytes each, power of two) and pre-trigger share */
+#define LOGIC_RECORDS           65536
+#define LOGIC_PRE_RECORDS       (LOGIC_RECORDS / 4)
+
+/* Samples between timer/abort checks (power of two) */
+#define LOGIC_POLL_SAMPLES      256
+
+/* Longest timeout or window accepted, keeps 32-bit sample indices safe */
+#define LOGIC_MAX_MS            30000
+
+/* Defaults for 'l': header pins 2-27 and the ACT LED, trigger on the
+   heartbeat switching the (active low) LED on */
+#ifndef LOGIC_MASK0
+#define LOGIC_MASK0             (0x0FFFFFFCu | GPIO_BIT(ACT_LED_PIN))
+#endif
+#ifndef LOGIC_MASK1
+#define LOGIC_MASK1             0
+#endif
+#define LOGIC_DEFAULT_WINDOW_MS 1500
+#define LOGIC_DEFAULT_TIMEOUT_MS 3000
+
+typedef enum {
+    LOGIC_TRIG_NONE,            /* Start at once */
+    LOGIC_TRIG_LEVEL,           /* (levels & mask) == value */
+    LOGIC_TRIG_RISING,          /* Any pin in mask goes 0 -> 1 */
+    LOGIC_TRIG_FALLING,         /* Any pin in mask goes 1 -> 0 */
+    LOGIC_TRIG_EDGE             /* Any pin in mask changes */
+} logic_trigger_t;
+
+typedef struct {
+    uint32_t mask[2];           /* Pins captured, per bank */
+    logic_trigger_t trigger;
+    uint32_t trig_bank;         /* Bank of trig_mask; its pins are always captured */
+    uint32_t trig_mask;
+    uint32_t trig_value;        /* LOGIC_TRIG_LEVEL only */
+    uint32_t window_ms;         /* Capture after the trigger */
+    uint32_t timeout_ms;        /* Wait for the trigger */
+} logic_config_t;
+
+/* Levels from `sample` until the next record's sample */
+typedef struct {
+    uint32_t sample;            /* Sample index since capture start */
+    uint32_t ticks;             /* Timer ticks since capture start */
+    uint32_t level[2];          /* GPLEV0/GPLEV1 & mask */
+} logic_record_t;
+
+typedef struct {
+    uint32_t samples;           /* Bank reads (of each captured bank) */
+    uint32_t records;           /* Kept, see logic_record() */
+    uint32_t changes;           /* Written, including overwritten ones */
+    uint64_t ticks;             /* Sampling time */
+    bool triggered;
+    uint32_t trigger_record;    /* Index for logic_record() */
+    bool aborted;
+} logic_result_t;
+
+/* Functions */
+void logic_default_config(logic_config_t *cfg);
+bool logic_start(const logic_config_t *cfg);
+bool logic_capture(const logic_config_t *cfg);
+void logic_abort(void);
+bool logic_busy(void);
+bool logic_active(void);
+void logic_close(void);
+const logic_result_t *logic_result(void);
+const logic_record_t *logic_record(uint32_t i);
+uint64_t logic_sample_rate(void);
+void logic_report(void);
+void logic_draw(void);
+void logic_fiber(void *arg);
+
+#endif /* LOGIC_H */
@@ -62,12 +62,27 @@
 #define TAG_FB_SET_VIRT_OFF 0x00048009
 #define TAG_FB_GET_PALETTE  0x0004000B
 #define TAG_FB_SET_PALETTE  0x0004800B
+#define TAG_FB_WAIT_VSYNC   0x0004000E  /* Blocks until the next vertical sync */
+
+/* Hardware Cursor Tags */
+#define TAG_SET_CURSOR_INFO  0x00008010
+#define TAG_SET_CURSOR_STATE 0x00008011
 
 /* Clock Tags */
 #define TAG_GET_CLOCK_RATE  0x00030002
 #define TAG_GET_MAX_CLOCK   0x00030004
 #define TAG_GET_MIN_CLOCK   0x00030007
 #define TAG_SET_CLOCK_RATE  0x00038002
+#define TAG_GET_CLOCK_MEASURED 0x00030047
+
+/* Power / Thermal Tags */
+#define TAG_GET_VOLTAGE     0x00030003
+#define TAG_GET_TEMPERATURE 0x00030006
+#define TAG_GET_MAX_TEMP    0x0003000A
+#define TAG_GET_THROTTLED   0x00030046
+
+/* Tag request/response code: set by firmware when tag was handled */
+#define TAG_RESPONSE        0x80000000
 
 /* Clock IDs */
 #define CLOCK_ID_EMMC       1
@@ -81,12 +96,73 @@
 #define CLOCK_ID_PIXEL      9
 #define CLOCK_ID_PWM        10
 
+/* Voltage IDs */
+#define VOLTAGE_ID_CORE     1
+#define VOLTAGE_ID_SDRAM_C  2
+#define VOLTAGE_ID_SDRAM_P  3
+#define VOLTAGE_ID_SDRAM_I  4
+
+/* Throttled flags (TAG_GET_THROTTLED) */
+#define THROTTLE_UNDERVOLT      (1 << 0)
+#define THROTTLE_FREQ_CAPPED    (1 << 1)
+#define THROTTLE_THROTTLED      (1 << 2)
+#define THROTTLE_SOFT_TEMP      (1 << 3)
+#define THROTTLE_OCCURRED_SHIFT 16      /* Same bits, sticky since boot */
+
 /* Mailbox message buffer - must be 16-byte aligned */
 extern volatile uint32_t __attribute__((aligned(16))) mailbox_buffer[256];
 
+/*
+ * Locking: mailbox_buffer and the mailbox registers are shared by all
+ * cores. Hold mailbox_lock() from the first write into mailbox_buffer
+ * until the response has been read out. The lock is recursive per core,
+ * and mailbox_call()/mailbox_property() take it themselves.
+ * mailbox_property_early() takes no lock at all, for mmu_init().
+ */
+
+/*
+ * Property cache: mailbox_property() answers repeat requests from a
+ * small table keyed by tag and request values, according to the tag's
+ * policy (see mailbox.c):
+ *   immutable   board, memory split, clock limits: cached until
+ *               invalidated
+ *   TTL         current clock rates: cached for 10 ms, since the
+ *               firmware may change them on its own
+ *   never       voltages, temperature, throttle state and all set tags
+ * A set tag that succeeds invalidates its get tag (same tag without
+ * bit 15). Requests built by hand in mailbox_buffer bypass the cache;
+ * call mailbox_cache_invalidate() after a hand-built set tag.
+ */
+#define MBOX_CACHE_ENTRIES      16
+#define MBOX_CACHE_MAX_WORDS    4       /* Larger value buffers are never cached */
+#define MBOX_SET_BIT            0x00008000
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;            /* Cacheable, went to the firmware */
+    uint64_t uncached;          /* Never-cache policy */
+    uint64_t invalidations;     /* Entries dropped by set tags or explicitly */
+} mailbox_cache_stats_t;
+
+/* Round trips of mailbox_call() (write to response, timer ticks) */
+typedef struct {
+    uint64_t calls;
+    uint64_t total_ticks;
+    uint64_t max_ticks;
+    uint64_t last_ticks;
+} mailbox_stats_t;
+
 /* Functions */
+void mailbox_lock(void);
+void mailbox_unlock(void);
 bool mailbox_call(uint8_t channel);
+bool mailbox_property(uint32_t tag, uint32_t *values, uint32_t count);
+bool mailbox_property_early(uint32_t tag, uint32_t *values, uint32_t count);
 uint32_t mailbox_read(uint8_t channel);
 void mailbox_write(uint8_t channel, uint32_t data);
+void mailbox_get_stats(mailbox_stats_t *stats);
+void mailbox_cache_invalidate(uint32_t tag);
+void mailbox_cache_enable(bool enable);
+void mailbox_cache_get_stats(mailbox_cache_stats_t *stats);
 
 #endif /* MAILBOX_H */
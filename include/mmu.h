@@ -0,0 +1,39 @@
+/*
+ * mmu.h - EL2 Identity Map and Caches
+ *
+ * The kernel runs with a flat (VA == PA) map over the low 4 GB using
+ * 4 KB granules: 2 MB blocks by default, split into 4 KB pages where a
+ * range needs different attributes.
+ *
+ *   0 .. ARM memory end           normal, write-back cacheable
+ *   .dma section (__dma)          normal, non-cacheable
+ *   ARM memory end .. 0x3F000000  normal, non-cacheable (VideoCore
+ *                                 memory: framebuffer, GPU buffers)
+ *   0x3F000000 .. 0x40000000      device (peripherals)
+ *   0x40000000 .. 0x80000000      device (ARM local peripherals)
+ *
+ * Core 0 builds the tables in mmu_init(); cores 1-3 turn on the same
+ * map from boot.S before entering C.
+ */
+
+#ifndef MMU_H
+#define MMU_H
+
+#include "types.h"
+
+/* Memory types (MAIR_EL2 attribute index) */
+#define MMU_DEVICE          0       /* Device-nGnRnE */
+#define MMU_NORMAL_NC       1       /* Normal, non-cacheable */
+#define MMU_NORMAL          2       /* Normal, write-back RW-allocate */
+#define MMU_UNMAPPED        3       /* Invalid: any access faults */
+
+#define MMU_PAGE_SIZE       0x1000
+#define MMU_BLOCK_SIZE      0x200000
+
+/* Functions */
+bool mmu_init(void);
+void mmu_enable_secondary(void);
+bool mmu_enabled(void);
+bool mmu_map_range(uint64_t base, uint64_t size, uint32_t type);
+
+#endif /* MMU_H */
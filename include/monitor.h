@@ -0,0 +1,38 @@
+/*
+ * monitor.h - Live System Monitor Screen
+ *
+ * A full-screen view of per-core utilization (from cpustat idle time),
+ * wakeup rates, mailbox round-trip latency, the monitor's own frame
+ * time, frame pacing and memory use. Toggled with 'm' over serial;
+ * redrawn by a frame scheduler client (frame.h) on the first frame
+ * after each MONITOR_PERIOD_MS, only the characters and bar segments
+ * that changed since the previous redraw.
+ */
+
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include "types.h"
+#include "sysinfo.h"
+
+/* Serial commands: toggle the monitor, halve/double its period */
+#define MONITOR_TRIGGER_KEY     'm'
+#define MONITOR_FASTER_KEY      '+'
+#define MONITOR_SLOWER_KEY      '-'
+
+/* Refresh period (make MONITOR_MS=n) and the range '+'/'-' can reach */
+#ifndef MONITOR_PERIOD_MS
+#define MONITOR_PERIOD_MS       500
+#endif
+#define MONITOR_MIN_MS          50
+#define MONITOR_MAX_MS          8000
+
+/* Functions */
+void monitor_start(const sysinfo_t *sysinfo);
+void monitor_stop(void);
+bool monitor_active(void);
+void monitor_set_period_ms(uint32_t ms);
+uint32_t monitor_period_ms(void);
+void monitor_init(void);
+
+#endif /* MONITOR_H */
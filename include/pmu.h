@@ -0,0 +1,36 @@
+/*
+ * pmu.h - Cortex-A53 Cycle Counter
+ *
+ * PMCCNTR_EL0 counts CPU cycles once enabled. The PMU is per core, so
+ * pmu_init() must run on each core that reads it.
+ */
+
+#ifndef PMU_H
+#define PMU_H
+
+#include "types.h"
+
+#define PMCR_E              (1 << 0)    /* Enable counters */
+#define PMCR_LC             (1 << 6)    /* 64-bit cycle counter overflow */
+#define PMCNTEN_C           (1u << 31)  /* Cycle counter enable */
+#define PMCCFILTR_NSH       (1 << 27)   /* Also count at EL2 */
+
+/* Enable the cycle counter on the calling core */
+static inline void pmu_init(void) {
+    uint64_t pmcr;
+    asm volatile("mrs %0, pmcr_el0" : "=r"(pmcr));
+    pmcr |= PMCR_E | PMCR_LC;
+    asm volatile("msr pmcr_el0, %0" :: "r"(pmcr));
+    asm volatile("msr pmccfiltr_el0, %0" :: "r"((uint64_t)PMCCFILTR_NSH));
+    asm volatile("msr pmcntenset_el0, %0" :: "r"((uint64_t)PMCNTEN_C));
+    asm volatile("isb");
+}
+
+/* Current cycle count */
+static inline uint64_t pmu_cycles(void) {
+    uint64_t cycles;
+    asm volatile("isb; mrs %0, pmccntr_el0" : "=r"(cycles) :: "memory");
+    return cycles;
+}
+
+#endif /* PMU_H */
@@ -0,0 +1,41 @@
+/*
+ * qoi.h - Streaming QOI Image Decoder
+ *
+ * Decodes "Quite OK Image" data (https://qoiformat.org) one row at a
+ * time into 32-bit pixels in framebuffer order (0xAARRGGBB, i.e. B G R A
+ * in memory), so an image can go straight into framebuffer rows or an
+ * off-screen buffer without decoding it whole first.
+ *
+ * Images are embedded in the kernel's asset bundle (see assets.h).
+ */
+
+#ifndef QOI_H
+#define QOI_H
+
+#include "types.h"
+
+#define QOI_HEADER_SIZE     14
+#define QOI_PADDING_SIZE    8
+
+/* Header channels field */
+#define QOI_CHANNELS_RGB    3
+#define QOI_CHANNELS_RGBA   4
+
+/* Decoder state between rows */
+typedef struct {
+    const uint8_t *p;           /* Next op */
+    const uint8_t *data_end;    /* Start of the end padding */
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint32_t row;               /* Rows decoded so far */
+    uint32_t px;                /* Previous pixel */
+    uint32_t run;               /* Pixels left in the current run */
+    uint32_t index[64];         /* Recently seen pixels */
+} qoi_decoder_t;
+
+/* Functions */
+bool qoi_decode_init(qoi_decoder_t *dec, const uint8_t *data, uint32_t size);
+bool qoi_decode_row(qoi_decoder_t *dec, uint32_t *dst);
+
+#endif /* QOI_H */
@@ -0,0 +1,45 @@
+/*
+ * sched.h - Work-stealing Task Scheduler
+ *
+ * Per-core Chase-Lev deques: a core pushes and pops its own tasks at
+ * the bottom, idle cores steal from the top of others' deques and sleep
+ * in wfe when there is nothing to take. Task storage is owned by the
+ * caller (typically on its stack) and must stay valid until task_wait.
+ */
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include "types.h"
+
+/* Deque capacity per core (power of two) */
+#define SCHED_DEQUE_SIZE    256
+
+typedef void (*task_fn_t)(void *arg);
+
+typedef struct {
+    task_fn_t fn;
+    void *arg;
+    volatile uint32_t done;
+} task_t;
+
+/* Body of a parallel_for: handles items [begin, end) */
+typedef void (*range_fn_t)(uint32_t begin, uint32_t end, void *arg);
+
+/* Per-core counters since sched_start */
+typedef struct {
+    uint32_t executed;
+    uint32_t steals;
+    uint32_t inline_runs;       /* Deque full or scheduler stopped */
+} sched_stats_t;
+
+/* Functions */
+uint32_t sched_start(uint32_t ncores);
+void sched_stop(void);
+bool sched_running(void);
+void task_spawn(task_t *task, task_fn_t fn, void *arg);
+void task_wait(task_t *task);
+void parallel_for(uint32_t begin, uint32_t end, uint32_t grain, range_fn_t fn, void *arg);
+const sched_stats_t *sched_get_stats(uint32_t core);
+
+#endif /* SCHED_H */
@@ -0,0 +1,44 @@
+/*
+ * smp.h - Secondary Core Bring-up and Dispatch
+ *
+ * Cores 1-3 are released through the spin table the firmware (and
+ * QEMU's raspi3b boot stub) polls at 0xD8 + 8 * core. Once released,
+ * each one idles in wfe until core 0 hands it a function to run.
+ */
+
+#ifndef SMP_H
+#define SMP_H
+
+#include "types.h"
+#include "sync.h"
+
+#define NUM_CORES               4
+
+/* Spin table polled by parked cores */
+#define SPIN_TABLE_BASE         0xD8
+
+/* Per-core stack for cores 1-3 (slot layout: see stack.h) */
+#define SECONDARY_STACK_SIZE    0x10000
+
+/* Work function run on a core */
+typedef void (*smp_fn_t)(void *arg);
+
+/* Current core number (0-3) */
+static inline uint32_t smp_core_id(void) {
+    uint64_t mpidr;
+    asm volatile("mrs %0, mpidr_el1" : "=r"(mpidr));
+    return mpidr & 0xFF;
+}
+
+/* Functions */
+uint32_t smp_start_secondaries(void);
+uint32_t smp_online_cores(void);
+bool smp_started(void);
+void smp_lock(spinlock_t *lock);
+void smp_unlock(spinlock_t *lock);
+bool smp_run(uint32_t core, smp_fn_t fn, void *arg);
+void smp_wait(uint32_t core);
+void smp_run_on(uint32_t ncores, smp_fn_t fn, void *arg);
+void smp_secondary_main(uint32_t core);
+
+#endif /* SMP_H */
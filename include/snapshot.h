@@ -0,0 +1,54 @@
+/*
+ * snapshot.h - Framebuffer Snapshot Streaming
+ *
+ * Streams the current framebuffer contents out the PL011 UART using a
+ * row-delta + run-length encoding. Decode on the host with
+ * tools/fbsnap_decode.py.
+ *
+ * Stream layout (all multi-byte values little-endian):
+ *
+ *   "FBSNAP"  magic (6 bytes)
+ *   version   (1 byte, SNAPSHOT_VERSION)
+ *   format    (1 byte, SNAPSHOT_FMT_RGB888)
+ *   width     (u16)
+ *   height    (u16)
+ *   rows...   one record per scanline
+ *   "FBEND"   magic (5 bytes)
+ *   length    (u32) - bytes of row records
+ *   checksum  (u32) - FNV-1a over the row records
+ *
+ * Row record: SNAP_ROW_REPEAT (row equals the one above), or
+ * SNAP_ROW_OPS followed by ops covering exactly `width` pixels.
+ * Row 0 is compared against an all-black row.
+ *
+ * Op byte: (type << 6) | count-1, for counts 1..63. A count field of 63
+ * means "extended": count = 64 + LEB128 varint that follows.
+ *   SNAP_OP_UP   - copy `count` pixels from the row above
+ *   SNAP_OP_FILL - `count` pixels of one colour, R G B follows
+ *   SNAP_OP_LIT  - `count` literal pixels follow, R G B each
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "types.h"
+
+#define SNAPSHOT_VERSION        1
+#define SNAPSHOT_FMT_RGB888     0
+
+/* Row record types */
+#define SNAP_ROW_REPEAT         0x00
+#define SNAP_ROW_OPS            0x01
+
+/* Op types (top two bits of op byte) */
+#define SNAP_OP_UP              0
+#define SNAP_OP_FILL            1
+#define SNAP_OP_LIT             2
+
+/* Serial command that triggers a snapshot from the main loop */
+#define SNAPSHOT_TRIGGER_KEY    's'
+
+/* Functions */
+uint32_t snapshot_send(void);
+
+#endif /* SNAPSHOT_H */
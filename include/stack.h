@@ -0,0 +1,47 @@
+/*
+ * stack.h - Stack Painting, Guard Pages and Fault Reports
+ *
+ * Stack layout:
+ *   core 0      CORE0_STACK_SIZE below _start (0x80000), guard page
+ *               directly below that
+ *   cores 1-3   .stacks section, one STACK_SLOT_SIZE slot per core:
+ *               a guard page, then SECONDARY_STACK_SIZE of stack
+ *
+ * stack_init() fills every unused stack word with STACK_PAINT; the
+ * deepest word that no longer holds it is the high-water mark. With
+ * the MMU on, the guard pages are unmapped, so running off the end of
+ * a stack takes a data abort into fault_vectors (vectors.S), which
+ * switches to a small per-core fault stack and reports over serial.
+ */
+
+#ifndef STACK_H
+#define STACK_H
+
+#include "types.h"
+#include "smp.h"
+#include "mmu.h"
+
+/* Core 0 stack (top must match boot.S: sp = _start) */
+#define CORE0_STACK_TOP         0x80000
+#define CORE0_STACK_SIZE        0x40000
+
+/* Cores 1-3: guard page + stack per slot (must match boot.S, linker.ld) */
+#define STACK_GUARD_SIZE        MMU_PAGE_SIZE
+#define STACK_SLOT_SIZE         (STACK_GUARD_SIZE + SECONDARY_STACK_SIZE)
+
+/* Fill pattern for unused stack ("STAKSTAK") */
+#define STACK_PAINT             0x4B4154534B415453ul
+
+/* Stack the exception vectors switch to */
+#define FAULT_STACK_SIZE        2048
+
+/* Functions */
+void stack_init(void);
+void stack_install_vectors(void);
+bool stack_guarded(void);
+uint64_t stack_size(uint32_t core);
+uint64_t stack_used(uint32_t core);
+void stack_report(void);
+void fault_handler(uint32_t vector);
+
+#endif /* STACK_H */
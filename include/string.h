@@ -15,6 +15,7 @@ void *memcpy(void *dest, const void *src, size_t n);
 size_t strlen(const char *s);
 char *strcpy(char *dest, const char *src);
 char *strcat(char *dest, const char *src);
+int strcmp(const char *a, const char *b);
 
 /* Number to string conversion */
 void itoa(int32_t value, char *buffer, int base);
@@ -26,6 +27,7 @@ void format_hex32(uint32_t value, char *buffer);
 void format_dec(uint32_t value, char *buffer);
 void format_mhz(uint32_t hz, char *buffer);
 void format_mb(uint32_t bytes, char *buffer);
+void format_milli(uint32_t milli, uint32_t decimals, char *buffer);
 void format_mac(uint8_t *mac, char *buffer);
 
 #endif /* STRING_H */
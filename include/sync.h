@@ -0,0 +1,296 @@
+/*
+ * sync.h - SMP Synchronization Primitives
+ *
+ * Atomics built on the exclusive monitor (ldaxr/stlxr), ticket
+ * spinlocks and reader-writer locks that sleep in wfe while contended,
+ * seqlocks and a sense-reversing barrier.
+ *
+ * Note: on real silicon exclusives only work on Normal cacheable
+ * memory, i.e. once the MMU and D-cache are on. With translation off
+ * every access is Device memory and stxr may never succeed on the
+ * BCM2710. QEMU does not model this restriction.
+ */
+
+#ifndef SYNC_H
+#define SYNC_H
+
+#include "types.h"
+
+/* Barriers and event hints */
+#define dmb(opt)    asm volatile("dmb " #opt ::: "memory")
+#define dsb(opt)    asm volatile("dsb " #opt ::: "memory")
+#define isb()       asm volatile("isb" ::: "memory")
+
+/* Drain prior stores before signalling so the woken core observes them */
+static inline void sev(void)  { asm volatile("dsb ishst; sev" ::: "memory"); }
+static inline void sevl(void) { asm volatile("sevl" ::: "memory"); }
+static inline void wfe(void)  { asm volatile("wfe" ::: "memory"); }
+static inline void cpu_relax(void) { asm volatile("yield" ::: "memory"); }
+
+/* ---- Atomics (32-bit) ---- */
+
+static inline uint32_t atomic_load_acq(volatile uint32_t *p) {
+    uint32_t v;
+    asm volatile("ldar %w0, %1" : "=r"(v) : "Q"(*p) : "memory");
+    return v;
+}
+
+static inline void atomic_store_rel(volatile uint32_t *p, uint32_t v) {
+    asm volatile("stlr %w1, %0" : "=Q"(*p) : "r"(v) : "memory");
+}
+
+/* Returns the value before the add */
+static inline uint32_t atomic_fetch_add(volatile uint32_t *p, uint32_t v) {
+    uint32_t old, tmp, fail;
+    asm volatile(
+        "1: ldaxr   %w0, %3\n"
+        "   add     %w1, %w0, %w4\n"
+        "   stlxr   %w2, %w1, %3\n"
+        "   cbnz    %w2, 1b\n"
+        : "=&r"(old), "=&r"(tmp), "=&r"(fail), "+Q"(*p)
+        : "r"(v)
+        : "memory");
+    return old;
+}
+
+static inline uint32_t atomic_exchange(volatile uint32_t *p, uint32_t v) {
+    uint32_t old, fail;
+    asm volatile(
+        "1: ldaxr   %w0, %2\n"
+        "   stlxr   %w1, %w3, %2\n"
+        "   cbnz    %w1, 1b\n"
+        : "=&r"(old), "=&r"(fail), "+Q"(*p)
+        : "r"(v)
+        : "memory");
+    return old;
+}
+
+/* Compare-and-swap, true if *p was `expected` and is now `desired` */
+static inline bool atomic_cas(volatile uint32_t *p, uint32_t expected, uint32_t desired) {
+    uint32_t old, fail;
+    asm volatile(
+        "1: ldaxr   %w0, %2\n"
+        "   cmp     %w0, %w3\n"
+        "   b.ne    2f\n"
+        "   stlxr   %w1, %w4, %2\n"
+        "   cbnz    %w1, 1b\n"
+        "2:\n"
+        : "=&r"(old), "=&r"(fail), "+Q"(*p)
+        : "r"(expected), "r"(desired)
+        : "cc", "memory");
+    return old == expected;
+}
+
+/* ---- Atomics (64-bit / pointers) ---- */
+
+static inline uint64_t atomic_load_acq64(volatile uint64_t *p) {
+    uint64_t v;
+    asm volatile("ldar %0, %1" : "=r"(v) : "Q"(*p) : "memory");
+    return v;
+}
+
+static inline void atomic_store_rel64(volatile uint64_t *p, uint64_t v) {
+    asm volatile("stlr %1, %0" : "=Q"(*p) : "r"(v) : "memory");
+}
+
+static inline uint64_t atomic_fetch_add64(volatile uint64_t *p, uint64_t v) {
+    uint64_t old, tmp;
+    uint32_t fail;
+    asm volatile(
+        "1: ldaxr   %0, %3\n"
+        "   add     %1, %0, %4\n"
+        "   stlxr   %w2, %1, %3\n"
+        "   cbnz    %w2, 1b\n"
+        : "=&r"(old), "=&r"(tmp), "=&r"(fail), "+Q"(*p)
+        : "r"(v)
+        : "memory");
+    return old;
+}
+
+static inline bool atomic_cas64(volatile uint64_t *p, uint64_t expected, uint64_t desired) {
+    uint64_t old;
+    uint32_t fail;
+    asm volatile(
+        "1: ldaxr   %0, %2\n"
+        "   cmp     %0, %3\n"
+        "   b.ne    2f\n"
+        "   stlxr   %w1, %4, %2\n"
+        "   cbnz    %w1, 1b\n"
+        "2:\n"
+        : "=&r"(old), "=&r"(fail), "+Q"(*p)
+        : "r"(expected), "r"(desired)
+        : "cc", "memory");
+    return old == expected;
+}
+
+/* ---- Ticket spinlock ---- */
+
+/* owner in the low half, next ticket in the high half of one word */
+typedef struct {
+    volatile uint16_t owner;
+    volatile uint16_t next;
+} spinlock_t;
+
+#define SPINLOCK_INIT   { 0, 0 }
+
+static inline void spin_lock_init(spinlock_t *lock) {
+    lock->owner = 0;
+    lock->next = 0;
+}
+
+/*
+ * Take a ticket, then wait for `owner` to reach it. Waiters sleep in
+ * wfe with the owner half-word held in the exclusive monitor, so the
+ * unlocking store wakes them without an explicit sev.
+ */
+static inline void spin_lock(spinlock_t *lock) {
+    uint32_t ticket, tmp, fail;
+    asm volatile(
+        "   prfm    pstl1strm, %3\n"
+        "1: ldaxr   %w0, %3\n"
+        "   add     %w1, %w0, #(1 << 16)\n"
+        "   stxr    %w2, %w1, %3\n"
+        "   cbnz    %w2, 1b\n"
+        /* Lock was free if owner == our ticket */
+        "   eor     %w1, %w0, %w0, ror #16\n"
+        "   cbz     %w1, 3f\n"
+        "   sevl\n"
+        "2: wfe\n"
+        "   ldaxrh  %w2, %4\n"
+        "   eor     %w1, %w2, %w0, lsr #16\n"
+        "   cbnz    %w1, 2b\n"
+        "3:\n"
+        : "=&r"(ticket), "=&r"(tmp), "=&r"(fail), "+Q"(*lock)
+        : "Q"(lock->owner)
+        : "memory");
+}
+
+static inline bool spin_trylock(spinlock_t *lock) {
+    uint32_t val, fail;
+    asm volatile(
+        "1: ldaxr   %w0, %2\n"
+        "   eor     %w1, %w0, %w0, ror #16\n"
+        "   cbnz    %w1, 2f\n"
+        "   add     %w0, %w0, #(1 << 16)\n"
+        "   stxr    %w1, %w0, %2\n"
+        "   cbnz    %w1, 1b\n"
+        "2:\n"
+        : "=&r"(val), "=&r"(fail), "+Q"(*lock)
+        :
+        : "memory");
+    return fail == 0;
+}
+
+static inline void spin_unlock(spinlock_t *lock) {
+    asm volatile("stlrh %w1, %0"
+                 : "=Q"(lock->owner)
+                 : "r"(lock->owner + 1)
+                 : "memory");
+}
+
+/* ---- Reader-writer lock ---- */
+
+/* Bit 31: writer holds the lock, bits 0-30: active readers */
+typedef struct {
+    volatile uint32_t lock;
+} rwlock_t;
+
+#define RWLOCK_INIT     { 0 }
+#define RWLOCK_WRITER   0x80000000
+
+static inline void read_lock(rwlock_t *rw) {
+    uint32_t tmp, fail;
+    asm volatile(
+        "   sevl\n"
+        "1: wfe\n"
+        "2: ldaxr   %w0, %2\n"
+        "   add     %w0, %w0, #1\n"
+        "   tbnz    %w0, #31, 1b\n"
+        "   stxr    %w1, %w0, %2\n"
+        "   cbnz    %w1, 2b\n"
+        : "=&r"(tmp), "=&r"(fail), "+Q"(rw->lock)
+        :
+        : "memory");
+}
+
+static inline void read_unlock(rwlock_t *rw) {
+    uint32_t tmp, fail;
+    asm volatile(
+        "1: ldxr    %w0, %2\n"
+        "   sub     %w0, %w0, #1\n"
+        "   stlxr   %w1, %w0, %2\n"
+        "   cbnz    %w1, 1b\n"
+        : "=&r"(tmp), "=&r"(fail), "+Q"(rw->lock)
+        :
+        : "memory");
+}
+
+static inline void write_lock(rwlock_t *rw) {
+    uint32_t tmp;
+    asm volatile(
+        "   sevl\n"
+        "1: wfe\n"
+        "2: ldaxr   %w0, %1\n"
+        "   cbnz    %w0, 1b\n"
+        "   stxr    %w0, %w2, %1\n"
+        "   cbnz    %w0, 2b\n"
+        : "=&r"(tmp), "+Q"(rw->lock)
+        : "r"(RWLOCK_WRITER)
+        : "memory");
+}
+
+static inline void write_unlock(rwlock_t *rw) {
+    asm volatile("stlr wzr, %0" : "=Q"(rw->lock) :: "memory");
+}
+
+/* ---- Seqlock ---- */
+
+/* Writers serialise on the spinlock; readers retry on an odd/changed seq */
+typedef struct {
+    volatile uint32_t seq;
+    spinlock_t lock;
+} seqlock_t;
+
+#define SEQLOCK_INIT    { 0, SPINLOCK_INIT }
+
+static inline void write_seqlock(seqlock_t *sl) {
+    spin_lock(&sl->lock);
+    sl->seq++;
+    dmb(ishst);
+}
+
+static inline void write_sequnlock(seqlock_t *sl) {
+    dmb(ishst);
+    sl->seq++;
+    spin_unlock(&sl->lock);
+}
+
+static inline uint32_t read_seqbegin(seqlock_t *sl) {
+    uint32_t seq;
+    while ((seq = atomic_load_acq(&sl->seq)) & 1) {
+        cpu_relax();
+    }
+    return seq;
+}
+
+/* True if the read section raced a writer and must be repeated */
+static inline bool read_seqretry(seqlock_t *sl, uint32_t seq) {
+    dmb(ishld);
+    return sl->seq != seq;
+}
+
+/* ---- Sense-reversing barrier ---- */
+
+#define BARRIER_MAX_CORES   4
+
+typedef struct {
+    volatile uint32_t count;            /* Arrivals this round */
+    volatile uint32_t sense;            /* Flips when a round completes */
+    uint32_t total;                     /* Participants */
+    uint32_t local_sense[BARRIER_MAX_CORES];
+} barrier_t;
+
+void barrier_init(barrier_t *b, uint32_t total);
+void barrier_wait(barrier_t *b);
+
+#endif /* SYNC_H */
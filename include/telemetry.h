@@ -0,0 +1,63 @@
+/*
+ * telemetry.h - Periodic Hardware Telemetry
+ *
+ * Samples SoC temperature, ARM/core clocks, throttle flags and
+ * voltages with a single batched mailbox call per period and keeps the
+ * most recent samples in a fixed-size ring.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "types.h"
+
+/* Sampling period and history depth */
+#define TELEMETRY_PERIOD_MS     1000
+#define TELEMETRY_RING_SIZE     64
+
+/* Sample field validity bits (firmware may not implement every tag) */
+#define TELEM_VALID_TEMP        (1 << 0)
+#define TELEM_VALID_ARM_CLOCK   (1 << 1)
+#define TELEM_VALID_CORE_CLOCK  (1 << 2)
+#define TELEM_VALID_THROTTLED   (1 << 3)
+#define TELEM_VALID_VOLT_CORE   (1 << 4)
+#define TELEM_VALID_VOLT_SDRAM  (1 << 5)
+
+/* One sample */
+typedef struct {
+    uint64_t timestamp;         /* Generic timer ticks */
+    uint32_t temp_mc;           /* Millidegrees Celsius */
+    uint32_t arm_clock;         /* Hz */
+    uint32_t core_clock;        /* Hz */
+    uint32_t throttled;         /* THROTTLE_* flags */
+    uint32_t volt_core;         /* Microvolts */
+    uint32_t volt_sdram;        /* Microvolts (SDRAM core) */
+    uint32_t valid;             /* TELEM_VALID_* */
+} telemetry_sample_t;
+
+/* Aggregate over the samples currently in the ring */
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+    uint32_t avg;
+    uint32_t count;             /* Samples that had this field */
+} telemetry_stat_t;
+
+typedef struct {
+    telemetry_stat_t temp_mc;
+    telemetry_stat_t arm_clock;
+    telemetry_stat_t core_clock;
+    telemetry_stat_t volt_core;
+    telemetry_stat_t volt_sdram;
+    uint32_t throttled_any;     /* OR of flags over the window */
+} telemetry_agg_t;
+
+/* Functions */
+void telemetry_init(void);
+bool telemetry_sample(telemetry_sample_t *sample);
+bool telemetry_poll(void);
+const telemetry_sample_t *telemetry_latest(void);
+uint32_t telemetry_count(void);
+void telemetry_aggregate(telemetry_agg_t *agg);
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,45 @@
+/*
+ * timer.h - ARM Generic Timer
+ *
+ * The architected counter (CNTPCT_EL0) runs at CNTFRQ_EL0 Hz on every
+ * core (19.2 MHz on the Pi, set by the firmware; 62.5 MHz under QEMU).
+ * Reading it is cheap and needs no setup.
+ */
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include "types.h"
+
+/* Counter frequency in Hz */
+static inline uint64_t timer_freq(void) {
+    uint64_t freq;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+    return freq;
+}
+
+/* Current counter value (isb so it is not read early) */
+static inline uint64_t timer_ticks(void) {
+    uint64_t ticks;
+    asm volatile("isb; mrs %0, cntpct_el0" : "=r"(ticks) :: "memory");
+    return ticks;
+}
+
+/* Convert between ticks and microseconds */
+static inline uint64_t timer_ticks_to_us(uint64_t ticks) {
+    return ticks * 1000000 / timer_freq();
+}
+
+static inline uint64_t timer_us_to_ticks(uint64_t us) {
+    return us * timer_freq() / 1000000;
+}
+
+/* Busy-wait for a number of microseconds */
+static inline void timer_delay_us(uint64_t us) {
+    uint64_t end = timer_ticks() + timer_us_to_ticks(us);
+    while (timer_ticks() < end) {
+        asm volatile("nop");
+    }
+}
+
+#endif /* TIMER_H */
@@ -0,0 +1,91 @@
+/*
+ * trace.h - Event Tracing
+ *
+ * Each core records begin/end/instant events into its own ring, so
+ * recording takes no lock and no atomic: a counter read, two stores
+ * and an index bump. trace_dump() writes the rings over the UART as
+ * Chrome Trace Event JSON (one "thread" per core) for chrome://tracing
+ * or Perfetto; tools/trace_extract.py pulls it out of a serial log.
+ *
+ * Rings keep the newest TRACE_RING_SIZE events per core. Event names
+ * must be static strings without quotes or backslashes (they are
+ * stored as pointers and printed as-is). Build with NO_TRACE=1 to
+ * compile every trace call out.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "types.h"
+#include "smp.h"
+
+/* Events per core (power of 2) */
+#define TRACE_RING_SIZE     1024
+
+/* Serial command that dumps the trace */
+#define TRACE_TRIGGER_KEY   't'
+
+/* Event phases, as Chrome's "ph" field */
+#define TRACE_BEGIN         'B'
+#define TRACE_END           'E'
+#define TRACE_INSTANT       'i'
+
+/* Counter value in the low 56 bits, phase in the top 8 */
+#define TRACE_TS_MASK       ((1ul << 56) - 1)
+
+typedef struct {
+    uint64_t ts_phase;
+    const char *name;
+} trace_event_t;
+
+/* Written only by its own core */
+typedef struct {
+    uint64_t head;              /* Events ever recorded */
+    trace_event_t events[TRACE_RING_SIZE];
+} __attribute__((aligned(64))) trace_ring_t;
+
+extern trace_ring_t trace_rings[NUM_CORES];
+extern volatile bool trace_enabled;
+
+/*
+ * trace_event - Record an event on the calling core
+ * @name: Static string
+ * @phase: TRACE_BEGIN, TRACE_END or TRACE_INSTANT
+ *
+ * The counter is read without an isb: the timestamp may be taken a
+ * few instructions early, which is below the counter's resolution.
+ */
+static inline void trace_event(const char *name, uint32_t phase) {
+#ifndef NO_TRACE
+    if (!trace_enabled) {
+        return;
+    }
+
+    uint64_t ts;
+    trace_ring_t *ring = &trace_rings[smp_core_id()];
+    trace_event_t *ev = &ring->events[ring->head & (TRACE_RING_SIZE - 1)];
+
+    asm volatile("mrs %0, cntpct_el0" : "=r"(ts));
+    ev->ts_phase = (ts & TRACE_TS_MASK) | ((uint64_t)phase << 56);
+    ev->name = name;
+    ring->head++;
+#endif
+}
+
+static inline void trace_begin(const char *name) {
+    trace_event(name, TRACE_BEGIN);
+}
+
+static inline void trace_end(const char *name) {
+    trace_event(name, TRACE_END);
+}
+
+static inline void trace_instant(const char *name) {
+    trace_event(name, TRACE_INSTANT);
+}
+
+/* Functions */
+void trace_clear(void);
+void trace_dump(void);
+
+#endif /* TRACE_H */
@@ -0,0 +1,54 @@
+/*
+ * uart.h - PL011 UART (polled)
+ *
+ * Minimal transmit/receive path on the PL011 (UART0), routed to
+ * GPIO 14 (TXD) / GPIO 15 (RXD). config.txt disables Bluetooth so the
+ * PL011 is on the header pins. Under QEMU raspi3b this is the first
+ * serial port (-serial stdio / -serial file:...).
+ */
+
+#ifndef UART_H
+#define UART_H
+
+#include "types.h"
+#include "gpio.h"
+
+/* PL011 Registers */
+#define UART0_BASE          (PERIPHERAL_BASE + 0x201000)
+
+#define UART0_DR            ((volatile uint32_t*)(UART0_BASE + 0x00))
+#define UART0_FR            ((volatile uint32_t*)(UART0_BASE + 0x18))
+#define UART0_IBRD          ((volatile uint32_t*)(UART0_BASE + 0x24))
+#define UART0_FBRD          ((volatile uint32_t*)(UART0_BASE + 0x28))
+#define UART0_LCRH          ((volatile uint32_t*)(UART0_BASE + 0x2C))
+#define UART0_CR            ((volatile uint32_t*)(UART0_BASE + 0x30))
+#define UART0_IMSC          ((volatile uint32_t*)(UART0_BASE + 0x38))
+#define UART0_ICR           ((volatile uint32_t*)(UART0_BASE + 0x44))
+
+/* Flag Register Bits */
+#define UART_FR_BUSY        (1 << 3)
+#define UART_FR_RXFE        (1 << 4)
+#define UART_FR_TXFF        (1 << 5)
+
+/* Line Control Bits */
+#define UART_LCRH_FEN       (1 << 4)    /* FIFO enable */
+#define UART_LCRH_WLEN_8    (3 << 5)    /* 8 data bits */
+
+/* Control Register Bits */
+#define UART_CR_UARTEN      (1 << 0)
+#define UART_CR_TXE         (1 << 8)
+#define UART_CR_RXE         (1 << 9)
+
+/* Default line rate (8N1) */
+#define UART_BAUD           115200
+
+/* Functions */
+void uart_init(uint32_t baud);
+void uart_putc(char c);
+void uart_puts(const char *str);
+void uart_write(const uint8_t *data, size_t len);
+int uart_try_getc(void);
+bool uart_rx_ready(void);
+void uart_flush(void);
+
+#endif /* UART_H */
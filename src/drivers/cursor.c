@@ -0,0 +1,94 @@
+/*
+ * cursor.c - VideoCore Hardware Cursor
+ *
+ * SET_CURSOR_INFO:  width, height, (unused), image bus address,
+ *                   hotspot x, hotspot y
+ * SET_CURSOR_STATE: enable, x, y, flags (bit 0: framebuffer coordinates)
+ * Both answer with a status word, 0 on success.
+ */
+
+#include "cursor.h"
+#include "mailbox.h"
+#include "cache.h"
+
+/* Uncached bus alias of an ARM address, for the VideoCore to read */
+#define BUS_ADDRESS(p)      ((uint32_t)(uint64_t)(p) | 0xC0000000)
+
+#define CURSOR_FB_COORDS    1
+
+/* Image the firmware reads from (non-cacheable, so no clean needed) */
+static uint32_t __attribute__((aligned(16))) __dma cursor_image[CURSOR_MAX_SIZE * CURSOR_MAX_SIZE];
+
+static bool available;
+static bool visible;
+static uint32_t cur_x, cur_y;
+
+/* Send SET_CURSOR_STATE with the current position */
+static bool set_state(bool enable, uint32_t x, uint32_t y) {
+    uint32_t values[4] = { enable, x, y, CURSOR_FB_COORDS };
+
+    return mailbox_property(TAG_SET_CURSOR_STATE, values, 4) && values[0] == 0;
+}
+
+/*
+ * cursor_init - Upload the cursor image (cursor stays hidden)
+ * @pixels: width * height ARGB words, row by row; alpha 0 is transparent
+ * @width, @height: Up to CURSOR_MAX_SIZE
+ * @hot_x, @hot_y: Point of the image that cursor_move() positions
+ * Returns: false if the size is invalid or the firmware lacks the tags
+ */
+bool cursor_init(const uint32_t *pixels, uint32_t width, uint32_t height,
+                 uint32_t hot_x, uint32_t hot_y) {
+    if (width == 0 || height == 0 || width > CURSOR_MAX_SIZE || height > CURSOR_MAX_SIZE) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < width * height; i++) {
+        cursor_image[i] = pixels[i];
+    }
+
+    uint32_t values[6] = { width, height, 0, BUS_ADDRESS(cursor_image), hot_x, hot_y };
+    available = mailbox_property(TAG_SET_CURSOR_INFO, values, 6) && values[0] == 0;
+    if (available) {
+        visible = false;
+        set_state(false, cur_x, cur_y);
+    }
+    return available;
+}
+
+/*
+ * cursor_move - Place the cursor's hotspot at a framebuffer position
+ */
+bool cursor_move(uint32_t x, uint32_t y) {
+    if (!available) {
+        return false;
+    }
+    cur_x = x;
+    cur_y = y;
+    return set_state(visible, x, y);
+}
+
+/*
+ * cursor_show - Show or hide the cursor at its current position
+ */
+bool cursor_show(bool show) {
+    if (!available) {
+        return false;
+    }
+    visible = show;
+    return set_state(show, cur_x, cur_y);
+}
+
+/*
+ * cursor_available - Whether cursor_init() succeeded
+ */
+bool cursor_available(void) {
+    return available;
+}
+
+/*
+ * cursor_visible - Whether the cursor is currently shown
+ */
+bool cursor_visible(void) {
+    return visible;
+}
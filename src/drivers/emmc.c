@@ -0,0 +1,366 @@
+/*
+ * emmc.c - SD Card Driver (Arasan SDHCI, polled PIO)
+ *
+ * Brings the card up in 4-bit mode at 25 MHz and reads with CMD17
+ * (one block) or CMD18 + auto-CMD12 (multi-block), draining the data
+ * FIFO a word at a time. Multi-block reads amortize the per-command
+ * overhead, which dominates small transfers.
+ *
+ * No DMA: the BCM2835 Arasan block does not implement SDHCI SDMA/ADMA;
+ * only the system DMA engine could feed it (DREQ 11), left for later.
+ */
+
+#include "emmc.h"
+#include "mailbox.h"
+#include "timer.h"
+#include "sync.h"
+#include "smp.h"
+
+/* Fallback if the firmware does not report the EMMC clock */
+#define EMMC_DEFAULT_CLOCK  200000000
+
+#define EMMC_CLOCK_IDENT    400000
+#define EMMC_CLOCK_NORMAL   25000000
+
+/* Timeouts in microseconds */
+#define EMMC_CMD_TIMEOUT    100000
+#define EMMC_DATA_TIMEOUT   500000
+#define EMMC_INIT_TIMEOUT   1000000
+
+/* CMDTM fields */
+#define CMD_INDEX(n)        ((uint32_t)(n) << 24)
+#define CMD_RSP_NONE        (0 << 16)
+#define CMD_RSP_136         (1 << 16)
+#define CMD_RSP_48          (2 << 16)
+#define CMD_RSP_48_BUSY     (3 << 16)
+#define CMD_CRC_CHECK       (1 << 19)
+#define CMD_INDEX_CHECK     (1 << 20)
+#define CMD_IS_DATA         (1 << 21)
+#define TM_BLKCNT_EN        (1 << 1)
+#define TM_AUTO_CMD12       (1 << 2)
+#define TM_CARD_TO_HOST     (1 << 4)
+#define TM_MULTI_BLOCK      (1 << 5)
+
+#define R1                  (CMD_RSP_48 | CMD_CRC_CHECK | CMD_INDEX_CHECK)
+#define R1B                 (CMD_RSP_48_BUSY | CMD_CRC_CHECK | CMD_INDEX_CHECK)
+
+#define CMD_GO_IDLE         (CMD_INDEX(0) | CMD_RSP_NONE)
+#define CMD_ALL_SEND_CID    (CMD_INDEX(2) | CMD_RSP_136 | CMD_CRC_CHECK)
+#define CMD_SEND_REL_ADDR   (CMD_INDEX(3) | R1)
+#define CMD_SELECT_CARD     (CMD_INDEX(7) | R1B)
+#define CMD_SEND_IF_COND    (CMD_INDEX(8) | R1)
+#define CMD_SET_BLOCKLEN    (CMD_INDEX(16) | R1)
+#define CMD_READ_SINGLE     (CMD_INDEX(17) | R1 | CMD_IS_DATA | TM_CARD_TO_HOST)
+#define CMD_READ_MULTI      (CMD_INDEX(18) | R1 | CMD_IS_DATA | TM_CARD_TO_HOST | \
+                             TM_BLKCNT_EN | TM_AUTO_CMD12 | TM_MULTI_BLOCK)
+#define CMD_APP_CMD         (CMD_INDEX(55) | R1)
+#define ACMD_SET_BUS_WIDTH  (CMD_INDEX(6) | R1)
+#define ACMD_SD_SEND_OP     (CMD_INDEX(41) | CMD_RSP_48)    /* R3: no CRC */
+
+/* CMD8 argument: 2.7-3.6 V, check pattern 0xAA */
+#define IF_COND_ARG         0x1AA
+
+/* ACMD41 argument: HCS + 2.7-3.6 V window */
+#define OP_COND_HCS         (1 << 30)
+#define OP_COND_VOLTAGE     0x00FF8000
+#define OCR_READY           (1u << 31)
+#define OCR_CCS             (1 << 30)
+
+static bool card_ready;
+static bool card_sdhc;          /* Block (not byte) addressing */
+static uint32_t card_rca;
+static uint32_t base_clock;
+static emmc_stats_t stats;
+
+static spinlock_t emmc_lock = SPINLOCK_INIT;      /* smp_lock: core 0 alone without the MMU */
+
+/* Spin until (reg & mask) is zero, or the timeout expires */
+static bool wait_clear(volatile uint32_t *reg, uint32_t mask, uint32_t timeout_us) {
+    uint64_t end = timer_ticks() + timer_us_to_ticks(timeout_us);
+
+    while (*reg & mask) {
+        if (timer_ticks() > end) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Spin until any bit of mask is set in INTERRUPT; returns the bits seen */
+static uint32_t wait_interrupt(uint32_t mask, uint32_t timeout_us) {
+    uint64_t end = timer_ticks() + timer_us_to_ticks(timeout_us);
+    uint32_t irpt;
+
+    while (!((irpt = *EMMC_INTERRUPT) & (mask | EMMC_INT_ERR))) {
+        if (timer_ticks() > end) {
+            return 0;
+        }
+    }
+    return irpt;
+}
+
+/* Recover the command and data lines after an error */
+static void reset_lines(void) {
+    *EMMC_CONTROL1 |= EMMC_C1_SRST_CMD | EMMC_C1_SRST_DATA;
+    wait_clear(EMMC_CONTROL1, EMMC_C1_SRST_CMD | EMMC_C1_SRST_DATA, EMMC_CMD_TIMEOUT);
+    *EMMC_INTERRUPT = EMMC_INT_ALL;
+}
+
+/*
+ * emmc_command - Issue one command and wait for its response
+ * @cmdtm: CMDTM value (index, response type, transfer mode)
+ * @arg: Command argument
+ * Returns: true on completion without error
+ */
+static bool emmc_command(uint32_t cmdtm, uint32_t arg) {
+    if (!wait_clear(EMMC_STATUS, EMMC_STATUS_CMD_INHIBIT, EMMC_CMD_TIMEOUT)) {
+        return false;
+    }
+
+    *EMMC_INTERRUPT = EMMC_INT_ALL;
+    *EMMC_ARG1 = arg;
+    *EMMC_CMDTM = cmdtm;
+
+    uint32_t irpt = wait_interrupt(EMMC_INT_CMD_DONE, EMMC_CMD_TIMEOUT);
+    if (!(irpt & EMMC_INT_CMD_DONE) || (irpt & EMMC_INT_ERR)) {
+        reset_lines();
+        return false;
+    }
+
+    *EMMC_INTERRUPT = EMMC_INT_CMD_DONE;
+
+    /* R1b: wait for the card to release DAT0 */
+    if ((cmdtm & CMD_RSP_48_BUSY) == CMD_RSP_48_BUSY) {
+        wait_interrupt(EMMC_INT_DATA_DONE, EMMC_CMD_TIMEOUT);
+        *EMMC_INTERRUPT = EMMC_INT_DATA_DONE;
+    }
+
+    return true;
+}
+
+/* CMD55 prefix, then an application command */
+static bool emmc_app_command(uint32_t cmdtm, uint32_t arg) {
+    return emmc_command(CMD_APP_CMD, card_rca) && emmc_command(cmdtm, arg);
+}
+
+/*
+ * Set the SD clock (SDHCI v3 10-bit divider: f = base / (2 * div))
+ */
+static bool emmc_set_clock(uint32_t hz) {
+    if (!wait_clear(EMMC_STATUS, EMMC_STATUS_CMD_INHIBIT | EMMC_STATUS_DAT_INHIBIT,
+                    EMMC_CMD_TIMEOUT)) {
+        return false;
+    }
+
+    *EMMC_CONTROL1 &= ~EMMC_C1_CLK_EN;
+
+    uint32_t div = (base_clock + 2 * hz - 1) / (2 * hz);
+    if (div > 0x3FF) {
+        div = 0x3FF;
+    }
+
+    uint32_t ctrl = *EMMC_CONTROL1 & ~EMMC_C1_CLK_DIV_MASK;
+    ctrl |= ((div & 0xFF) << 8) | (((div >> 8) & 3) << 6) | EMMC_C1_CLK_INTLEN;
+    *EMMC_CONTROL1 = ctrl;
+
+    uint64_t end = timer_ticks() + timer_us_to_ticks(EMMC_CMD_TIMEOUT);
+    while (!(*EMMC_CONTROL1 & EMMC_C1_CLK_STABLE)) {
+        if (timer_ticks() > end) {
+            return false;
+        }
+    }
+
+    *EMMC_CONTROL1 |= EMMC_C1_CLK_EN;
+    timer_delay_us(10);
+    return true;
+}
+
+/* Route GPIO 48-53 to the EMMC controller, pull-ups on CMD/DAT0-3 */
+static void emmc_gpio_init(void) {
+    gpio_set_function_mask(1, 0x3F << (48 - 32), GPIO_FUNC_ALT3);       /* GPIO 48-53 */
+    gpio_set_pull_mask(1, 0x1F << (49 - 32), GPIO_PULL_UP);             /* GPIO 49-53 */
+}
+
+/* Query EMMC base clock via mailbox */
+static uint32_t emmc_get_clock(void) {
+    uint32_t values[2] = { CLOCK_ID_EMMC, 0 };
+
+    if (!mailbox_property(TAG_GET_CLOCK_RATE, values, 2) || values[1] == 0) {
+        return EMMC_DEFAULT_CLOCK;
+    }
+
+    return values[1];
+}
+
+/*
+ * emmc_init - Reset the controller and bring the card to transfer state
+ * Returns: true if a card is ready for emmc_read()
+ */
+bool emmc_init(void) {
+    card_ready = false;
+    card_rca = 0;
+    stats.commands = stats.blocks = stats.errors = 0;
+
+    emmc_gpio_init();
+    base_clock = emmc_get_clock();
+
+    /* Full host reset */
+    *EMMC_CONTROL0 = 0;
+    *EMMC_CONTROL1 |= EMMC_C1_SRST_HC;
+    if (!wait_clear(EMMC_CONTROL1, EMMC_C1_SRST_HC, EMMC_CMD_TIMEOUT)) {
+        return false;
+    }
+
+    *EMMC_CONTROL1 |= EMMC_C1_TOUNIT_MAX;
+    if (!emmc_set_clock(EMMC_CLOCK_IDENT)) {
+        return false;
+    }
+
+    /* Polled: latch every status bit, signal none */
+    *EMMC_IRPT_MASK = EMMC_INT_ALL;
+    *EMMC_IRPT_EN = 0;
+    *EMMC_INTERRUPT = EMMC_INT_ALL;
+
+    if (!emmc_command(CMD_GO_IDLE, 0)) {
+        return false;
+    }
+
+    /* CMD8 only answers on v2+ cards; v1 cards time out */
+    bool v2 = emmc_command(CMD_SEND_IF_COND, IF_COND_ARG) &&
+              (*EMMC_RESP0 & 0xFFF) == IF_COND_ARG;
+
+    uint32_t op_arg = OP_COND_VOLTAGE | (v2 ? OP_COND_HCS : 0);
+    uint64_t end = timer_ticks() + timer_us_to_ticks(EMMC_INIT_TIMEOUT);
+    uint32_t ocr = 0;
+
+    while (!(ocr & OCR_READY)) {
+        if (timer_ticks() > end || !emmc_app_command(ACMD_SD_SEND_OP, op_arg)) {
+            return false;
+        }
+        ocr = *EMMC_RESP0;
+        if (!(ocr & OCR_READY)) {
+            timer_delay_us(10000);
+        }
+    }
+    card_sdhc = (ocr & OCR_CCS) != 0;
+
+    if (!emmc_command(CMD_ALL_SEND_CID, 0) ||
+        !emmc_command(CMD_SEND_REL_ADDR, 0)) {
+        return false;
+    }
+    card_rca = *EMMC_RESP0 & 0xFFFF0000;
+
+    if (!emmc_set_clock(EMMC_CLOCK_NORMAL) ||
+        !emmc_command(CMD_SELECT_CARD, card_rca)) {
+        return false;
+    }
+
+    /* Byte-addressed (SDSC) cards: fix the block length */
+    if (!card_sdhc && !emmc_command(CMD_SET_BLOCKLEN, EMMC_BLOCK_SIZE)) {
+        return false;
+    }
+
+    /* 4-bit bus; every SD card supports it */
+    if (emmc_app_command(ACMD_SET_BUS_WIDTH, 2)) {
+        *EMMC_CONTROL0 |= EMMC_C0_DWIDTH_4;
+    }
+
+    card_ready = true;
+    return true;
+}
+
+/*
+ * emmc_ready - True once emmc_init() has succeeded
+ */
+bool emmc_ready(void) {
+    return card_ready;
+}
+
+/* Drain one block from the data FIFO */
+static void read_fifo_block(uint32_t *dst) {
+    for (uint32_t i = 0; i < EMMC_BLOCK_SIZE / 4; i += 4) {
+        dst[i + 0] = *EMMC_DATA;
+        dst[i + 1] = *EMMC_DATA;
+        dst[i + 2] = *EMMC_DATA;
+        dst[i + 3] = *EMMC_DATA;
+    }
+}
+
+/* One CMD17/CMD18 transfer of up to EMMC_MAX_BLOCKS blocks */
+static bool read_run(uint32_t lba, uint32_t count, uint32_t *dst) {
+    if (!wait_clear(EMMC_STATUS, EMMC_STATUS_DAT_INHIBIT, EMMC_DATA_TIMEOUT)) {
+        return false;
+    }
+
+    *EMMC_BLKSIZECNT = (count << 16) | EMMC_BLOCK_SIZE;
+
+    uint32_t arg = card_sdhc ? lba : lba * EMMC_BLOCK_SIZE;
+    if (!emmc_command(count == 1 ? CMD_READ_SINGLE : CMD_READ_MULTI, arg)) {
+        return false;
+    }
+    stats.commands++;
+
+    for (uint32_t b = 0; b < count; b++) {
+        uint32_t irpt = wait_interrupt(EMMC_INT_READ_RDY, EMMC_DATA_TIMEOUT);
+        if (!(irpt & EMMC_INT_READ_RDY) || (irpt & EMMC_INT_ERR)) {
+            reset_lines();
+            return false;
+        }
+        *EMMC_INTERRUPT = EMMC_INT_READ_RDY;
+        read_fifo_block(dst);
+        dst += EMMC_BLOCK_SIZE / 4;
+    }
+
+    uint32_t irpt = wait_interrupt(EMMC_INT_DATA_DONE, EMMC_DATA_TIMEOUT);
+    if (!(irpt & EMMC_INT_DATA_DONE) || (irpt & EMMC_INT_ERR)) {
+        reset_lines();
+        return false;
+    }
+    *EMMC_INTERRUPT = EMMC_INT_DATA_DONE;
+
+    stats.blocks += count;
+    return true;
+}
+
+/*
+ * emmc_read - Read consecutive blocks
+ * @lba: First block
+ * @count: Number of 512-byte blocks
+ * @buf: Destination, 4-byte aligned, count * 512 bytes
+ * Returns: true on success
+ */
+bool emmc_read(uint32_t lba, uint32_t count, void *buf) {
+    uint32_t *dst = buf;
+    bool ok = true;
+
+    if (!card_ready) {
+        return false;
+    }
+
+    smp_lock(&emmc_lock);
+
+    while (ok && count > 0) {
+        uint32_t n = count > EMMC_MAX_BLOCKS ? EMMC_MAX_BLOCKS : count;
+
+        ok = read_run(lba, n, dst);
+        lba += n;
+        dst += n * (EMMC_BLOCK_SIZE / 4);
+        count -= n;
+    }
+
+    if (!ok) {
+        stats.errors++;
+    }
+
+    smp_unlock(&emmc_lock);
+    return ok;
+}
+
+/*
+ * emmc_get_stats - Copy the transfer counters
+ */
+void emmc_get_stats(emmc_stats_t *out) {
+    smp_lock(&emmc_lock);
+    *out = stats;
+    smp_unlock(&emmc_lock);
+}
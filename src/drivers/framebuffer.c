@@ -8,6 +8,14 @@
 #include "framebuffer.h"
 #include "mailbox.h"
 #include "font8x8.h"
+#include "qoi.h"
+#include "smp.h"
+#include "kprintf.h"
+#include "gfx.h"
+#include "assets.h"
+
+/* Widest image fb_draw_qoi() can clip or blend (per-core line buffer) */
+#define QOI_LINE_MAX    2048
 
 /* Global framebuffer info */
 static framebuffer_t fb_info;
@@ -23,6 +31,8 @@ bool fb_init(uint32_t width, uint32_t height, uint32_t depth) {
     /* Build property message to set up framebuffer */
     uint32_t i = 0;
     
+    mailbox_lock();
+    
     mailbox_buffer[i++] = 0;                    /* Size (fill later) */
     mailbox_buffer[i++] = 0;                    /* Request code */
     
@@ -74,11 +84,13 @@ bool fb_init(uint32_t width, uint32_t height, uint32_t depth) {
     
     /* Send to GPU */
     if (!mailbox_call(MAILBOX_CH_PROP)) {
+        mailbox_unlock();
         return false;
     }
     
     /* Check if we got a framebuffer - address is at index 24 */
     if (mailbox_buffer[24] == 0) {
+        mailbox_unlock();
         return false;
     }
     
@@ -93,6 +105,7 @@ bool fb_init(uint32_t width, uint32_t height, uint32_t depth) {
     fb_info.size = mailbox_buffer[25];
     fb_info.pitch = mailbox_buffer[29];
     
+    mailbox_unlock();
     return true;
 }
 
@@ -121,13 +134,20 @@ void fb_put_pixel(uint32_t x, uint32_t y, color_t color) {
 }
 
 /*
- * fb_fill_rect - Fill a rectangle with color
+ * fb_fill_rect - Fill a rectangle with color (one span store per row)
  */
 void fb_fill_rect(uint32_t x, uint32_t y, uint32_t w, uint32_t h, color_t color) {
+    uint32_t pixel = gfx_pixel(color);
+    
+    if (x >= fb_info.width) {
+        return;
+    }
+    if (w > fb_info.width - x) {
+        w = fb_info.width - x;
+    }
+    
     for (uint32_t py = y; py < y + h && py < fb_info.height; py++) {
-        for (uint32_t px = x; px < x + w && px < fb_info.width; px++) {
-            fb_put_pixel(px, py, color);
-        }
+        gfx_fill_words((uint32_t *)(fb_info.buffer + py * fb_info.pitch) + x, w, pixel);
     }
 }
 
@@ -138,6 +158,29 @@ void fb_clear(color_t color) {
     fb_fill_rect(0, 0, fb_info.width, fb_info.height, color);
 }
 
+/*
+ * fb_glyph - Font rows for a character (FONT_HEIGHT bytes, bit 7 left)
+ * @c: Character; non-printable ones map to '?'
+ */
+const uint8_t *fb_glyph(char c) {
+    static const uint8_t *font;
+    static const uint8_t blank[FONT_HEIGHT];
+    
+    if (font == NULL) {
+        uint32_t size;
+        const uint8_t *data = asset_find(FONT_ASSET, &size);
+        if (data == NULL || size < (FONT_LAST - FONT_FIRST + 1) * FONT_HEIGHT) {
+            return blank;
+        }
+        font = data;
+    }
+    
+    if (c < FONT_FIRST || c > FONT_LAST) {
+        c = '?';
+    }
+    return font + (c - FONT_FIRST) * FONT_HEIGHT;
+}
+
 /*
  * fb_draw_char - Draw a single character
  * @x, @y: Top-left position
@@ -146,12 +189,7 @@ void fb_clear(color_t color) {
  * @bg: Background color
  */
 void fb_draw_char(uint32_t x, uint32_t y, char c, color_t fg, color_t bg) {
-    /* Only handle printable ASCII */
-    if (c < 32 || c > 126) {
-        c = '?';
-    }
-    
-    const uint8_t *glyph = font8x8[c - 32];
+    const uint8_t *glyph = fb_glyph(c);
     
     for (int row = 0; row < FONT_HEIGHT; row++) {
         uint8_t bits = glyph[row];
@@ -183,3 +221,111 @@ void fb_draw_string(uint32_t x, uint32_t y, const char *str, color_t fg, color_t
         str++;
     }
 }
+
+/* Text cursor for fb_printf */
+typedef struct {
+    uint32_t orig_x;
+    uint32_t x;
+    uint32_t y;
+    color_t fg;
+    color_t bg;
+} fb_cursor_t;
+
+static void fb_sink(void *ctx, const char *s, size_t len) {
+    fb_cursor_t *cur = ctx;
+    
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] == '\n') {
+            cur->x = cur->orig_x;
+            cur->y += FONT_HEIGHT + 2;
+        } else {
+            fb_draw_char(cur->x, cur->y, s[i], cur->fg, cur->bg);
+            cur->x += FONT_WIDTH;
+        }
+    }
+}
+
+/*
+ * fb_printf - Draw formatted text (see kprintf.h), like fb_draw_string
+ * Returns: Characters produced
+ */
+size_t fb_printf(uint32_t x, uint32_t y, color_t fg, color_t bg, const char *fmt, ...) {
+    fb_cursor_t cur = { x, x, y, fg, bg };
+    va_list ap;
+    
+    va_start(ap, fmt);
+    size_t n = kvprintf_sink(fb_sink, &cur, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+/* Composite one decoded row over the framebuffer: a=255 copy, a=0 skip */
+static void blend_row(uint32_t *dst, const uint32_t *src, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t s = src[i];
+        uint32_t a = s >> 24;
+
+        if (a == 0xFF) {
+            dst[i] = s;
+        } else if (a != 0) {
+            uint32_t d = dst[i];
+            uint32_t out = 0xFF000000;
+            for (uint32_t shift = 0; shift < 24; shift += 8) {
+                uint32_t c = (((s >> shift) & 0xFF) * a +
+                              ((d >> shift) & 0xFF) * (255 - a) + 127) / 255;
+                out |= c << shift;
+            }
+            dst[i] = out;
+        }
+    }
+}
+
+/*
+ * fb_draw_qoi - Decode a QOI image into the framebuffer, row by row
+ * @x, @y: Top-left position (clipped to the screen)
+ * @data: QOI file contents
+ * @size: Bytes of data
+ * Returns: false if the image is invalid or too wide to clip
+ *
+ * Opaque images that fit horizontally decode straight into the
+ * framebuffer rows; RGBA or clipped images go through a line buffer.
+ */
+bool fb_draw_qoi(uint32_t x, uint32_t y, const uint8_t *data, uint32_t size) {
+    static uint32_t line[NUM_CORES][QOI_LINE_MAX];
+    qoi_decoder_t dec;
+
+    if (fb_info.depth != 32 || !qoi_decode_init(&dec, data, size)) {
+        return false;
+    }
+    if (x >= fb_info.width || y >= fb_info.height) {
+        return true;
+    }
+
+    uint32_t visible = fb_info.width - x;
+    if (visible > dec.width) {
+        visible = dec.width;
+    }
+    bool direct = dec.channels == QOI_CHANNELS_RGB && visible == dec.width;
+
+    if (!direct && dec.width > QOI_LINE_MAX) {
+        return false;
+    }
+
+    uint32_t *buf = line[smp_core_id()];
+    for (uint32_t row = y; row < fb_info.height; row++) {
+        uint32_t *dst = (uint32_t *)(fb_info.buffer + row * fb_info.pitch) + x;
+
+        if (direct) {
+            if (!qoi_decode_row(&dec, dst)) {
+                break;
+            }
+        } else {
+            if (!qoi_decode_row(&dec, buf)) {
+                break;
+            }
+            blend_row(dst, buf, visible);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,137 @@
+/*
+ * gpio.c - GPIO Configuration
+ *
+ * Function select, pulls and event detect enables are read-modify-write
+ * on registers shared by many pins, so they take gpio_lock. Mask forms
+ * touch each register once however many pins change, which matters for
+ * setting up a parallel bus.
+ *
+ * led_init() and uart_init() configure pins while core 0 still runs
+ * alone (after mmu_init(), before smp_start_secondaries()), and without
+ * the MMU core 0 never gets company, so the lock goes through
+ * smp_lock() and is only taken once cores 1-3 run.
+ */
+
+#include "gpio.h"
+#include "sync.h"
+#include "smp.h"
+
+/* GPPUD/GPPUDCLK setup and hold time (>= 150 cycles each) */
+#define GPIO_PULL_DELAY     150
+
+static spinlock_t gpio_lock = SPINLOCK_INIT;
+
+/* Event detect enable registers, in GPIO_EVENT_* bit order */
+static volatile uint32_t *const event_regs[] = {
+    GPREN0, GPFEN0, GPHEN0, GPLEN0, GPAREN0, GPAFEN0
+};
+
+/*
+ * gpio_set_function_mask - Select the same function for many pins
+ * @bank: 0 (pins 0-31) or 1 (pins 32-53)
+ * @mask: Pins of the bank
+ * @func: GPIO_FUNC_*
+ *
+ * Each GPFSEL register (10 pins) is read and written at most once.
+ */
+void gpio_set_function_mask(uint32_t bank, uint32_t mask, uint32_t func) {
+    smp_lock(&gpio_lock);
+
+    uint32_t first = bank * 32;
+    for (uint32_t reg = first / 10; mask != 0 && reg <= (GPIO_NUM_PINS - 1) / 10; reg++) {
+        uint32_t clear = 0, set = 0;
+
+        for (uint32_t i = 0; i < 10; i++) {
+            uint32_t pin = reg * 10 + i;
+            if (pin < first || pin >= first + 32 || pin >= GPIO_NUM_PINS ||
+                !(mask & GPIO_BIT(pin))) {
+                continue;
+            }
+            clear |= 7u << (i * 3);
+            set |= (func & 7) << (i * 3);
+            mask &= ~GPIO_BIT(pin);
+        }
+
+        if (clear) {
+            volatile uint32_t *fsel = GPFSEL0 + reg;
+            *fsel = (*fsel & ~clear) | set;
+        }
+    }
+
+    smp_unlock(&gpio_lock);
+}
+
+/*
+ * gpio_set_function - Select the function of one pin
+ * @pin: 0-53
+ * @func: GPIO_FUNC_*
+ */
+void gpio_set_function(uint32_t pin, uint32_t func) {
+    if (pin < GPIO_NUM_PINS) {
+        gpio_set_function_mask(GPIO_BANK(pin), GPIO_BIT(pin), func);
+    }
+}
+
+/*
+ * gpio_set_pull_mask - Set pull-up/down for many pins
+ * @bank: 0 or 1
+ * @mask: Pins of the bank
+ * @pull: GPIO_PULL_NONE, GPIO_PULL_DOWN or GPIO_PULL_UP
+ *
+ * One GPPUD/GPPUDCLK sequence for all masked pins.
+ */
+void gpio_set_pull_mask(uint32_t bank, uint32_t mask, uint32_t pull) {
+    volatile uint32_t *clk = GPIO_BANK_REG(GPPUDCLK0, bank);
+
+    smp_lock(&gpio_lock);
+    *GPPUD = pull;
+    delay(GPIO_PULL_DELAY);
+    *clk = mask;
+    delay(GPIO_PULL_DELAY);
+    *clk = 0;
+    *GPPUD = GPIO_PULL_NONE;
+    smp_unlock(&gpio_lock);
+}
+
+void gpio_set_pull(uint32_t pin, uint32_t pull) {
+    if (pin < GPIO_NUM_PINS) {
+        gpio_set_pull_mask(GPIO_BANK(pin), GPIO_BIT(pin), pull);
+    }
+}
+
+/*
+ * gpio_enable_events - Latch events on pins into GPEDS
+ * @bank: 0 or 1
+ * @mask: Pins of the bank
+ * @events: GPIO_EVENT_* sources to add
+ *
+ * Poll with gpio_events() and acknowledge with gpio_clear_events().
+ * Level sources keep re-latching while the level persists.
+ */
+void gpio_enable_events(uint32_t bank, uint32_t mask, uint32_t events) {
+    smp_lock(&gpio_lock);
+    for (uint32_t i = 0; i < sizeof(event_regs) / sizeof(event_regs[0]); i++) {
+        if (events & (1u << i)) {
+            volatile uint32_t *reg = GPIO_BANK_REG(event_regs[i], bank);
+            *reg |= mask;
+        }
+    }
+    smp_unlock(&gpio_lock);
+}
+
+/*
+ * gpio_disable_events - Stop latching the given sources
+ * @bank: 0 or 1
+ * @mask: Pins of the bank
+ * @events: GPIO_EVENT_* sources to remove
+ */
+void gpio_disable_events(uint32_t bank, uint32_t mask, uint32_t events) {
+    smp_lock(&gpio_lock);
+    for (uint32_t i = 0; i < sizeof(event_regs) / sizeof(event_regs[0]); i++) {
+        if (events & (1u << i)) {
+            volatile uint32_t *reg = GPIO_BANK_REG(event_regs[i], bank);
+            *reg &= ~mask;
+        }
+    }
+    smp_unlock(&gpio_lock);
+}
@@ -5,9 +5,105 @@
  */
 
 #include "mailbox.h"
+#include "sync.h"
+#include "smp.h"
+#include "cache.h"
+#include "trace.h"
+#include "timer.h"
 
-/* Shared mailbox buffer - 16-byte aligned for DMA */
-volatile uint32_t __attribute__((aligned(16))) mailbox_buffer[256];
+/* Shared mailbox buffer - 16-byte aligned, non-cacheable (.dma) */
+volatile uint32_t __attribute__((aligned(16))) __dma mailbox_buffer[256];
+
+/* Recursive lock: owning core may re-enter (e.g. fb_init -> mailbox_call) */
+static spinlock_t mbox_lock = SPINLOCK_INIT;
+static volatile uint32_t mbox_owner = NUM_CORES;   /* NUM_CORES = unowned */
+static uint32_t mbox_depth;
+
+/* Updated under mbox_lock */
+static mailbox_stats_t mbox_stats;
+
+/* Property cache policies */
+typedef enum {
+    CACHE_NEVER,
+    CACHE_IMMUTABLE,
+    CACHE_TTL
+} cache_policy_t;
+
+typedef struct {
+    uint32_t tag;
+    cache_policy_t policy;
+    uint32_t ttl_ms;
+} cache_rule_t;
+
+/*
+ * Tags not listed are never cached. Current clock rates get a short TTL:
+ * the governor's changes go through SET_CLOCK_RATE and invalidate them,
+ * the firmware's own throttling shows up within 10 ms. Voltages and
+ * temperature are left uncached.
+ */
+static const cache_rule_t cache_rules[] = {
+    { TAG_GET_FIRMWARE,     CACHE_IMMUTABLE, 0 },
+    { TAG_GET_BOARD_MODEL,  CACHE_IMMUTABLE, 0 },
+    { TAG_GET_BOARD_REV,    CACHE_IMMUTABLE, 0 },
+    { TAG_GET_MAC_ADDR,     CACHE_IMMUTABLE, 0 },
+    { TAG_GET_BOARD_SERIAL, CACHE_IMMUTABLE, 0 },
+    { TAG_GET_ARM_MEMORY,   CACHE_IMMUTABLE, 0 },
+    { TAG_GET_VC_MEMORY,    CACHE_IMMUTABLE, 0 },
+    { TAG_GET_MAX_CLOCK,    CACHE_IMMUTABLE, 0 },
+    { TAG_GET_MIN_CLOCK,    CACHE_IMMUTABLE, 0 },
+    { TAG_GET_MAX_TEMP,     CACHE_IMMUTABLE, 0 },
+    { TAG_GET_CLOCK_RATE,   CACHE_TTL,       10 },
+    { TAG_GET_VOLTAGE,      CACHE_NEVER,     0 },
+    { TAG_GET_TEMPERATURE,  CACHE_NEVER,     0 },
+};
+
+typedef struct {
+    uint32_t tag;               /* 0 = free */
+    uint32_t count;
+    uint32_t request[MBOX_CACHE_MAX_WORDS];
+    uint32_t response[MBOX_CACHE_MAX_WORDS];
+    uint64_t expires;           /* Timer ticks, 0 = never */
+    uint64_t used;              /* For LRU replacement */
+} cache_entry_t;
+
+/* Under mbox_lock */
+static cache_entry_t cache[MBOX_CACHE_ENTRIES];
+static mailbox_cache_stats_t cache_stats;
+static uint64_t cache_clock;
+static bool cache_on = true;
+
+/*
+ * mailbox_lock - Take exclusive use of mailbox_buffer and the mailbox
+ *
+ * No spinlock before smp_started(): core 0 is alone and the MMU may
+ * still be off (uart_init queries its clock that early).
+ */
+void mailbox_lock(void) {
+    uint32_t core = smp_core_id();
+    
+    if (mbox_owner == core) {
+        mbox_depth++;
+        return;
+    }
+    
+    if (smp_started()) {
+        spin_lock(&mbox_lock);
+    }
+    mbox_owner = core;
+    mbox_depth = 1;
+}
+
+/*
+ * mailbox_unlock - Release one level of mailbox_lock()
+ */
+void mailbox_unlock(void) {
+    if (--mbox_depth == 0) {
+        mbox_owner = NUM_CORES;
+        if (smp_started()) {
+            spin_unlock(&mbox_lock);
+        }
+    }
+}
 
 /*
  * mailbox_write - Write to mailbox
@@ -52,13 +148,22 @@ uint32_t mailbox_read(uint8_t channel) {
  * @channel: Channel to use (typically MAILBOX_CH_PROP)
  * Returns: true on success
  * 
- * Uses the global mailbox_buffer for the message.
+ * Uses the global mailbox_buffer for the message. Callers that fill
+ * mailbox_buffer themselves must hold mailbox_lock() around it.
  */
 bool mailbox_call(uint8_t channel) {
     /* Get physical address of buffer (in lower 1GB, identity mapped) */
     uint32_t addr = (uint32_t)(uint64_t)&mailbox_buffer;
+    bool ok;
+    
+    trace_begin("mailbox_call");
+    mailbox_lock();
+    
+    /* Buffer writes must reach memory before the GPU is told about them */
+    dsb(sy);
     
     /* Write buffer address to mailbox */
+    uint64_t t0 = timer_ticks();
     mailbox_write(channel, addr);
     
     /* Wait for response */
@@ -72,8 +177,238 @@ bool mailbox_call(uint8_t channel) {
         
         /* Check if response is for us */
         if ((data & 0xF) == channel) {
+            /* No buffer reads from before the response arrived */
+            dsb(sy);
+            
             /* Check response code in buffer */
-            return mailbox_buffer[1] == 0x80000000;
+            ok = mailbox_buffer[1] == 0x80000000;
+            break;
+        }
+    }
+    
+    uint64_t ticks = timer_ticks() - t0;
+    mbox_stats.calls++;
+    mbox_stats.total_ticks += ticks;
+    mbox_stats.last_ticks = ticks;
+    if (ticks > mbox_stats.max_ticks) {
+        mbox_stats.max_ticks = ticks;
+    }
+    
+    mailbox_unlock();
+    trace_end("mailbox_call");
+    return ok;
+}
+
+/*
+ * mailbox_get_stats - Copy the round-trip statistics
+ */
+void mailbox_get_stats(mailbox_stats_t *stats) {
+    mailbox_lock();
+    *stats = mbox_stats;
+    mailbox_unlock();
+}
+
+/* Rule for a cacheable tag, NULL for CACHE_NEVER and unlisted tags */
+static const cache_rule_t *cache_rule(uint32_t tag) {
+    for (uint32_t i = 0; i < sizeof(cache_rules) / sizeof(cache_rules[0]); i++) {
+        if (cache_rules[i].tag == tag) {
+            return cache_rules[i].policy == CACHE_NEVER ? NULL : &cache_rules[i];
+        }
+    }
+    return NULL;
+}
+
+/* Entry answering this request, dropping it if its TTL has run out */
+static cache_entry_t *cache_lookup(uint32_t tag, const uint32_t *values, uint32_t count) {
+    for (uint32_t i = 0; i < MBOX_CACHE_ENTRIES; i++) {
+        cache_entry_t *e = &cache[i];
+        
+        if (e->tag != tag || e->count != count) {
+            continue;
+        }
+        
+        bool same = true;
+        for (uint32_t j = 0; j < count; j++) {
+            if (e->request[j] != values[j]) {
+                same = false;
+                break;
+            }
+        }
+        if (!same) {
+            continue;
+        }
+        
+        if (e->expires && timer_ticks() >= e->expires) {
+            e->tag = 0;
+            return NULL;
+        }
+        return e;
+    }
+    return NULL;
+}
+
+/* Remember a response, replacing a free or the least recently used entry */
+static void cache_store(const cache_rule_t *rule, const uint32_t *request,
+                        const uint32_t *response, uint32_t count) {
+    cache_entry_t *victim = &cache[0];
+    
+    for (uint32_t i = 0; i < MBOX_CACHE_ENTRIES; i++) {
+        if (cache[i].tag == 0) {
+            victim = &cache[i];
+            break;
         }
+        if (cache[i].used < victim->used) {
+            victim = &cache[i];
+        }
+    }
+    
+    victim->tag = rule->tag;
+    victim->count = count;
+    for (uint32_t j = 0; j < count; j++) {
+        victim->request[j] = request[j];
+        victim->response[j] = response[j];
+    }
+    victim->expires = rule->policy == CACHE_TTL ?
+                      timer_ticks() + timer_us_to_ticks((uint64_t)rule->ttl_ms * 1000) : 0;
+    victim->used = ++cache_clock;
+}
+
+/*
+ * mailbox_cache_invalidate - Drop cached responses for a get tag
+ * @tag: Tag to drop, or 0 for the whole cache
+ */
+void mailbox_cache_invalidate(uint32_t tag) {
+    mailbox_lock();
+    for (uint32_t i = 0; i < MBOX_CACHE_ENTRIES; i++) {
+        if (cache[i].tag && (tag == 0 || cache[i].tag == tag)) {
+            cache[i].tag = 0;
+            cache_stats.invalidations++;
+        }
+    }
+    mailbox_unlock();
+}
+
+/*
+ * mailbox_cache_enable - Turn the property cache on or off
+ *
+ * Turning it off also empties it; for measuring the uncached path.
+ */
+void mailbox_cache_enable(bool enable) {
+    mailbox_cache_invalidate(0);
+    cache_on = enable;
+}
+
+/*
+ * mailbox_cache_get_stats - Copy the property cache counters
+ */
+void mailbox_cache_get_stats(mailbox_cache_stats_t *stats) {
+    mailbox_lock();
+    *stats = cache_stats;
+    mailbox_unlock();
+}
+
+/*
+ * mailbox_property - Send a single-tag property request
+ * @tag: Property tag
+ * @values: Request values in, response values out
+ * @count: Size of the value buffer in 32-bit words
+ * Returns: true if the call succeeded and the firmware handled the tag
+ *
+ * Answered from the property cache when the tag's policy allows it.
+ */
+bool mailbox_property(uint32_t tag, uint32_t *values, uint32_t count) {
+    uint32_t request[MBOX_CACHE_MAX_WORDS];
+    uint32_t i = 0;
+    bool ok = false;
+    
+    mailbox_lock();
+    
+    const cache_rule_t *rule = cache_on && count <= MBOX_CACHE_MAX_WORDS ? cache_rule(tag) : NULL;
+    if (rule) {
+        cache_entry_t *e = cache_lookup(tag, values, count);
+        if (e) {
+            for (uint32_t j = 0; j < count; j++) {
+                values[j] = e->response[j];
+            }
+            e->used = ++cache_clock;
+            cache_stats.hits++;
+            mailbox_unlock();
+            return true;
+        }
+        for (uint32_t j = 0; j < count; j++) {
+            request[j] = values[j];
+        }
+        cache_stats.misses++;
+    } else {
+        cache_stats.uncached++;
+    }
+    
+    mailbox_buffer[i++] = 0;                    /* Size (fill later) */
+    mailbox_buffer[i++] = 0;                    /* Request code */
+    mailbox_buffer[i++] = tag;
+    mailbox_buffer[i++] = count * 4;            /* Value buffer size */
+    mailbox_buffer[i++] = 0;                    /* Request/response code */
+    
+    for (uint32_t j = 0; j < count; j++) {
+        mailbox_buffer[i++] = values[j];
+    }
+    
+    mailbox_buffer[i++] = TAG_END;
+    mailbox_buffer[0] = i * 4;
+    
+    if (mailbox_call(MAILBOX_CH_PROP) && (mailbox_buffer[4] & TAG_RESPONSE)) {
+        /* Copy response */
+        for (uint32_t j = 0; j < count; j++) {
+            values[j] = mailbox_buffer[5 + j];
+        }
+        ok = true;
+        
+        if (rule) {
+            cache_store(rule, request, values, count);
+        } else if (tag & MBOX_SET_BIT) {
+            mailbox_cache_invalidate(tag & ~MBOX_SET_BIT);
+        }
+    }
+    
+    mailbox_unlock();
+    return ok;
+}
+
+/*
+ * mailbox_property_early - mailbox_property() for core 0 before the MMU
+ * @tag: Property tag
+ * @values: Request values in, response values out
+ * @count: Size of the value buffer in 32-bit words
+ * Returns: true if the call succeeded and the firmware handled the tag
+ *
+ * No lock, cache, trace or statistics, so nothing touches an exclusive
+ * with translation off. Only valid before smp_start_secondaries().
+ */
+bool mailbox_property_early(uint32_t tag, uint32_t *values, uint32_t count) {
+    uint32_t addr = (uint32_t)(uint64_t)&mailbox_buffer;
+    uint32_t i = 0;
+    
+    mailbox_buffer[i++] = 0;
+    mailbox_buffer[i++] = 0;
+    mailbox_buffer[i++] = tag;
+    mailbox_buffer[i++] = count * 4;
+    mailbox_buffer[i++] = 0;
+    for (uint32_t j = 0; j < count; j++) {
+        mailbox_buffer[i++] = values[j];
+    }
+    mailbox_buffer[i++] = TAG_END;
+    mailbox_buffer[0] = i * 4;
+    
+    dsb(sy);
+    mailbox_write(MAILBOX_CH_PROP, addr);
+    mailbox_read(MAILBOX_CH_PROP);
+    dsb(sy);
+    
+    if (mailbox_buffer[1] != 0x80000000 || !(mailbox_buffer[4] & TAG_RESPONSE)) {
+        return false;
+    }
+    for (uint32_t j = 0; j < count; j++) {
+        values[j] = mailbox_buffer[5 + j];
     }
+    return true;
 }
@@ -0,0 +1,111 @@
+/*
+ * uart.c - PL011 UART Driver (polled)
+ *
+ * No interrupts, no buffering: transmit spins on the TX FIFO full flag.
+ * Good enough for logs and bulk dumps (framebuffer snapshots).
+ */
+
+#include "uart.h"
+#include "mailbox.h"
+
+/* Fallback if the firmware does not report the UART clock */
+#define UART_DEFAULT_CLOCK  48000000
+
+/*
+ * Query UART reference clock via mailbox
+ */
+static uint32_t uart_get_clock(void) {
+    uint32_t values[2] = { CLOCK_ID_UART, 0 };
+
+    if (!mailbox_property(TAG_GET_CLOCK_RATE, values, 2) || values[1] == 0) {
+        return UART_DEFAULT_CLOCK;
+    }
+
+    return values[1];
+}
+
+/*
+ * uart_init - Configure PL011 for 8N1 at the given baud rate
+ * @baud: Line rate in bits per second
+ */
+void uart_init(uint32_t baud) {
+    /* Disable UART while reconfiguring */
+    *UART0_CR = 0;
+
+    /* GPIO 14/15 to ALT0 (TXD0/RXD0), no pull-up/down */
+    gpio_set_function_mask(0, GPIO_BIT(14) | GPIO_BIT(15), GPIO_FUNC_ALT0);
+    gpio_set_pull_mask(0, GPIO_BIT(14) | GPIO_BIT(15), GPIO_PULL_NONE);
+
+    /* Clear pending interrupts, mask all (polled driver) */
+    *UART0_ICR = 0x7FF;
+    *UART0_IMSC = 0;
+
+    /*
+     * Divisor in 1/64ths: clock / (16 * baud) * 64 = clock * 4 / baud
+     * Integer part in IBRD, fraction in FBRD.
+     */
+    uint32_t div = (uint32_t)(((uint64_t)uart_get_clock() * 4 + baud / 2) / baud);
+    *UART0_IBRD = div >> 6;
+    *UART0_FBRD = div & 0x3F;
+
+    *UART0_LCRH = UART_LCRH_FEN | UART_LCRH_WLEN_8;
+    *UART0_CR = UART_CR_UARTEN | UART_CR_TXE | UART_CR_RXE;
+}
+
+/*
+ * uart_putc - Transmit one byte (blocks while TX FIFO is full)
+ */
+void uart_putc(char c) {
+    while (*UART0_FR & UART_FR_TXFF) {
+        asm volatile("nop");
+    }
+    *UART0_DR = (uint8_t)c;
+}
+
+/*
+ * uart_puts - Transmit a null-terminated string, '\n' becomes "\r\n"
+ */
+void uart_puts(const char *str) {
+    while (*str) {
+        if (*str == '\n') {
+            uart_putc('\r');
+        }
+        uart_putc(*str++);
+    }
+}
+
+/*
+ * uart_write - Transmit raw bytes (no newline translation)
+ */
+void uart_write(const uint8_t *data, size_t len) {
+    while (len--) {
+        uart_putc(*data++);
+    }
+}
+
+/*
+ * uart_try_getc - Non-blocking receive
+ * Returns: byte received, or -1 if RX FIFO is empty
+ */
+int uart_try_getc(void) {
+    if (*UART0_FR & UART_FR_RXFE) {
+        return -1;
+    }
+    return *UART0_DR & 0xFF;
+}
+
+/*
+ * uart_rx_ready - True if a received byte is waiting
+ */
+bool uart_rx_ready(void) {
+    return !(*UART0_FR & UART_FR_RXFE);
+}
+
+/*
+ * uart_flush - Wait until all queued bytes have left the shifter
+ */
+void uart_flush(void) {
+    while (*UART0_FR & UART_FR_BUSY) {
+        asm volatile("nop");
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ * assets.c - Embedded Asset Bundle
+ *
+ * A lookup hashes the name once and probes the index in place; the
+ * index is a few cache lines, and the returned pointer is the data
+ * in the kernel image.
+ */
+
+#include "assets.h"
+#include "string.h"
+
+/* From linker.ld */
+extern const uint8_t __assets_start[], __assets_end[];
+
+static uint32_t fnv1a(const char *s) {
+    uint32_t h = 0x811C9DC5;
+
+    while (*s) {
+        h = (h ^ (uint8_t)*s++) * 0x01000193;
+    }
+    return h;
+}
+
+/*
+ * assets_valid - Whether a well-formed bundle is linked in
+ */
+bool assets_valid(void) {
+    const asset_header_t *hdr = (const asset_header_t *)__assets_start;
+    uint64_t linked = __assets_end - __assets_start;
+
+    return linked >= sizeof(*hdr) && hdr->magic == ASSET_MAGIC && hdr->size <= linked &&
+           hdr->slots && (hdr->slots & (hdr->slots - 1)) == 0 &&
+           sizeof(*hdr) + hdr->slots * sizeof(asset_slot_t) <= hdr->size;
+}
+
+/*
+ * asset_find - Look up an asset by file name
+ * @name: Name under assets/, e.g. "logo.qoi"
+ * @size: Receives the size in bytes (may be NULL)
+ * Returns: Pointer into the kernel image, or NULL if not found
+ */
+const void *asset_find(const char *name, uint32_t *size) {
+    const asset_header_t *hdr = (const asset_header_t *)__assets_start;
+
+    if (!assets_valid()) {
+        return NULL;
+    }
+
+    const asset_slot_t *index = (const asset_slot_t *)(hdr + 1);
+    uint32_t hash = fnv1a(name);
+    uint32_t mask = hdr->slots - 1;
+
+    for (uint32_t i = 0, slot = hash & mask; i < hdr->slots; i++, slot = (slot + 1) & mask) {
+        const asset_slot_t *s = &index[slot];
+
+        if (s->name_off == ASSET_EMPTY) {
+            break;
+        }
+        if (s->hash == hash && strcmp((const char *)__assets_start + s->name_off, name) == 0) {
+            if (size) {
+                *size = s->size;
+            }
+            return __assets_start + s->data_off;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * asset_string - String of a string table (.txt asset)
+ * @table: Name of the table
+ * @index: Line number, from 0
+ * Returns: The NUL-terminated line, or "" if missing
+ */
+const char *asset_string(const char *table, uint32_t index) {
+    uint32_t size;
+    const char *s = asset_find(table, &size);
+
+    if (s == NULL) {
+        return "";
+    }
+
+    const char *end = s + size;
+    while (index-- > 0 && s < end) {
+        s += strlen(s) + 1;
+    }
+    return s < end ? s : "";
+}
@@ -0,0 +1,216 @@
+/*
+ * bcache.c - SD Block Cache (LRU + sequential readahead)
+ *
+ * Entries live on one LRU list (head = most recent) and on a hash
+ * chain keyed by LBA; both are linked by index so the whole cache is
+ * a couple of static arrays. A single lock covers lookups and fills.
+ */
+
+#include "bcache.h"
+#include "emmc.h"
+#include "string.h"
+#include "sync.h"
+#include "smp.h"
+
+#define NO_ENTRY        0xFFFF
+#define NO_LBA          0xFFFFFFFF
+
+typedef struct {
+    uint32_t lba;
+    uint16_t prev, next;        /* LRU list */
+    uint16_t hnext;             /* Hash chain */
+} bcache_entry_t;
+
+static bcache_entry_t entries[BCACHE_BLOCKS];
+static uint8_t __attribute__((aligned(16))) data[BCACHE_BLOCKS][EMMC_BLOCK_SIZE];
+static uint8_t __attribute__((aligned(16))) fill_buf[BCACHE_READAHEAD][EMMC_BLOCK_SIZE];
+
+static uint16_t hash_head[BCACHE_HASH_SIZE];
+static uint16_t lru_head, lru_tail;
+
+/* LBA a sequential reader would miss on next */
+static uint32_t seq_next = NO_LBA;
+
+static bcache_stats_t stats;
+static spinlock_t bcache_lock = SPINLOCK_INIT;    /* smp_lock: core 0 alone without the MMU */
+
+static inline uint32_t hash_lba(uint32_t lba) {
+    return lba % BCACHE_HASH_SIZE;
+}
+
+static void lru_unlink(uint16_t i) {
+    bcache_entry_t *e = &entries[i];
+
+    if (e->prev != NO_ENTRY) {
+        entries[e->prev].next = e->next;
+    } else {
+        lru_head = e->next;
+    }
+    if (e->next != NO_ENTRY) {
+        entries[e->next].prev = e->prev;
+    } else {
+        lru_tail = e->prev;
+    }
+}
+
+static void lru_push_head(uint16_t i) {
+    entries[i].prev = NO_ENTRY;
+    entries[i].next = lru_head;
+    if (lru_head != NO_ENTRY) {
+        entries[lru_head].prev = i;
+    }
+    lru_head = i;
+    if (lru_tail == NO_ENTRY) {
+        lru_tail = i;
+    }
+}
+
+static uint16_t hash_find(uint32_t lba) {
+    uint16_t i = hash_head[hash_lba(lba)];
+
+    while (i != NO_ENTRY && entries[i].lba != lba) {
+        i = entries[i].hnext;
+    }
+    return i;
+}
+
+static void hash_remove(uint16_t i) {
+    uint16_t *link = &hash_head[hash_lba(entries[i].lba)];
+
+    while (*link != NO_ENTRY) {
+        if (*link == i) {
+            *link = entries[i].hnext;
+            return;
+        }
+        link = &entries[*link].hnext;
+    }
+}
+
+/* Take the least recently used entry over for `lba` */
+static uint16_t claim(uint32_t lba) {
+    uint16_t i = lru_tail;
+
+    if (entries[i].lba != NO_LBA) {
+        hash_remove(i);
+    }
+    entries[i].lba = lba;
+    entries[i].hnext = hash_head[hash_lba(lba)];
+    hash_head[hash_lba(lba)] = i;
+
+    lru_unlink(i);
+    lru_push_head(i);
+    return i;
+}
+
+/*
+ * Fill after a miss: one block, or a readahead run if the miss
+ * continues a sequential pattern. Returns the entry for `lba`.
+ */
+static uint16_t fill(uint32_t lba) {
+    uint32_t count = 1;
+
+    if (lba == seq_next) {
+        count = BCACHE_READAHEAD;
+    }
+
+    /* Readahead past the end of the card fails; retry the single block */
+    if (!emmc_read(lba, count, fill_buf)) {
+        if (count == 1 || !emmc_read(lba, 1, fill_buf)) {
+            return NO_ENTRY;
+        }
+        count = 1;
+    }
+
+    if (count > 1) {
+        stats.readaheads++;
+        stats.prefetched += count - 1;
+    }
+    seq_next = lba + count;
+
+    /* Insert in reverse so the requested block ends up most recent */
+    uint16_t result = NO_ENTRY;
+    for (uint32_t n = count; n-- > 0; ) {
+        if (n > 0 && hash_find(lba + n) != NO_ENTRY) {
+            continue;
+        }
+        uint16_t i = claim(lba + n);
+        memcpy(data[i], fill_buf[n], EMMC_BLOCK_SIZE);
+        if (n == 0) {
+            result = i;
+        }
+    }
+
+    return result;
+}
+
+/*
+ * bcache_init - Empty the cache
+ */
+void bcache_init(void) {
+    smp_lock(&bcache_lock);
+
+    for (uint32_t h = 0; h < BCACHE_HASH_SIZE; h++) {
+        hash_head[h] = NO_ENTRY;
+    }
+
+    lru_head = lru_tail = NO_ENTRY;
+    for (uint16_t i = 0; i < BCACHE_BLOCKS; i++) {
+        entries[i].lba = NO_LBA;
+        entries[i].hnext = NO_ENTRY;
+        lru_push_head(i);
+    }
+
+    seq_next = NO_LBA;
+    memset(&stats, 0, sizeof(stats));
+
+    smp_unlock(&bcache_lock);
+}
+
+/*
+ * bcache_read - Copy part of a block through the cache
+ * @lba: Block number
+ * @offset: Byte offset within the block
+ * @dst: Destination
+ * @len: Bytes to copy (offset + len <= 512)
+ * Returns: false on a read error or bad range
+ */
+bool bcache_read(uint32_t lba, uint32_t offset, void *dst, uint32_t len) {
+    if (offset + len > EMMC_BLOCK_SIZE) {
+        return false;
+    }
+
+    smp_lock(&bcache_lock);
+
+    uint16_t i = hash_find(lba);
+    if (i != NO_ENTRY) {
+        stats.hits++;
+        lru_unlink(i);
+        lru_push_head(i);
+    } else {
+        stats.misses++;
+        i = fill(lba);
+    }
+
+    if (i != NO_ENTRY) {
+        memcpy(dst, data[i] + offset, len);
+    }
+
+    smp_unlock(&bcache_lock);
+    return i != NO_ENTRY;
+}
+
+/*
+ * bcache_invalidate - Drop every cached block (e.g. after a card change)
+ */
+void bcache_invalidate(void) {
+    bcache_init();
+}
+
+/*
+ * bcache_get_stats - Copy the hit/miss counters
+ */
+void bcache_get_stats(bcache_stats_t *out) {
+    smp_lock(&bcache_lock);
+    *out = stats;
+    smp_unlock(&bcache_lock);
+}
@@ -0,0 +1,98 @@
+/*
+ * bench.c - In-kernel Benchmarks (runner and reporting)
+ */
+
+#include "bench.h"
+#include "uart.h"
+#include "timer.h"
+#include "string.h"
+#include "smp.h"
+
+#define NAME_COLUMN     24
+
+/* Print a string left-aligned in a fixed-width column */
+static void put_padded(const char *str, uint32_t width) {
+    uint32_t len = strlen(str);
+    uart_puts(str);
+    while (len++ < width) {
+        uart_putc(' ');
+    }
+}
+
+/* Print value/10 with one decimal */
+static void put_tenths(uint64_t tenths) {
+    char num[24];
+    u64toa(tenths / 10, num, 10);
+    uart_puts(num);
+    uart_putc('.');
+    uart_putc('0' + tenths % 10);
+}
+
+/*
+ * bench_header - Start a benchmark section
+ */
+void bench_header(const char *title) {
+    uart_puts("\n--- ");
+    uart_puts(title);
+    uart_puts(" ---\n");
+}
+
+/*
+ * bench_result - Report one measurement
+ * @name: What was measured
+ * @cores: Cores taking part
+ * @ops: Total operations across all cores
+ * @ticks: Wall time in generic timer ticks
+ */
+void bench_result(const char *name, uint32_t cores, uint64_t ops, uint64_t ticks) {
+    char num[24];
+    uint64_t ns = ticks * 1000000000 / timer_freq();
+
+    uart_puts("  ");
+    put_padded(name, NAME_COLUMN);
+    utoa(cores, num, 10);
+    uart_puts(num);
+    uart_puts(cores == 1 ? " core   " : " cores  ");
+    u64toa(ops, num, 10);
+    uart_puts(num);
+    uart_puts(" ops  ");
+    put_tenths(ops ? ns * 10 / ops : 0);
+    uart_puts(" ns/op  ");
+    put_tenths(ns ? ops * 10000 / ns : 0);
+    uart_puts(" Mops/s\n");
+}
+
+/*
+ * bench_note - Report a free-form line under a benchmark
+ */
+void bench_note(const char *name, const char *text) {
+    uart_puts("  ");
+    put_padded(name, NAME_COLUMN);
+    uart_puts(text);
+    uart_puts("\n");
+}
+
+/*
+ * bench_run_all - Run every benchmark suite
+ */
+void bench_run_all(void) {
+    uart_puts("\n=== Benchmarks ===\n");
+    if (!smp_started()) {
+        uart_puts("Skipped: core 0 alone without the MMU, no exclusives for locks and barriers\n");
+        return;
+    }
+    syncbench_run();
+    schedbench_run();
+    fiberbench_run();
+    fsbench_run();
+    qoibench_run();
+    gpiobench_run();
+    fmtbench_run();
+    tracebench_run();
+    gfxbench_run();
+    dlbench_run();
+    mboxbench_run();
+    ipibench_run();
+    membench_run();
+    uart_puts("\n=== Benchmarks done ===\n");
+}
@@ -0,0 +1,115 @@
+/*
+ * bootprof.c - Boot Phase Timeline
+ *
+ * Mark 0 is the _start entry timestamp; every later mark closes the
+ * phase that began at the mark before it. The counter runs from SoC
+ * power-on, so mark 0 also tells how long the firmware took. When the
+ * kernel was unpacked by the LZ4 stub, boot_ts_stub splits that into
+ * firmware load and decompression time.
+ */
+
+#include "bootprof.h"
+#include "timer.h"
+#include "trace.h"
+#include "uart.h"
+#include "string.h"
+
+uint64_t boot_ts_entry;
+uint64_t boot_ts_bss;
+uint64_t boot_ts_stub;
+
+static boot_mark_t marks[BOOTPROF_MAX_MARKS];
+static uint32_t mark_count;
+
+/*
+ * bootprof_init - Seed the timeline with the boot.S timestamps
+ */
+void bootprof_init(void) {
+    marks[0].name = "_start";
+    marks[0].ticks = boot_ts_entry;
+    marks[1].name = "bss clear";
+    marks[1].ticks = boot_ts_bss;
+    mark_count = 2;
+}
+
+/*
+ * boot_mark - End the current phase
+ * @name: Phase name (must be a string literal / static)
+ * Returns: Index of the mark (for bootprof_elapsed_us)
+ */
+uint32_t boot_mark(const char *name) {
+    if (mark_count >= BOOTPROF_MAX_MARKS) {
+        return mark_count - 1;
+    }
+    marks[mark_count].name = name;
+    marks[mark_count].ticks = timer_ticks();
+    trace_instant(name);
+    return mark_count++;
+}
+
+uint32_t bootprof_count(void) {
+    return mark_count;
+}
+
+const boot_mark_t *bootprof_get(uint32_t index) {
+    return index < mark_count ? &marks[index] : NULL;
+}
+
+/*
+ * bootprof_elapsed_us - Time from _start to the given mark
+ */
+uint64_t bootprof_elapsed_us(uint32_t index) {
+    if (index >= mark_count) {
+        return 0;
+    }
+    return timer_ticks_to_us(marks[index].ticks - marks[0].ticks);
+}
+
+/*
+ * bootprof_phase_us - Duration of the phase ending at the given mark
+ */
+uint64_t bootprof_phase_us(uint32_t index) {
+    if (index == 0 || index >= mark_count) {
+        return 0;
+    }
+    return timer_ticks_to_us(marks[index].ticks - marks[index - 1].ticks);
+}
+
+/*
+ * bootprof_report - Dump the timeline over serial
+ */
+void bootprof_report(void) {
+    char num[24];
+
+    uart_puts("Boot timeline (us since _start, phase):\n");
+    if (boot_ts_stub) {
+        uart_puts("  firmware before stub: ");
+        u64toa(timer_ticks_to_us(boot_ts_stub), num, 10);
+        uart_puts(num);
+        uart_puts(" us\n  lz4 unpack: ");
+        u64toa(timer_ticks_to_us(marks[0].ticks - boot_ts_stub), num, 10);
+    } else {
+        uart_puts("  firmware before _start: ");
+        u64toa(timer_ticks_to_us(marks[0].ticks), num, 10);
+    }
+    uart_puts(num);
+    uart_puts(" us\n");
+
+    for (uint32_t i = 1; i < mark_count; i++) {
+        uart_puts("  ");
+        uart_puts(marks[i].name);
+        uart_puts(": ");
+        u64toa(bootprof_elapsed_us(i), num, 10);
+        uart_puts(num);
+        uart_puts(" (+");
+        u64toa(bootprof_phase_us(i), num, 10);
+        uart_puts(num);
+        uart_puts(")\n");
+    }
+
+    /* Comparable between plain and compressed images */
+    uart_puts("  total since power-on: ");
+    u64toa(timer_ticks_to_us(marks[mark_count - 1].ticks), num, 10);
+    uart_puts(num);
+    uart_puts(" us\n");
+}
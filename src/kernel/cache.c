@@ -0,0 +1,109 @@
+/*
+ * cache.c - Cache Maintenance
+ *
+ * Clean and invalidate go to the point of coherency (PoC), where the
+ * VideoCore and DMA engines see memory. With the MMU off, or for
+ * non-cacheable pages, the operations are harmless no-ops.
+ */
+
+#include "cache.h"
+#include "sync.h"
+
+#define DC_RANGE(op, start, len) do {                                   \
+    uint64_t line_ = dcache_line_size();                                \
+    uint64_t p_ = (uint64_t)(start) & ~(line_ - 1);                     \
+    uint64_t end_ = (uint64_t)(start) + (len);                          \
+    for (; p_ < end_; p_ += line_) {                                    \
+        asm volatile("dc " #op ", %0" :: "r"(p_) : "memory");           \
+    }                                                                   \
+} while (0)
+
+/*
+ * dcache_clean_range - Write dirty lines back to memory
+ * @start: First byte
+ * @len: Bytes
+ *
+ * Use before a device reads memory the CPU wrote through the cache.
+ */
+void dcache_clean_range(const void *start, size_t len) {
+    DC_RANGE(cvac, start, len);
+    dsb(sy);
+}
+
+/*
+ * dcache_invalidate_range - Drop lines so the next read comes from memory
+ * @start: First byte
+ * @len: Bytes
+ *
+ * Use after a device wrote memory, before the CPU reads it. Lines only
+ * partly inside the range are cleaned as well, so neighbouring data
+ * sharing the line is not lost.
+ */
+void dcache_invalidate_range(void *start, size_t len) {
+    uint64_t line = dcache_line_size();
+    uint64_t p = (uint64_t)start;
+    uint64_t end = p + len;
+
+    if (len == 0) {
+        return;
+    }
+
+    if (p & (line - 1)) {
+        p &= ~(line - 1);
+        asm volatile("dc civac, %0" :: "r"(p) : "memory");
+        p += line;
+    }
+    if (end & (line - 1) && p < end) {
+        end &= ~(line - 1);
+        asm volatile("dc civac, %0" :: "r"(end) : "memory");
+    }
+
+    for (; p < end; p += line) {
+        asm volatile("dc ivac, %0" :: "r"(p) : "memory");
+    }
+    dsb(sy);
+}
+
+/*
+ * dcache_clean_invalidate_range - Write back and drop lines
+ * @start: First byte
+ * @len: Bytes
+ *
+ * For buffers that go both ways (e.g. a device updates a descriptor
+ * the CPU filled in).
+ */
+void dcache_clean_invalidate_range(const void *start, size_t len) {
+    DC_RANGE(civac, start, len);
+    dsb(sy);
+}
+
+/*
+ * icache_sync_range - Make code written as data executable
+ * @start: First byte
+ * @len: Bytes
+ *
+ * Cleans the D-cache to the point of unification, then invalidates the
+ * I-cache over the range (inner shareable: all cores).
+ */
+void icache_sync_range(const void *start, size_t len) {
+    uint64_t line = icache_line_size();
+    uint64_t end = (uint64_t)start + len;
+
+    DC_RANGE(cvau, start, len);
+    dsb(ish);
+
+    for (uint64_t p = (uint64_t)start & ~(line - 1); p < end; p += line) {
+        asm volatile("ic ivau, %0" :: "r"(p) : "memory");
+    }
+    dsb(ish);
+    isb();
+}
+
+/*
+ * icache_invalidate_all - Invalidate the whole I-cache on all cores
+ */
+void icache_invalidate_all(void) {
+    asm volatile("ic ialluis" ::: "memory");
+    dsb(ish);
+    isb();
+}
@@ -0,0 +1,27 @@
+/*
+ * cpustat.c - Per-core Idle Accounting
+ */
+
+#include "cpustat.h"
+
+cpustat_t cpustats[NUM_CORES];
+
+/*
+ * cpustat_idle_ticks - Total idle time of a core, including a period
+ *                      still in progress
+ *
+ * Read from another core without a lock: a period ending during the
+ * read may be counted in neither or both halves, an error of at most
+ * one period that the next reading corrects.
+ */
+uint64_t cpustat_idle_ticks(uint32_t core) {
+    const cpustat_t *st = &cpustats[core];
+    uint64_t since = st->idle_since;
+    uint64_t idle = st->idle_ticks;
+
+    if (since) {
+        uint64_t now = timer_ticks();
+        idle += now > since ? now - since : 0;
+    }
+    return idle;
+}
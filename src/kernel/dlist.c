@@ -0,0 +1,371 @@
+/*
+ * dlist.c - Tile-binned Display List
+ *
+ * Each tile keeps a singly linked list of references into cmds[], in
+ * recording order, so tiles replay their commands in the same order
+ * immediate drawing would have used. Rendering clips every command to
+ * the tile's surface; a command spanning several tiles is replayed in
+ * each of them.
+ */
+
+#include "dlist.h"
+#include "font8x8.h"
+#include "sched.h"
+#include "smp.h"
+#include "string.h"
+
+#define REF_NONE    0xFFFF
+
+/* One tile of pixels per core, resident in its L1 */
+static uint32_t scratch[NUM_CORES][DL_TILE_SIZE * DL_TILE_SIZE] __attribute__((aligned(64)));
+
+/* Per-core traffic, summed into dl->stats after the render */
+static dl_stats_t core_stats[NUM_CORES];
+
+/* Pixel rows are 8-byte aligned in both directions except on odd x */
+typedef uint64_t __attribute__((may_alias)) pixel_pair_t;
+
+static void copy_pixels(uint32_t *dst, const uint32_t *src, uint32_t n) {
+    if ((((uint64_t)dst | (uint64_t)src) & 7) == 0) {
+        pixel_pair_t *d = (pixel_pair_t *)dst;
+        const pixel_pair_t *s = (const pixel_pair_t *)src;
+        for (; n >= 2; n -= 2) {
+            *d++ = *s++;
+        }
+        dst = (uint32_t *)d;
+        src = (const uint32_t *)s;
+    }
+    while (n--) {
+        *dst++ = *src++;
+    }
+}
+
+/*
+ * dl_begin - Start an empty display list
+ * @target: Surface dl_render() draws to (e.g. from gfx_screen)
+ * Returns: false if the target has more than DL_MAX_TILES tiles
+ */
+bool dl_begin(dlist_t *dl, const gfx_surface_t *target) {
+    dl->target = target;
+    dl->tiles_x = (target->width + DL_TILE_SIZE - 1) / DL_TILE_SIZE;
+    dl->tiles_y = (target->height + DL_TILE_SIZE - 1) / DL_TILE_SIZE;
+    dl->ncmds = 0;
+    dl->nrefs = 0;
+    dl->text_used = 0;
+    dl->overflow = false;
+    memset(&dl->stats, 0, sizeof(dl->stats));
+
+    if (dl->tiles_x * dl->tiles_y > DL_MAX_TILES) {
+        dl->tiles_x = 0;
+        dl->tiles_y = 0;
+        return false;
+    }
+    for (uint32_t t = 0; t < dl->tiles_x * dl->tiles_y; t++) {
+        dl->head[t] = REF_NONE;
+        dl->covered[t] = false;
+    }
+    return true;
+}
+
+static dl_cmd_t *new_cmd(dlist_t *dl, uint32_t type) {
+    if (dl->ncmds >= DL_MAX_CMDS) {
+        dl->overflow = true;
+        return NULL;
+    }
+    dl_cmd_t *cmd = &dl->cmds[dl->ncmds++];
+    cmd->type = type;
+    return cmd;
+}
+
+static int32_t clamp(int32_t v, int32_t lo, int32_t hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+/* Bytes an immediate draw of w x h pixels would store, clipped to the target */
+static uint64_t clipped_bytes(const gfx_surface_t *t, int32_t x, int32_t y, int32_t w, int32_t h) {
+    int32_t x0 = clamp(x, t->x, t->x + t->width);
+    int32_t y0 = clamp(y, t->y, t->y + t->height);
+    int32_t x1 = clamp(x + w, t->x, t->x + t->width);
+    int32_t y1 = clamp(y + h, t->y, t->y + t->height);
+    return (uint64_t)(x1 - x0) * (y1 - y0) * 4;
+}
+
+/*
+ * bin - Add the newest command to every tile its bounding box touches
+ * @x0, @y0, @x1, @y1: Bounding box in screen coordinates (inclusive)
+ * @opaque: The command paints its whole bounding box
+ */
+static bool bin(dlist_t *dl, int32_t x0, int32_t y0, int32_t x1, int32_t y1, bool opaque) {
+    const gfx_surface_t *t = dl->target;
+    uint16_t index = dl->ncmds - 1;
+
+    x0 -= t->x;
+    x1 -= t->x;
+    y0 -= t->y;
+    y1 -= t->y;
+    if (x1 < 0 || y1 < 0 || x0 >= (int32_t)t->width || y0 >= (int32_t)t->height ||
+        x0 > x1 || y0 > y1) {
+        dl->ncmds--;                /* Entirely off the target */
+        return true;
+    }
+    x0 = clamp(x0, 0, t->width - 1);
+    y0 = clamp(y0, 0, t->height - 1);
+    x1 = clamp(x1, 0, t->width - 1);
+    y1 = clamp(y1, 0, t->height - 1);
+
+    for (uint32_t ty = y0 / DL_TILE_SIZE; ty <= (uint32_t)y1 / DL_TILE_SIZE; ty++) {
+        for (uint32_t tx = x0 / DL_TILE_SIZE; tx <= (uint32_t)x1 / DL_TILE_SIZE; tx++) {
+            uint32_t tile = ty * dl->tiles_x + tx;
+            int32_t left = tx * DL_TILE_SIZE, top = ty * DL_TILE_SIZE;
+            int32_t right = clamp(left + DL_TILE_SIZE - 1, 0, t->width - 1);
+            int32_t bottom = clamp(top + DL_TILE_SIZE - 1, 0, t->height - 1);
+
+            /* Everything before a whole-tile fill is hidden by it */
+            if (opaque && x0 <= left && y0 <= top && x1 >= right && y1 >= bottom) {
+                dl->head[tile] = REF_NONE;
+                dl->covered[tile] = true;
+            }
+
+            if (dl->nrefs >= DL_MAX_REFS) {
+                dl->overflow = true;
+                return false;
+            }
+            uint16_t ref = dl->nrefs++;
+            dl->ref_cmd[ref] = index;
+            dl->ref_next[ref] = REF_NONE;
+            if (dl->head[tile] == REF_NONE) {
+                dl->head[tile] = ref;
+            } else {
+                dl->ref_next[dl->tail[tile]] = ref;
+            }
+            dl->tail[tile] = ref;
+        }
+    }
+    return true;
+}
+
+/*
+ * dl_fill - Record a filled rectangle
+ * Returns: false if the list is full (the command is dropped)
+ */
+bool dl_fill(dlist_t *dl, int32_t x, int32_t y, int32_t w, int32_t h, color_t color) {
+    dl_cmd_t *cmd;
+
+    if (w <= 0 || h <= 0) {
+        return true;
+    }
+    if (!(cmd = new_cmd(dl, DL_FILL))) {
+        return false;
+    }
+    cmd->x0 = x;
+    cmd->y0 = y;
+    cmd->x1 = w;
+    cmd->y1 = h;
+    cmd->fg = color;
+    dl->stats.direct_bytes += clipped_bytes(dl->target, x, y, w, h);
+    return bin(dl, x, y, x + w - 1, y + h - 1, true);
+}
+
+/*
+ * dl_rect - Record a rectangle outline
+ */
+bool dl_rect(dlist_t *dl, int32_t x, int32_t y, int32_t w, int32_t h, color_t color) {
+    dl_cmd_t *cmd;
+
+    if (w <= 0 || h <= 0) {
+        return true;
+    }
+    if (!(cmd = new_cmd(dl, DL_RECT))) {
+        return false;
+    }
+    cmd->x0 = x;
+    cmd->y0 = y;
+    cmd->x1 = w;
+    cmd->y1 = h;
+    cmd->fg = color;
+    dl->stats.direct_bytes += (uint64_t)(w + h) * 2 * 4;
+    return bin(dl, x, y, x + w - 1, y + h - 1, false);
+}
+
+/*
+ * dl_line - Record a line (both end points included)
+ */
+bool dl_line(dlist_t *dl, int32_t x0, int32_t y0, int32_t x1, int32_t y1, color_t color) {
+    dl_cmd_t *cmd = new_cmd(dl, DL_LINE);
+
+    if (!cmd) {
+        return false;
+    }
+    cmd->x0 = x0;
+    cmd->y0 = y0;
+    cmd->x1 = x1;
+    cmd->y1 = y1;
+    cmd->fg = color;
+
+    int32_t dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int32_t dy = y1 > y0 ? y1 - y0 : y0 - y1;
+    dl->stats.direct_bytes += (uint64_t)((dx > dy ? dx : dy) + 1) * 4;
+    return bin(dl, x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1,
+               x0 < x1 ? x1 : x0, y0 < y1 ? y1 : y0, false);
+}
+
+/*
+ * dl_text - Record a string (copied), drawn as by fb_draw_string()
+ */
+bool dl_text(dlist_t *dl, int32_t x, int32_t y, const char *str, color_t fg, color_t bg) {
+    size_t len = strlen(str);
+    uint32_t cols = 0, max_cols = 0, lines = 1;
+    dl_cmd_t *cmd;
+
+    if (dl->text_used + len + 1 > DL_TEXT_SIZE) {
+        dl->overflow = true;
+        return false;
+    }
+    if (!(cmd = new_cmd(dl, DL_TEXT))) {
+        return false;
+    }
+
+    char *copy = &dl->text[dl->text_used];
+    memcpy(copy, str, len + 1);
+    dl->text_used += len + 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (str[i] == '\n') {
+            lines++;
+            cols = 0;
+        } else if (++cols > max_cols) {
+            max_cols = cols;
+        }
+    }
+
+    cmd->x0 = x;
+    cmd->y0 = y;
+    cmd->fg = fg;
+    cmd->bg = bg;
+    cmd->text = copy;
+    dl->stats.direct_bytes += (uint64_t)(len - (lines - 1)) * FONT_WIDTH * FONT_HEIGHT * 4;
+    return bin(dl, x, y, x + max_cols * FONT_WIDTH - 1,
+               y + (lines - 1) * (FONT_HEIGHT + 2) + FONT_HEIGHT - 1, false);
+}
+
+/*
+ * dl_blit - Record a copy of opaque pixels (not copied: must stay valid
+ *           until dl_render)
+ * @stride: Pixels between rows of @pixels
+ */
+bool dl_blit(dlist_t *dl, int32_t x, int32_t y, uint32_t w, uint32_t h,
+             const uint32_t *pixels, uint32_t stride) {
+    dl_cmd_t *cmd;
+
+    if (w == 0 || h == 0) {
+        return true;
+    }
+    if (!(cmd = new_cmd(dl, DL_BLIT))) {
+        return false;
+    }
+    cmd->x0 = x;
+    cmd->y0 = y;
+    cmd->x1 = w;
+    cmd->y1 = h;
+    cmd->pixels = pixels;
+    cmd->stride = stride;
+    dl->stats.direct_bytes += clipped_bytes(dl->target, x, y, w, h);
+    return bin(dl, x, y, x + w - 1, y + h - 1, true);
+}
+
+/* The part of a blit that falls on the tile */
+static void blit_tile(const gfx_surface_t *tile, const dl_cmd_t *cmd) {
+    int32_t x0 = cmd->x0 > tile->x ? cmd->x0 : tile->x;
+    int32_t y0 = cmd->y0 > tile->y ? cmd->y0 : tile->y;
+    int32_t x1 = clamp(cmd->x0 + cmd->x1, x0, tile->x + tile->width);
+    int32_t y1 = clamp(cmd->y0 + cmd->y1, y0, tile->y + tile->height);
+
+    for (int32_t y = y0; y < y1; y++) {
+        copy_pixels(tile->pixels + (y - tile->y) * tile->stride + (x0 - tile->x),
+                    cmd->pixels + (y - cmd->y0) * cmd->stride + (x0 - cmd->x0), x1 - x0);
+    }
+}
+
+static void draw_cmd(const gfx_surface_t *tile, const dl_cmd_t *cmd) {
+    switch (cmd->type) {
+    case DL_FILL:
+        gfx_fill_rect(tile, cmd->x0, cmd->y0, cmd->x1, cmd->y1, cmd->fg);
+        break;
+    case DL_RECT:
+        gfx_rect(tile, cmd->x0, cmd->y0, cmd->x1, cmd->y1, cmd->fg);
+        break;
+    case DL_LINE:
+        gfx_line(tile, cmd->x0, cmd->y0, cmd->x1, cmd->y1, cmd->fg);
+        break;
+    case DL_TEXT:
+        gfx_text(tile, cmd->x0, cmd->y0, cmd->text, cmd->fg, cmd->bg);
+        break;
+    case DL_BLIT:
+        blit_tile(tile, cmd);
+        break;
+    }
+}
+
+/* parallel_for body: render tiles [begin, end) on this core */
+static void render_tiles(uint32_t begin, uint32_t end, void *arg) {
+    dlist_t *dl = arg;
+    const gfx_surface_t *target = dl->target;
+    uint32_t core = smp_core_id();
+    dl_stats_t *st = &core_stats[core];
+
+    for (uint32_t t = begin; t < end; t++) {
+        if (dl->head[t] == REF_NONE) {
+            continue;
+        }
+
+        uint32_t lx = (t % dl->tiles_x) * DL_TILE_SIZE;
+        uint32_t ly = (t / dl->tiles_x) * DL_TILE_SIZE;
+        gfx_surface_t tile = {
+            scratch[core], DL_TILE_SIZE, target->x + lx, target->y + ly,
+            target->width - lx < DL_TILE_SIZE ? target->width - lx : DL_TILE_SIZE,
+            target->height - ly < DL_TILE_SIZE ? target->height - ly : DL_TILE_SIZE,
+        };
+        uint32_t *dst = target->pixels + ly * target->stride + lx;
+
+        if (!dl->covered[t]) {
+            for (uint32_t row = 0; row < tile.height; row++) {
+                copy_pixels(tile.pixels + row * DL_TILE_SIZE, dst + row * target->stride,
+                            tile.width);
+            }
+            st->read_bytes += tile.width * tile.height * 4;
+        }
+
+        for (uint16_t ref = dl->head[t]; ref != REF_NONE; ref = dl->ref_next[ref]) {
+            draw_cmd(&tile, &dl->cmds[dl->ref_cmd[ref]]);
+        }
+
+        for (uint32_t row = 0; row < tile.height; row++) {
+            copy_pixels(dst + row * target->stride, tile.pixels + row * DL_TILE_SIZE, tile.width);
+        }
+        st->written_bytes += tile.width * tile.height * 4;
+        st->tiles_written++;
+    }
+}
+
+/*
+ * dl_render - Draw the recorded commands to the target, tile by tile
+ *
+ * Uses every core the scheduler runs on (core 0 alone if it is
+ * stopped). The list can be rendered again; record into a fresh
+ * dl_begin() for the next frame.
+ */
+void dl_render(dlist_t *dl) {
+    uint32_t tiles = dl->tiles_x * dl->tiles_y;
+
+    memset(core_stats, 0, sizeof(core_stats));
+    parallel_for(0, tiles, dl->tiles_x, render_tiles, dl);
+
+    dl->stats.written_bytes = 0;
+    dl->stats.read_bytes = 0;
+    dl->stats.tiles_written = 0;
+    for (uint32_t core = 0; core < NUM_CORES; core++) {
+        dl->stats.written_bytes += core_stats[core].written_bytes;
+        dl->stats.read_bytes += core_stats[core].read_bytes;
+        dl->stats.tiles_written += core_stats[core].tiles_written;
+    }
+}
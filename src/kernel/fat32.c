@@ -0,0 +1,485 @@
+/*
+ * fat32.c - Read-only FAT32 Filesystem
+ *
+ * Metadata (boot sector, FAT, directories) goes through the block
+ * cache. File data that covers whole blocks is read straight into the
+ * caller's buffer, one multi-block SD read per extent, so streaming a
+ * large asset neither pollutes the cache nor pays per-block overhead.
+ */
+
+#include "fat32.h"
+#include "bcache.h"
+#include "emmc.h"
+#include "string.h"
+
+#define SECTOR_SIZE         EMMC_BLOCK_SIZE
+#define DIRENT_SIZE         32
+
+/* MBR partition table */
+#define MBR_SIGNATURE       0xAA55
+#define MBR_PART_TABLE      446
+#define MBR_PART_COUNT      4
+#define PART_TYPE_FAT32_CHS 0x0B
+#define PART_TYPE_FAT32_LBA 0x0C
+
+/* FAT entries */
+#define FAT_ENTRY_MASK      0x0FFFFFFF
+
+/* Short-name case flags (NT reserved byte) */
+#define SFN_LOWER_BASE      0x08
+#define SFN_LOWER_EXT       0x10
+
+static bool mounted;
+static uint32_t sectors_per_cluster;
+static uint32_t cluster_bytes;
+static uint32_t fat_start;          /* LBA of the first FAT */
+static uint32_t data_start;         /* LBA of cluster 2 */
+static uint32_t cluster_count;
+static uint32_t root_cluster;
+
+static inline uint16_t rd16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t rd32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline bool cluster_valid(uint32_t c) {
+    return c >= 2 && c < cluster_count + 2;
+}
+
+static inline uint32_t cluster_lba(uint32_t c) {
+    return data_start + (c - 2) * sectors_per_cluster;
+}
+
+/* Next cluster in the chain, or 0 at end-of-chain, bad cluster or error */
+static uint32_t fat_next(uint32_t c) {
+    uint8_t entry[4];
+    uint32_t offset = c * 4;
+
+    if (!bcache_read(fat_start + offset / SECTOR_SIZE, offset % SECTOR_SIZE, entry, 4)) {
+        return 0;
+    }
+
+    uint32_t next = rd32(entry) & FAT_ENTRY_MASK;
+    return cluster_valid(next) ? next : 0;
+}
+
+/*
+ * Walk a chain from `first` into file->extents. Files stop after the
+ * clusters their size needs; directories run to the end of the chain.
+ */
+static void open_chain(fat_file_t *file, uint32_t first, uint32_t size, bool is_dir) {
+    memset(file, 0, sizeof(*file));
+    file->size = size;
+    file->is_dir = is_dir;
+    file->chain_complete = true;
+
+    uint32_t limit = is_dir ? cluster_count : (size + cluster_bytes - 1) / cluster_bytes;
+    uint32_t c = cluster_valid(first) ? first : 0;
+
+    while (c != 0 && file->clusters < limit) {
+        fat_extent_t *last = file->nextents ? &file->extents[file->nextents - 1] : NULL;
+
+        if (last && c == last->cluster + last->count) {
+            last->count++;
+        } else if (file->nextents < FAT_MAX_EXTENTS) {
+            file->extents[file->nextents].cluster = c;
+            file->extents[file->nextents].count = 1;
+            file->nextents++;
+        } else {
+            file->chain_complete = false;
+        }
+
+        file->clusters++;
+        c = fat_next(c);
+    }
+
+    /* Directories have no size field; a short chain truncates a file */
+    uint32_t chain_bytes = file->clusters * cluster_bytes;
+    if (is_dir || file->size > chain_bytes) {
+        file->size = chain_bytes;
+    }
+}
+
+/*
+ * Disk cluster for the file's `index`th cluster; *run is how many
+ * clusters from there on are contiguous. Returns 0 if out of range.
+ */
+static uint32_t file_cluster(const fat_file_t *file, uint32_t index, uint32_t *run) {
+    for (uint32_t i = 0; i < file->nextents; i++) {
+        const fat_extent_t *e = &file->extents[i];
+
+        if (index < e->count) {
+            *run = e->count - index;
+            return e->cluster + index;
+        }
+        index -= e->count;
+    }
+
+    if (file->chain_complete || file->nextents == 0) {
+        return 0;
+    }
+
+    /* Fragmented past FAT_MAX_EXTENTS: follow the FAT from the last extent */
+    const fat_extent_t *last = &file->extents[file->nextents - 1];
+    uint32_t c = last->cluster + last->count - 1;
+
+    for (uint32_t k = 0; k <= index && c != 0; k++) {
+        c = fat_next(c);
+    }
+
+    *run = 1;
+    return c;
+}
+
+/* Looks like a FAT32 boot sector (not an MBR) */
+static bool is_fat32_vbr(const uint8_t *b) {
+    return rd16(b + 11) == SECTOR_SIZE &&
+           b[13] != 0 && (b[13] & (b[13] - 1)) == 0 &&
+           rd16(b + 17) == 0 &&             /* No fixed root directory */
+           rd16(b + 22) == 0 &&             /* No 16-bit FAT size */
+           rd32(b + 36) != 0;
+}
+
+/*
+ * fat_mount - Find and mount the FAT32 volume
+ * Returns: true on success (needs emmc_init() first)
+ */
+bool fat_mount(void) {
+    uint8_t sector[SECTOR_SIZE];
+    uint32_t part_lba = 0;
+
+    mounted = false;
+    if (!emmc_ready()) {
+        return false;
+    }
+
+    bcache_init();
+
+    if (!bcache_read(0, 0, sector, SECTOR_SIZE) || rd16(sector + 510) != MBR_SIGNATURE) {
+        return false;
+    }
+
+    /* Partitioned card: take the first FAT32 partition */
+    if (!is_fat32_vbr(sector)) {
+        uint32_t p;
+
+        for (p = 0; p < MBR_PART_COUNT; p++) {
+            const uint8_t *entry = sector + MBR_PART_TABLE + p * 16;
+
+            if (entry[4] == PART_TYPE_FAT32_CHS || entry[4] == PART_TYPE_FAT32_LBA) {
+                part_lba = rd32(entry + 8);
+                break;
+            }
+        }
+
+        if (p == MBR_PART_COUNT ||
+            !bcache_read(part_lba, 0, sector, SECTOR_SIZE) || !is_fat32_vbr(sector)) {
+            return false;
+        }
+    }
+
+    uint32_t reserved = rd16(sector + 14);
+    uint32_t num_fats = sector[16];
+    uint32_t total = rd32(sector + 32);
+    uint32_t fat_size = rd32(sector + 36);
+
+    sectors_per_cluster = sector[13];
+    cluster_bytes = sectors_per_cluster * SECTOR_SIZE;
+    fat_start = part_lba + reserved;
+    data_start = fat_start + num_fats * fat_size;
+    cluster_count = (total - (data_start - part_lba)) / sectors_per_cluster;
+    root_cluster = rd32(sector + 44);
+
+    mounted = cluster_valid(root_cluster);
+    return mounted;
+}
+
+/*
+ * fat_mounted - True once fat_mount() has succeeded
+ */
+bool fat_mounted(void) {
+    return mounted;
+}
+
+/*
+ * fat_cluster_size - Bytes per cluster
+ */
+uint32_t fat_cluster_size(void) {
+    return cluster_bytes;
+}
+
+/*
+ * fat_volume_mb - Data area size in MB
+ */
+uint32_t fat_volume_mb(void) {
+    return (uint32_t)((uint64_t)cluster_count * cluster_bytes >> 20);
+}
+
+/*
+ * fat_read - Read from the current position
+ * @file: Open file
+ * @buf: Destination
+ * @len: Bytes wanted
+ * Returns: Bytes read (0 at end of file), -1 on error
+ */
+int32_t fat_read(fat_file_t *file, void *buf, uint32_t len) {
+    uint8_t *dst = buf;
+    uint32_t done = 0;
+
+    if (file->pos >= file->size) {
+        return 0;
+    }
+    if (len > file->size - file->pos) {
+        len = file->size - file->pos;
+    }
+
+    while (done < len) {
+        uint32_t remaining = len - done;
+        uint32_t offset = file->pos % cluster_bytes;
+        uint32_t run;
+        uint32_t c = file_cluster(file, file->pos / cluster_bytes, &run);
+
+        if (c == 0) {
+            return -1;
+        }
+
+        uint32_t lba = cluster_lba(c) + offset / SECTOR_SIZE;
+        uint32_t block_off = offset % SECTOR_SIZE;
+        uint32_t n;
+
+        if (block_off == 0 && remaining >= SECTOR_SIZE && ((uint64_t)dst & 3) == 0) {
+            /* Whole blocks: straight from the card, up to the end of the extent */
+            uint32_t blocks = run * sectors_per_cluster - offset / SECTOR_SIZE;
+
+            if (blocks > remaining / SECTOR_SIZE) {
+                blocks = remaining / SECTOR_SIZE;
+            }
+            if (!emmc_read(lba, blocks, dst)) {
+                return -1;
+            }
+            n = blocks * SECTOR_SIZE;
+        } else {
+            n = SECTOR_SIZE - block_off;
+            if (n > remaining) {
+                n = remaining;
+            }
+            if (!bcache_read(lba, block_off, dst, n)) {
+                return -1;
+            }
+        }
+
+        dst += n;
+        done += n;
+        file->pos += n;
+    }
+
+    return (int32_t)done;
+}
+
+/*
+ * fat_seek - Set the read position
+ * Returns: false if past the end of the file
+ */
+bool fat_seek(fat_file_t *file, uint32_t pos) {
+    if (pos > file->size) {
+        return false;
+    }
+    file->pos = pos;
+    return true;
+}
+
+/* Store one LFN entry's 13 UCS-2 characters (ASCII only, else '?') */
+static void lfn_collect(const uint8_t *e, char *lfn) {
+    static const uint8_t char_offsets[13] = { 1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30 };
+    uint32_t base = ((e[0] & 0x1F) - 1) * 13;
+
+    for (uint32_t k = 0; k < 13; k++) {
+        uint16_t ch = rd16(e + char_offsets[k]);
+
+        if (base + k >= FAT_NAME_MAX - 1) {
+            break;
+        }
+        if (ch == 0x0000 || ch == 0xFFFF) {
+            continue;
+        }
+        lfn[base + k] = ch < 0x80 ? (char)ch : '?';
+    }
+}
+
+/* Checksum of the 11-byte 8.3 name, stored in each of its LFN entries */
+static uint8_t short_name_sum(const uint8_t *e) {
+    uint8_t sum = 0;
+
+    for (uint32_t i = 0; i < 11; i++) {
+        sum = (uint8_t)(((sum & 1) << 7) + (sum >> 1) + e[i]);
+    }
+    return sum;
+}
+
+/* "NAME    EXT" -> "NAME.EXT", honouring the lowercase flags */
+static void short_name(const uint8_t *e, char *name) {
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < 8 && e[i] != ' '; i++) {
+        char ch = (i == 0 && e[0] == 0x05) ? (char)0xE5 : (char)e[i];
+        if ((e[12] & SFN_LOWER_BASE) && ch >= 'A' && ch <= 'Z') {
+            ch += 'a' - 'A';
+        }
+        name[n++] = ch;
+    }
+
+    if (e[8] != ' ') {
+        name[n++] = '.';
+        for (uint32_t i = 8; i < 11 && e[i] != ' '; i++) {
+            char ch = (char)e[i];
+            if ((e[12] & SFN_LOWER_EXT) && ch >= 'A' && ch <= 'Z') {
+                ch += 'a' - 'A';
+            }
+            name[n++] = ch;
+        }
+    }
+
+    name[n] = '\0';
+}
+
+/*
+ * fat_readdir - Next entry of an open directory
+ * @dir: Directory opened with fat_open()
+ * @entry: Filled with name (long name if present), 8.3 alias, size,
+ *         attributes
+ * Returns: false at the end of the directory
+ *
+ * A long name is only used if every LFN entry before the short entry
+ * carries its checksum; orphans left by tools that don't know LFNs are
+ * dropped and the 8.3 name is reported instead.
+ */
+bool fat_readdir(fat_file_t *dir, fat_dirent_t *entry) {
+    uint8_t e[DIRENT_SIZE];
+    char lfn[FAT_NAME_MAX];
+    uint8_t lfn_sum = 0;
+    bool have_lfn = false;
+
+    if (!dir->is_dir) {
+        return false;
+    }
+
+    while (fat_read(dir, e, DIRENT_SIZE) == DIRENT_SIZE) {
+        uint8_t attr = e[11];
+
+        if (e[0] == 0x00) {
+            dir->pos = dir->size;           /* End marker */
+            return false;
+        }
+        if (e[0] == 0xE5) {
+            have_lfn = false;               /* Deleted */
+            continue;
+        }
+        if ((attr & 0x3F) == FAT_ATTR_LFN) {
+            if (e[0] & 0x40) {              /* Last (first stored) part */
+                memset(lfn, 0, sizeof(lfn));
+                lfn_sum = e[13];
+                have_lfn = true;
+            } else if (e[13] != lfn_sum) {
+                have_lfn = false;
+            }
+            if (have_lfn) {
+                lfn_collect(e, lfn);
+            }
+            continue;
+        }
+        if (attr & FAT_ATTR_VOLUME_ID) {
+            have_lfn = false;
+            continue;
+        }
+
+        short_name(e, entry->alias);
+        if (have_lfn && short_name_sum(e) == lfn_sum) {
+            strcpy(entry->name, lfn);
+        } else {
+            strcpy(entry->name, entry->alias);
+        }
+        entry->attr = attr;
+        entry->size = rd32(e + 28);
+        entry->cluster = ((uint32_t)rd16(e + 20) << 16) | rd16(e + 26);
+        return true;
+    }
+
+    return false;
+}
+
+/* ASCII case-insensitive compare */
+static bool name_equal(const char *a, const char *b) {
+    while (*a && *b) {
+        char ca = (*a >= 'A' && *a <= 'Z') ? *a + ('a' - 'A') : *a;
+        char cb = (*b >= 'A' && *b <= 'Z') ? *b + ('a' - 'A') : *b;
+        if (ca != cb) {
+            return false;
+        }
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+/*
+ * fat_open - Open a file or directory by path
+ * @path: e.g. "/config.txt" or "assets/logo.qoi"; "/" is the root
+ * @file: Filled in on success
+ * Returns: false if not mounted or not found
+ */
+bool fat_open(const char *path, fat_file_t *file) {
+    char component[FAT_NAME_MAX];
+    fat_dirent_t entry;
+
+    if (!mounted) {
+        return false;
+    }
+
+    open_chain(file, root_cluster, 0, true);
+
+    while (*path) {
+        uint32_t len = 0;
+
+        while (*path == '/') {
+            path++;
+        }
+        if (*path == '\0') {
+            break;
+        }
+
+        while (*path && *path != '/') {
+            if (len == FAT_NAME_MAX - 1) {
+                return false;
+            }
+            component[len++] = *path++;
+        }
+        component[len] = '\0';
+
+        if (!file->is_dir) {
+            return false;
+        }
+
+        bool found = false;
+        while (fat_readdir(file, &entry)) {
+            if (name_equal(entry.name, component) || name_equal(entry.alias, component)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+
+        bool is_dir = (entry.attr & FAT_ATTR_DIRECTORY) != 0;
+        uint32_t cluster = entry.cluster;
+        if (is_dir && cluster == 0) {
+            cluster = root_cluster;         /* ".." of a top-level directory */
+        }
+        open_chain(file, cluster, entry.size, is_dir);
+    }
+
+    return true;
+}
@@ -0,0 +1,356 @@
+/*
+ * fiber.c - Cooperative Fibers
+ *
+ * Scheduling is a walk around the current core's ring starting after
+ * the running fiber; the first runnable fiber found is switched to.
+ * Finished fibers are unlinked and their stacks returned to the pool
+ * the next time the walk passes them (never while still on them).
+ *
+ * With nothing runnable the core waits in wfe instead of spinning.
+ * IRQs stay masked, so the wakeup comes from the generic timer's event
+ * stream, enabled per core on first use (CNTHCTL_EL2 at EL2, CNTKCTL_EL1
+ * at EL1; without either the core spins instead): when only sleepers are
+ * queued the core stays in wfe until the earliest wake_at (or an IPI
+ * arrives); a condition wait has no event of its own, so it is polled
+ * once per event, every FIBER_IDLE_POLL_US at most. sev from another
+ * core ends any wait early.
+ */
+
+#include "fiber.h"
+#include "smp.h"
+#include "sync.h"
+#include "timer.h"
+#include "cpustat.h"
+#include "ipi.h"
+
+/* Stack pool shared by all cores */
+static uint8_t __attribute__((aligned(16))) stack_pool[FIBER_MAX][FIBER_STACK_SIZE];
+static fiber_t pool[FIBER_MAX];
+static spinlock_t pool_lock = SPINLOCK_INIT;
+
+/* Per core: original context and currently running fiber */
+static fiber_t main_fibers[NUM_CORES];
+static fiber_t *current[NUM_CORES];
+
+/* Main fiber is parked in fiber_run: time spent in it is idle time */
+static bool main_idle[NUM_CORES];
+
+/* Event stream running on this core: wfe is bounded, else spin */
+static bool event_stream[NUM_CORES];
+
+static inline uint32_t current_el(void) {
+    uint64_t el;
+    asm volatile("mrs %0, CurrentEL" : "=r"(el));
+    return (el >> 2) & 3;
+}
+
+/*
+ * Event stream on this core: an event each time counter bit EVNTI goes
+ * 0 -> 1, i.e. every 2^(EVNTI+1) ticks, the largest such period that is
+ * not over FIBER_IDLE_POLL_US. Only the EVNT* fields are touched, in
+ * CNTHCTL_EL2 at EL2 or CNTKCTL_EL1 (same layout) at EL1. Anywhere else
+ * there is no event stream and idle_pause() spins.
+ */
+static void event_stream_init(uint32_t core) {
+    uint64_t period = timer_us_to_ticks(FIBER_IDLE_POLL_US);
+    uint64_t ctl;
+    uint32_t evnti = 0;
+    uint32_t el = current_el();
+
+    while (evnti < 15 && (2ull << (evnti + 1)) <= period) {
+        evnti++;
+    }
+
+    if (el == 2) {
+        asm volatile("mrs %0, cnthctl_el2" : "=r"(ctl));
+    } else if (el == 1) {
+        asm volatile("mrs %0, cntkctl_el1" : "=r"(ctl));
+    } else {
+        return;
+    }
+    ctl &= ~0xFCull;
+    ctl |= (1ull << 2) | ((uint64_t)evnti << 4);        /* EVNTEN, 0 -> 1 edges */
+    if (el == 2) {
+        asm volatile("msr cnthctl_el2, %0; isb" :: "r"(ctl));
+    } else {
+        asm volatile("msr cntkctl_el1, %0; isb" :: "r"(ctl));
+    }
+    event_stream[core] = true;
+}
+
+/* One idle step: wfe if the event stream bounds it, else a spin */
+static inline void idle_pause(uint32_t core) {
+    if (event_stream[core]) {
+        wfe();
+    } else {
+        cpu_relax();
+    }
+}
+
+/* Running fiber on this core, adopting the core's context on first use */
+static fiber_t *self(uint32_t core) {
+    if (current[core] == NULL) {
+        fiber_t *m = &main_fibers[core];
+        m->name = "main";
+        m->state = FIBER_READY;
+        m->core = core;
+        m->next = m;
+        current[core] = m;
+        event_stream_init(core);
+    }
+    return current[core];
+}
+
+static fiber_t *pool_alloc(void) {
+    fiber_t *f = NULL;
+
+    smp_lock(&pool_lock);
+    for (uint32_t i = 0; i < FIBER_MAX; i++) {
+        if (pool[i].state == FIBER_FREE) {
+            f = &pool[i];
+            f->stack = stack_pool[i];
+            f->state = FIBER_READY;
+            break;
+        }
+    }
+    smp_unlock(&pool_lock);
+
+    return f;
+}
+
+static void pool_free(fiber_t *f) {
+    smp_lock(&pool_lock);
+    f->state = FIBER_FREE;
+    smp_unlock(&pool_lock);
+}
+
+/* First code a new fiber runs (via lr in its initial context) */
+static void fiber_bootstrap(void) {
+    fiber_t *f = current[smp_core_id()];
+
+    f->fn(f->arg);
+    fiber_exit();
+}
+
+static bool fiber_runnable(fiber_t *f, uint64_t now) {
+    if (f->state != FIBER_READY) {
+        return false;
+    }
+    if (f->wake_at && now < f->wake_at) {
+        return false;
+    }
+    return f->wait_fn == NULL || f->wait_fn(f->wait_arg);
+}
+
+/*
+ * Wait in wfe while nothing but `cur` could run: returns at once if
+ * another fiber is runnable, after one event if any fiber waits on a
+ * condition, otherwise at the earliest wake_at or a pending IPI.
+ */
+static void idle_wait(fiber_t *cur) {
+    uint64_t now = timer_ticks();
+    uint64_t deadline = ~0ull;
+    bool polled = false;
+    fiber_t *f = cur;
+
+    do {
+        if (f != cur && fiber_runnable(f, now)) {
+            return;
+        }
+        if (f->state == FIBER_READY) {
+            if (f->wait_fn) {
+                polled = true;
+            } else if (f->wake_at && f->wake_at < deadline) {
+                deadline = f->wake_at;
+            }
+        }
+        f = f->next;
+    } while (f != cur);
+
+    if (polled) {
+        idle_pause(cur->core);
+        return;
+    }
+    while (timer_ticks() < deadline && !ipi_pending()) {
+        idle_pause(cur->core);
+    }
+}
+
+/* Switch to the next runnable fiber, or return if that is us */
+static void schedule(uint32_t core) {
+    fiber_t *cur = current[core];
+
+    while (1) {
+        uint64_t now = timer_ticks();
+        fiber_t *prev = cur;
+        fiber_t *f = cur->next;
+
+        while (f != cur) {
+            if (f->state == FIBER_DONE) {
+                prev->next = f->next;
+                pool_free(f);
+                f = prev->next;
+                continue;
+            }
+
+            if (fiber_runnable(f, now)) {
+                if (main_idle[core] && cur == &main_fibers[core]) {
+                    cpustat_idle_exit(core);
+                }
+                current[core] = f;
+                f->switches++;
+                fiber_switch(&cur->ctx, &f->ctx);
+                return;
+            }
+
+            prev = f;
+            f = f->next;
+        }
+
+        if (fiber_runnable(cur, now)) {
+            return;
+        }
+
+        /* Nothing runnable: sleep until a deadline, an event or a message */
+        idle_wait(cur);
+    }
+}
+
+/*
+ * fiber_create - Create a fiber on the calling core's run queue
+ * @name: Static name for diagnostics
+ * Returns: The fiber, or NULL if the pool is exhausted
+ *
+ * The new fiber is queued right after the caller, so it runs at the
+ * caller's next yield.
+ */
+fiber_t *fiber_create(const char *name, fiber_fn_t fn, void *arg) {
+    uint32_t core = smp_core_id();
+    fiber_t *cur = self(core);
+    fiber_t *f = pool_alloc();
+
+    if (f == NULL) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < sizeof(fiber_context_t) / 8; i++) {
+        ((uint64_t *)&f->ctx)[i] = 0;
+    }
+    f->ctx.sp = (uint64_t)(f->stack + FIBER_STACK_SIZE);
+    f->ctx.lr = (uint64_t)fiber_bootstrap;
+
+    f->name = name;
+    f->fn = fn;
+    f->arg = arg;
+    f->wait_fn = NULL;
+    f->wait_arg = NULL;
+    f->wake_at = 0;
+    f->switches = 0;
+    f->core = core;
+
+    f->next = cur->next;
+    cur->next = f;
+
+    return f;
+}
+
+/*
+ * fiber_yield - Let other runnable fibers on this core run
+ */
+void fiber_yield(void) {
+    uint32_t core = smp_core_id();
+    self(core);
+    schedule(core);
+}
+
+/*
+ * fiber_wait_until - Yield until cond(arg) returns true
+ *
+ * The condition is evaluated by the scheduler, so a waiting fiber costs
+ * a function call per scheduling pass, not a context switch.
+ */
+void fiber_wait_until(fiber_cond_t cond, void *arg) {
+    uint32_t core = smp_core_id();
+    fiber_t *cur = self(core);
+
+    cur->wait_fn = cond;
+    cur->wait_arg = arg;
+    schedule(core);
+    cur->wait_fn = NULL;
+}
+
+/*
+ * fiber_sleep_us - Yield for at least `us` microseconds
+ */
+void fiber_sleep_us(uint64_t us) {
+    uint32_t core = smp_core_id();
+    fiber_t *cur = self(core);
+
+    cur->wake_at = timer_ticks() + timer_us_to_ticks(us);
+    schedule(core);
+    cur->wake_at = 0;
+}
+
+/*
+ * fiber_exit - Finish the calling fiber (not valid for a main fiber)
+ */
+void fiber_exit(void) {
+    uint32_t core = smp_core_id();
+    fiber_t *cur = self(core);
+
+    if (cur == &main_fibers[core]) {
+        return;
+    }
+
+    cur->state = FIBER_DONE;
+    schedule(core);
+
+    /* Not reached: a DONE fiber is never switched back to */
+    while (1) {
+        wfe();
+    }
+}
+
+/*
+ * fiber_run - Hand the calling context over to the fibers, forever
+ */
+void fiber_run(void) {
+    uint32_t core = smp_core_id();
+
+    main_idle[core] = true;
+    while (1) {
+        cpustat_idle_enter(core);
+        ipi_poll();
+        idle_wait(self(core));
+        fiber_yield();
+    }
+}
+
+/*
+ * fiber_self - Fiber running on this core
+ */
+fiber_t *fiber_self(void) {
+    return self(smp_core_id());
+}
+
+/*
+ * fiber_count - Fibers queued on a core, including its main fiber
+ */
+uint32_t fiber_count(uint32_t core) {
+    fiber_t *start = current[core];
+    uint32_t count = 0;
+
+    if (start == NULL) {
+        return 0;
+    }
+
+    fiber_t *f = start;
+    do {
+        if (f->state == FIBER_READY) {
+            count++;
+        }
+        f = f->next;
+    } while (f != start);
+
+    return count;
+}
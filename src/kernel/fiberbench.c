@@ -0,0 +1,114 @@
+/*
+ * fiberbench.c - Fiber Switch Cost
+ *
+ * Runs on core 1 where the run queue is otherwise empty (core 0 if it
+ * is the only core), measuring in PMU cycles:
+ *   - raw fiber_switch() between two contexts
+ *   - fiber_yield() ping-pong between two fibers through the scheduler
+ */
+
+#include "bench.h"
+#include "fiber.h"
+#include "pmu.h"
+#include "smp.h"
+#include "timer.h"
+#include "kprintf.h"
+
+#define SWITCH_ROUNDS   10000
+
+typedef struct {
+    uint64_t raw_cycles;
+    uint64_t raw_ticks;
+    uint64_t yield_cycles;
+    uint64_t yield_ticks;
+    uint64_t yield_switches;
+} fiberbench_result_t;
+
+static fiber_context_t main_ctx;
+static fiber_context_t pong_ctx;
+static uint8_t __attribute__((aligned(16))) pong_stack[2048];
+
+static volatile uint32_t pingers_done;
+
+/* Switches straight back, forever */
+static void raw_pong(void) {
+    while (1) {
+        fiber_switch(&pong_ctx, &main_ctx);
+    }
+}
+
+static void pinger(void *arg) {
+    for (uint32_t i = 0; i < SWITCH_ROUNDS; i++) {
+        fiber_yield();
+    }
+    pingers_done++;
+}
+
+static bool both_done(void *arg) {
+    return pingers_done == 2;
+}
+
+static void fiberbench_core(void *arg) {
+    fiberbench_result_t *r = arg;
+    uint64_t c0, t0;
+
+    pmu_init();
+
+    /* Raw context switch: 2 switches per round */
+    pong_ctx.sp = (uint64_t)(pong_stack + sizeof(pong_stack));
+    pong_ctx.lr = (uint64_t)raw_pong;
+    t0 = timer_ticks();
+    c0 = pmu_cycles();
+    for (uint32_t i = 0; i < SWITCH_ROUNDS; i++) {
+        fiber_switch(&main_ctx, &pong_ctx);
+    }
+    r->raw_cycles = pmu_cycles() - c0;
+    r->raw_ticks = timer_ticks() - t0;
+
+    /* Scheduler round trip: two fibers yielding to each other */
+    pingers_done = 0;
+    fiber_t *a = fiber_create("ping", pinger, NULL);
+    fiber_t *b = fiber_create("pong", pinger, NULL);
+    if (a == NULL || b == NULL) {
+        r->yield_switches = 0;
+        return;
+    }
+
+    t0 = timer_ticks();
+    c0 = pmu_cycles();
+    fiber_wait_until(both_done, NULL);
+    r->yield_cycles = pmu_cycles() - c0;
+    r->yield_ticks = timer_ticks() - t0;
+    r->yield_switches = a->switches + b->switches;
+}
+
+static void report_cycles(const char *name, uint64_t cycles, uint64_t switches) {
+    char text[48];
+
+    kformat(text, sizeof(text), "%lu cycles/switch", switches ? cycles / switches : 0);
+    bench_note(name, text);
+}
+
+/*
+ * fiberbench_run - Measure fiber switch cost
+ */
+void fiberbench_run(void) {
+    static fiberbench_result_t r;
+
+    bench_header("fibers");
+
+    if (!smp_run(1, fiberbench_core, &r)) {
+        fiberbench_core(&r);
+    }
+    smp_wait(1);
+
+    bench_result("fiber_switch (raw)", 1, SWITCH_ROUNDS * 2, r.raw_ticks);
+    report_cycles("", r.raw_cycles, SWITCH_ROUNDS * 2);
+
+    if (r.yield_switches == 0) {
+        bench_note("fiber_yield", "FAIL: fiber pool exhausted");
+        return;
+    }
+    bench_result("fiber_yield ping-pong", 1, r.yield_switches, r.yield_ticks);
+    report_cycles("", r.yield_cycles, r.yield_switches);
+}
@@ -0,0 +1,130 @@
+/*
+ * fmtbench.c - Formatting Throughput
+ *
+ * Builds the lines kernel_main puts on screen two ways: the old chain
+ * (runtime-base utoa, one divide per digit, then strcat rescanning the
+ * buffer for every piece) and a single kformat call. Both run on core 0
+ * with the same inputs; the chain helpers are local copies so the
+ * library utoa, which now uses kfmt_dec, does not flatter them.
+ */
+
+#include "bench.h"
+#include "kprintf.h"
+#include "timer.h"
+#include "string.h"
+
+#define FMT_ROUNDS      20000
+
+static const char chain_digits[] = "0123456789ABCDEF";
+
+/* utoa as it was: runtime base, divide and modulo per digit */
+static void chain_utoa(uint32_t value, char *buffer, uint32_t base) {
+    char tmp[33];
+    char *p = tmp;
+
+    do {
+        *p++ = chain_digits[value % base];
+        value /= base;
+    } while (value);
+
+    while (p > tmp) {
+        *buffer++ = *--p;
+    }
+    *buffer = '\0';
+}
+
+/* Inputs read through volatiles so neither side is constant-folded */
+static volatile uint32_t in_width = 1920, in_height = 1080, in_depth = 32;
+static volatile uint32_t in_mem_size = 948 * 1024 * 1024, in_mem_base = 0;
+static volatile uint32_t in_temp = 48312, in_min = 45120, in_max = 51004, in_avg = 47777;
+
+static void chain_resolution(char *buffer) {
+    char tmp[16];
+
+    chain_utoa(in_width, buffer, 10);
+    strcat(buffer, " x ");
+    chain_utoa(in_height, tmp, 10);
+    strcat(buffer, tmp);
+    strcat(buffer, " @ ");
+    chain_utoa(in_depth, tmp, 10);
+    strcat(buffer, tmp);
+    strcat(buffer, "bpp");
+}
+
+static void chain_memory(char *buffer) {
+    char tmp[16];
+    uint32_t base = in_mem_base;
+
+    chain_utoa(in_mem_size / (1024 * 1024), buffer, 10);
+    strcat(buffer, " MB @ 0x");
+    for (int i = 7; i >= 0; i--) {
+        tmp[i] = chain_digits[base & 0xF];
+        base >>= 4;
+    }
+    tmp[8] = '\0';
+    strcat(buffer, tmp);
+}
+
+static void chain_temp(uint32_t mc, char *buffer) {
+    char tmp[4] = { '.', '0' + mc % 1000 / 100, '\0' };
+
+    chain_utoa(mc / 1000, buffer, 10);
+    strcat(buffer, tmp);
+}
+
+static void chain_range(char *buffer) {
+    char tmp[16];
+
+    chain_temp(in_temp, buffer);
+    strcat(buffer, " C (");
+    chain_temp(in_min, tmp);
+    strcat(buffer, tmp);
+    strcat(buffer, "-");
+    chain_temp(in_max, tmp);
+    strcat(buffer, tmp);
+    strcat(buffer, " avg ");
+    chain_temp(in_avg, tmp);
+    strcat(buffer, tmp);
+    strcat(buffer, ")");
+}
+
+static void kformat_lines(char *res, char *mem, char *range, size_t size) {
+    uint32_t t = in_temp, lo = in_min, hi = in_max, avg = in_avg;
+
+    kformat(res, size, "%u x %u @ %ubpp", in_width, in_height, in_depth);
+    kformat(mem, size, "%u MB @ 0x%08X", in_mem_size / (1024 * 1024), in_mem_base);
+    kformat(range, size, "%u.%u C (%u.%u-%u.%u avg %u.%u)",
+            t / 1000, t % 1000 / 100, lo / 1000, lo % 1000 / 100,
+            hi / 1000, hi % 1000 / 100, avg / 1000, avg % 1000 / 100);
+}
+
+/*
+ * fmtbench_run - Compare strcat chains with kformat
+ */
+void fmtbench_run(void) {
+    char res[64], mem[64], range[64];
+    char res2[64], mem2[64], range2[64];
+    uint64_t t0, ticks;
+
+    bench_header("format");
+
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < FMT_ROUNDS; i++) {
+        chain_resolution(res);
+        chain_memory(mem);
+        chain_range(range);
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("utoa/strcat (3 lines)", 1, FMT_ROUNDS, ticks);
+
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < FMT_ROUNDS; i++) {
+        kformat_lines(res2, mem2, range2, sizeof(res2));
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("kformat (3 lines)", 1, FMT_ROUNDS, ticks);
+
+    bool same = strcmp(res, res2) == 0 && strcmp(mem, mem2) == 0 && strcmp(range, range2) == 0;
+    bench_note("", same ? "outputs match" : "OUTPUT MISMATCH");
+    bench_note("", range2);
+}
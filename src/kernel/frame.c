@@ -0,0 +1,280 @@
+/*
+ * frame.c - Vsync-paced Frame Scheduler
+ *
+ * Frames follow a grid of period ticks. With vsync the grid is
+ * re-anchored to each vsync as the tag returns; with the timer a late
+ * frame drops the grid points it has already passed rather than
+ * bunching frames up to catch up. Either way the interval between
+ * frame starts is what the histogram and the missed count measure.
+ *
+ * Render costs are tracked per client as a moving average (1/4 new
+ * sample) in timer ticks, which is all the skip decision needs.
+ */
+
+#include "frame.h"
+#include "mailbox.h"
+#include "fiber.h"
+#include "timer.h"
+#include "kprintf.h"
+#include "trace.h"
+
+/* Probe: a measured vsync period outside this range means no real vsync */
+#define VSYNC_MIN_US    5000
+#define VSYNC_MAX_US    50000
+
+#define HIST_BAR_MAX    40
+
+typedef struct {
+    const char *name;
+    frame_update_fn update;
+    frame_render_fn render;
+    void *arg;
+    uint64_t last_update;       /* Ticks */
+    uint64_t est_ticks;         /* Render cost, moving average */
+    uint32_t skips;             /* In a row */
+    uint64_t skipped;
+} frame_client_t;
+
+static frame_client_t clients[FRAME_MAX_CLIENTS];
+static uint32_t num_clients;
+
+static bool use_vsync;
+static uint64_t period_ticks;
+static uint64_t budget_ticks;
+static uint64_t next_frame;
+static frame_stats_t stats;
+
+static bool wait_vsync(void) {
+    uint32_t value = 0;
+    return mailbox_property(TAG_FB_WAIT_VSYNC, &value, 1);
+}
+
+/*
+ * frame_init - Pick vsync or timer pacing and reset the statistics
+ * @hz: Timer-paced rate when the firmware has no vsync tag
+ *
+ * Probing waits for two vsyncs to measure the real refresh period.
+ */
+void frame_init(uint32_t hz) {
+    uint64_t period_us = 1000000 / (hz ? hz : FRAME_HZ);
+
+    use_vsync = false;
+    if (wait_vsync()) {
+        uint64_t t0 = timer_ticks();
+        if (wait_vsync()) {
+            uint64_t us = timer_ticks_to_us(timer_ticks() - t0);
+            if (us >= VSYNC_MIN_US && us <= VSYNC_MAX_US) {
+                use_vsync = true;
+                period_us = us;
+            }
+        }
+    }
+
+    period_ticks = timer_us_to_ticks(period_us);
+    budget_ticks = period_ticks * FRAME_BUDGET_PCT / 100;
+    next_frame = timer_ticks() + period_ticks;
+    stats = (frame_stats_t){ 0 };
+
+    kprintf("Frames: %lu.%lu Hz, %s\n", 10000000 / period_us / 10, 10000000 / period_us % 10,
+            use_vsync ? "vsync" : "timer");
+}
+
+/*
+ * frame_register - Add a client to every frame, in registration order
+ * @name: For the report
+ * @update: Called every frame (may be NULL)
+ * @render: Called while the budget allows (may be NULL)
+ * Returns: false if FRAME_MAX_CLIENTS are registered
+ */
+bool frame_register(const char *name, frame_update_fn update, frame_render_fn render, void *arg) {
+    if (num_clients >= FRAME_MAX_CLIENTS) {
+        return false;
+    }
+
+    clients[num_clients++] = (frame_client_t){
+        .name = name,
+        .update = update,
+        .render = render,
+        .arg = arg,
+        .last_update = timer_ticks(),
+    };
+    return true;
+}
+
+/*
+ * frame_vsync - Whether frames are paced by the firmware vsync
+ */
+bool frame_vsync(void) {
+    return use_vsync;
+}
+
+/*
+ * frame_period_us - Frame period (measured with vsync)
+ */
+uint32_t frame_period_us(void) {
+    return (uint32_t)timer_ticks_to_us(period_ticks);
+}
+
+/*
+ * frame_get_stats - Counters and histogram since frame_init
+ */
+const frame_stats_t *frame_get_stats(void) {
+    return &stats;
+}
+
+/* Sleep until the next grid point (less the vsync lead), then sync */
+static uint64_t wait_frame(void) {
+    uint64_t now = timer_ticks();
+
+    /* Late: skip the grid points already passed */
+    if (now >= next_frame) {
+        next_frame += ((now - next_frame) / period_ticks + 1) * period_ticks;
+    }
+
+    uint64_t wake = next_frame;
+    if (use_vsync) {
+        wake -= timer_us_to_ticks(FRAME_VSYNC_LEAD_US);
+    }
+    if (wake > now) {
+        fiber_sleep_us(timer_ticks_to_us(wake - now));
+    }
+
+    if (use_vsync) {
+        if (!wait_vsync()) {
+            use_vsync = false;      /* Tag stopped working: stay on the timer */
+        }
+        now = timer_ticks();
+        next_frame = now + period_ticks;
+        return now;
+    }
+
+    /* Timer: the sleep rounds down to whole microseconds, spin off the rest */
+    while (timer_ticks() < next_frame) {
+        asm volatile("nop");
+    }
+    next_frame += period_ticks;
+
+    /* Actual start, not the grid point: a late wake must show in the interval */
+    return timer_ticks();
+}
+
+/* Interval histogram and missed refreshes */
+static void record_interval(uint64_t interval) {
+    uint64_t us = timer_ticks_to_us(interval);
+    uint32_t bucket = us / 1000;
+
+    if (bucket >= FRAME_HIST_BUCKETS) {
+        bucket = FRAME_HIST_BUCKETS - 1;
+    }
+    stats.hist[bucket]++;
+
+    /* Each whole period beyond the first (rounded) is a missed refresh */
+    uint64_t periods = (interval + period_ticks / 2) / period_ticks;
+    if (periods > 1) {
+        stats.missed += periods - 1;
+    }
+}
+
+/* One frame: all updates, then renders that fit the budget */
+static void run_frame(uint64_t start) {
+    for (uint32_t i = 0; i < num_clients; i++) {
+        frame_client_t *c = &clients[i];
+        uint64_t now = timer_ticks();
+
+        if (c->update) {
+            c->update(timer_ticks_to_us(now - c->last_update), c->arg);
+        }
+        c->last_update = now;
+    }
+
+    for (uint32_t i = 0; i < num_clients; i++) {
+        frame_client_t *c = &clients[i];
+        uint64_t t0 = timer_ticks();
+
+        if (!c->render) {
+            continue;
+        }
+        if (t0 - start + c->est_ticks > budget_ticks && c->skips < FRAME_MAX_SKIPS) {
+            c->skips++;
+            c->skipped++;
+            stats.skipped++;
+            continue;
+        }
+
+        trace_begin("frame_render");
+        c->render(c->arg);
+        trace_end("frame_render");
+        uint64_t cost = timer_ticks() - t0;
+        c->est_ticks = c->est_ticks ? (3 * c->est_ticks + cost) / 4 : cost;
+        c->skips = 0;
+    }
+
+    uint64_t work = timer_ticks() - start;
+    stats.total_work_ticks += work;
+    if (work > stats.max_work_ticks) {
+        stats.max_work_ticks = work;
+    }
+    if (work > budget_ticks) {
+        stats.overruns++;
+    }
+    stats.frames++;
+}
+
+/*
+ * frame_fiber - The frame loop (create once, after frame_init)
+ */
+void frame_fiber(void *arg) {
+    uint64_t prev = 0;
+
+    while (1) {
+        uint64_t start = wait_frame();
+        if (prev) {
+            record_interval(start - prev);
+        }
+        prev = start;
+        run_frame(start);
+    }
+}
+
+/*
+ * frame_report - Print pacing, budget use and the interval histogram
+ */
+void frame_report(void) {
+    uint32_t peak = 1, last = 0;
+
+    for (uint32_t i = 0; i < FRAME_HIST_BUCKETS; i++) {
+        if (stats.hist[i] > peak) {
+            peak = stats.hist[i];
+        }
+        if (stats.hist[i]) {
+            last = i;
+        }
+    }
+
+    kprintf("\n=== Frames (%s, period %u us, budget %lu us) ===\n",
+            use_vsync ? "vsync" : "timer", frame_period_us(), timer_ticks_to_us(budget_ticks));
+    kprintf("Frames %lu, missed refreshes %lu, overruns %lu, renders skipped %lu\n",
+            stats.frames, stats.missed, stats.overruns, stats.skipped);
+    if (stats.frames) {
+        kprintf("Work: avg %lu us, max %lu us\n",
+                timer_ticks_to_us(stats.total_work_ticks / stats.frames),
+                timer_ticks_to_us(stats.max_work_ticks));
+    }
+
+    for (uint32_t i = 0; i <= last; i++) {
+        char bar[HIST_BAR_MAX + 1];
+        uint32_t len = (uint64_t)stats.hist[i] * HIST_BAR_MAX / peak;
+
+        for (uint32_t j = 0; j < len; j++) {
+            bar[j] = '#';
+        }
+        bar[len] = '\0';
+        kprintf("  %2u%s ms %8u %s\n", i, i == FRAME_HIST_BUCKETS - 1 ? "+" : " ",
+                stats.hist[i], bar);
+    }
+
+    for (uint32_t i = 0; i < num_clients; i++) {
+        kprintf("  %-12s render ~%lu us, skipped %lu\n", clients[i].name,
+                timer_ticks_to_us(clients[i].est_ticks), clients[i].skipped);
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ * fsbench.c - SD Card and Filesystem Benchmarks
+ *
+ * Raw EMMC reads one block per command vs one multi-block command,
+ * then FAT32 file reads: large chunks (direct multi-block path) and
+ * small chunks (through the block cache with readahead).
+ */
+
+#include "bench.h"
+#include "emmc.h"
+#include "bcache.h"
+#include "fat32.h"
+#include "timer.h"
+#include "kprintf.h"
+
+#define RAW_BLOCKS      256             /* 128 KB */
+#define BIG_CHUNK       (RAW_BLOCKS * EMMC_BLOCK_SIZE)
+#define SMALL_CHUNK     64
+
+/* File streamed by the FAT32 tests (setup_sdcard.sh puts it there) */
+#define BENCH_FILE      "/kernel8.img"
+
+static uint8_t __attribute__((aligned(16))) buf[BIG_CHUNK];
+
+/* Throughput line: KB/s for `bytes` in `ticks` */
+static void report_rate(const char *name, uint64_t bytes, uint64_t ticks) {
+    char text[48];
+
+    kformat(text, sizeof(text), "%lu KB/s", ticks ? bytes * timer_freq() / ticks / 1024 : 0);
+    bench_note(name, text);
+}
+
+/* Read the whole file in `chunk`-byte pieces; returns bytes or 0 on error */
+static uint32_t read_file(uint32_t chunk, uint64_t *ticks) {
+    fat_file_t file;
+    uint32_t total = 0;
+    int32_t n;
+
+    if (!fat_open(BENCH_FILE, &file)) {
+        return 0;
+    }
+
+    uint64_t t0 = timer_ticks();
+    while ((n = fat_read(&file, buf, chunk)) > 0) {
+        total += n;
+    }
+    *ticks = timer_ticks() - t0;
+
+    return n < 0 ? 0 : total;
+}
+
+/*
+ * fsbench_run - SD/FAT32 read benchmarks (skipped without a card)
+ */
+void fsbench_run(void) {
+    uint64_t t0, ticks;
+    char text[64];
+
+    bench_header("sd card");
+
+    if (!emmc_ready()) {
+        bench_note("emmc", "skipped: no card");
+        return;
+    }
+
+    /* Same 128 KB, one command per block vs one CMD18 */
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < RAW_BLOCKS; i++) {
+        if (!emmc_read(i, 1, buf + i * EMMC_BLOCK_SIZE)) {
+            bench_note("emmc_read x1", "FAIL: read error");
+            return;
+        }
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("emmc_read x1 (blocks)", 1, RAW_BLOCKS, ticks);
+    report_rate("", BIG_CHUNK, ticks);
+
+    t0 = timer_ticks();
+    if (!emmc_read(0, RAW_BLOCKS, buf)) {
+        bench_note("emmc_read x256", "FAIL: read error");
+        return;
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("emmc_read x256 (blocks)", 1, RAW_BLOCKS, ticks);
+    report_rate("", BIG_CHUNK, ticks);
+
+    if (!fat_mounted()) {
+        bench_note("fat32", "skipped: no FAT32 volume");
+        return;
+    }
+
+    uint32_t bytes = read_file(BIG_CHUNK, &ticks);
+    if (bytes == 0) {
+        bench_note("fat_read " BENCH_FILE, "FAIL: open/read error");
+        return;
+    }
+    report_rate("fat_read 128K chunks", bytes, ticks);
+
+    bcache_stats_t before, after;
+    bcache_get_stats(&before);
+    bytes = read_file(SMALL_CHUNK, &ticks);
+    bcache_get_stats(&after);
+    report_rate("fat_read 64B chunks", bytes, ticks);
+
+    uint32_t hits = after.hits - before.hits;
+    uint32_t misses = after.misses - before.misses;
+    kformat(text, sizeof(text), "%u%% hits, %u readaheads",
+            hits + misses ? hits * 100 / (hits + misses) : 0,
+            after.readaheads - before.readaheads);
+    bench_note("  block cache", text);
+}
@@ -0,0 +1,104 @@
+/*
+ * gfxbench.c - 2D Primitive Throughput
+ *
+ * Draws into an off-screen 256x256 surface on core 0, so the screen is
+ * left alone. The fill pair compares the old per-pixel byte stores
+ * (what fb_fill_rect used to do) with span fills; the rest report
+ * primitives per second for gauge/graph-sized shapes.
+ */
+
+#include "bench.h"
+#include "gfx.h"
+#include "timer.h"
+
+#define SURFACE_SIZE    256
+#define FILL_ROUNDS     200
+#define SHAPE_ROUNDS    5000
+
+static uint32_t surface_pixels[SURFACE_SIZE * SURFACE_SIZE] __attribute__((aligned(64)));
+
+/* Per-pixel byte stores, as fb_put_pixel() */
+static void put_pixel_bytes(const gfx_surface_t *s, uint32_t x, uint32_t y, color_t c) {
+    volatile uint8_t *p = (uint8_t *)(s->pixels + y * s->stride + x);
+    p[0] = c.b;
+    p[1] = c.g;
+    p[2] = c.r;
+    p[3] = c.a;
+}
+
+/* Pseudo-random coordinate on the surface (and a little beyond) */
+static int32_t next_coord(uint32_t *seed) {
+    *seed = *seed * 1664525 + 1013904223;
+    return (int32_t)(*seed >> 23) - 128 + SURFACE_SIZE / 4;
+}
+
+/*
+ * gfxbench_run - Measure span fills and primitive rates
+ */
+void gfxbench_run(void) {
+    gfx_surface_t s = { surface_pixels, SURFACE_SIZE, 0, 0, SURFACE_SIZE, SURFACE_SIZE };
+    const uint64_t pixels = (uint64_t)FILL_ROUNDS * SURFACE_SIZE * SURFACE_SIZE;
+    uint32_t seed = 1;
+    uint64_t t0, ticks;
+
+    bench_header("gfx");
+
+    /* ops = pixels, so Mops/s reads as Mpixel/s */
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < FILL_ROUNDS; i++) {
+        for (uint32_t y = 0; y < SURFACE_SIZE; y++) {
+            for (uint32_t x = 0; x < SURFACE_SIZE; x++) {
+                put_pixel_bytes(&s, x, y, COLOR_BLUE);
+            }
+        }
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("per-pixel fill (px)", 1, pixels, ticks);
+
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < FILL_ROUNDS; i++) {
+        gfx_fill_rect(&s, 0, 0, SURFACE_SIZE, SURFACE_SIZE, COLOR_BLUE);
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("span fill (px)", 1, pixels, ticks);
+
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < SHAPE_ROUNDS; i++) {
+        gfx_line(&s, next_coord(&seed), next_coord(&seed), next_coord(&seed),
+                 next_coord(&seed), COLOR_GREEN);
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("line (random)", 1, SHAPE_ROUNDS, ticks);
+
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < SHAPE_ROUNDS; i++) {
+        gfx_circle(&s, 128, 128, 100, COLOR_WHITE);
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("circle r=100", 1, SHAPE_ROUNDS, ticks);
+
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < SHAPE_ROUNDS; i++) {
+        gfx_fill_circle(&s, 128, 128, 100, COLOR_RED);
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("fill circle r=100", 1, SHAPE_ROUNDS, ticks);
+
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < SHAPE_ROUNDS; i++) {
+        gfx_fill_round_rect(&s, 16, 64, 224, 128, 16, COLOR_YELLOW);
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("fill round rect", 1, SHAPE_ROUNDS, ticks);
+
+    /* Five-pointed star: concave, even-odd leaves the centre open */
+    static const gfx_point_t star[] = {
+        { 128, 8 }, { 198, 240 }, { 12, 96 }, { 244, 96 }, { 58, 240 }
+    };
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < SHAPE_ROUNDS; i++) {
+        gfx_fill_polygon(&s, star, 5, COLOR_CYAN);
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("fill polygon (star)", 1, SHAPE_ROUNDS, ticks);
+}
@@ -0,0 +1,184 @@
+/*
+ * governor.c - ARM Clock Governor
+ *
+ * All decisions funnel into governor_apply(), which only issues a
+ * SET_CLOCK_RATE mailbox call when the target actually changes.
+ */
+
+#include "governor.h"
+#include "mailbox.h"
+#include "string.h"
+
+static governor_t gov;
+
+/*
+ * Query a clock limit (TAG_GET_MIN_CLOCK / TAG_GET_MAX_CLOCK)
+ */
+static uint32_t query_clock(uint32_t tag) {
+    uint32_t values[2] = { CLOCK_ID_ARM, 0 };
+
+    if (!mailbox_property(tag, values, 2)) {
+        return 0;
+    }
+
+    return values[1];
+}
+
+/*
+ * Set ARM clock, returns rate reported by firmware (0 on failure)
+ */
+static uint32_t set_arm_clock(uint32_t rate) {
+    /* clock id, rate, skip setting turbo (0 = let firmware set turbo) */
+    uint32_t values[3] = { CLOCK_ID_ARM, rate, 0 };
+
+    if (!mailbox_property(TAG_SET_CLOCK_RATE, values, 3)) {
+        return 0;
+    }
+
+    return values[1];
+}
+
+/* Rate the current policy wants before the thermal cap */
+static uint32_t policy_target(void) {
+    switch (gov.policy) {
+        case GOV_PERFORMANCE: return gov.max_rate;
+        case GOV_POWERSAVE:   return gov.min_rate;
+        case GOV_ONDEMAND:
+        default:              return gov.busy ? gov.max_rate : gov.min_rate;
+    }
+}
+
+/* Move the clock to the policy target, clamped to the thermal cap */
+static void governor_apply(void) {
+    uint32_t target = policy_target();
+
+    if (target > gov.cap) {
+        target = gov.cap;
+    }
+
+    if (target == gov.rate) {
+        return;
+    }
+
+    uint32_t actual = set_arm_clock(target);
+    gov.transitions++;
+
+    /* Firmware may round or refuse; keep what it reports */
+    gov.rate = actual ? actual : target;
+}
+
+/*
+ * governor_init - Read clock limits and apply initial policy
+ * @policy: Starting policy
+ * Returns: false if the firmware did not report clock limits
+ */
+bool governor_init(gov_policy_t policy) {
+    gov.policy = policy;
+    gov.min_rate = query_clock(TAG_GET_MIN_CLOCK);
+    gov.max_rate = query_clock(TAG_GET_MAX_CLOCK);
+    gov.rate = 0;
+    gov.transitions = 0;
+
+    /* Boot counts as busy so ondemand starts at full speed */
+    gov.busy = true;
+
+    if (gov.max_rate == 0) {
+        return false;
+    }
+    if (gov.min_rate == 0 || gov.min_rate > gov.max_rate) {
+        gov.min_rate = gov.max_rate;
+    }
+
+    gov.cap = gov.max_rate;
+    governor_apply();
+
+    return true;
+}
+
+/*
+ * governor_set_policy - Switch policy and apply immediately
+ */
+void governor_set_policy(gov_policy_t policy) {
+    gov.policy = policy;
+    if (gov.max_rate) {
+        governor_apply();
+    }
+}
+
+/*
+ * governor_busy / governor_idle - Load hints from the kernel
+ */
+void governor_busy(void) {
+    gov.busy = true;
+    if (gov.max_rate) {
+        governor_apply();
+    }
+}
+
+void governor_idle(void) {
+    gov.busy = false;
+    if (gov.max_rate) {
+        governor_apply();
+    }
+}
+
+/*
+ * governor_thermal - Adjust thermal cap from a temperature reading
+ * @temp_mc: SoC temperature in millidegrees C
+ *
+ * Steps down by GOV_THERMAL_STEP per call above GOV_TEMP_HOT and back
+ * up per call below GOV_TEMP_COOL; in between the cap holds steady.
+ */
+void governor_thermal(uint32_t temp_mc) {
+    if (gov.max_rate == 0) {
+        return;
+    }
+
+    if (temp_mc >= GOV_TEMP_HOT) {
+        if (gov.cap > gov.min_rate + GOV_THERMAL_STEP) {
+            gov.cap -= GOV_THERMAL_STEP;
+        } else {
+            gov.cap = gov.min_rate;
+        }
+    } else if (temp_mc <= GOV_TEMP_COOL && gov.cap < gov.max_rate) {
+        if (gov.cap + GOV_THERMAL_STEP < gov.max_rate) {
+            gov.cap += GOV_THERMAL_STEP;
+        } else {
+            gov.cap = gov.max_rate;
+        }
+    }
+
+    governor_apply();
+}
+
+/*
+ * governor_get - Current governor state
+ */
+const governor_t *governor_get(void) {
+    return &gov;
+}
+
+/*
+ * governor_policy_name - Printable policy name
+ */
+const char *governor_policy_name(gov_policy_t policy) {
+    switch (policy) {
+        case GOV_PERFORMANCE: return "performance";
+        case GOV_POWERSAVE:   return "powersave";
+        case GOV_ONDEMAND:    return "ondemand";
+        default:              return "unknown";
+    }
+}
+
+/*
+ * governor_parse_policy - Policy from name, ondemand if unrecognised
+ */
+gov_policy_t governor_parse_policy(const char *name) {
+    if (strcmp(name, "performance") == 0) {
+        return GOV_PERFORMANCE;
+    }
+    if (strcmp(name, "powersave") == 0) {
+        return GOV_POWERSAVE;
+    }
+    return GOV_ONDEMAND;
+}
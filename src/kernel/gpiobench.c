@@ -0,0 +1,103 @@
+/*
+ * gpiobench.c - GPIO Toggle Rate
+ *
+ * Runs on core 0 and toggles GPIO_BENCH_MASK (default: the ACT LED, so
+ * nothing external is driven), reporting edges per second for:
+ *   - GPSET/GPCLR stores, one per edge for the whole mask
+ *   - gpio_write_mask() with a changing value
+ *   - read-modify-write toggling through GPLEV
+ *   - GPLEV bank reads
+ *   - the logic analyzer's sampling loop on its own core (logic.h)
+ * An edge rate is per store: with N pins in the mask, N pins switch
+ * per edge, so pin transitions per second are N times the edge rate.
+ */
+
+#include "bench.h"
+#include "gpio.h"
+#include "led.h"
+#include "timer.h"
+#include "logic.h"
+#include "kprintf.h"
+
+#define TOGGLE_ROUNDS   200000
+#define LOGIC_BENCH_MS  100
+
+/* Pins toggled (bank 0); widen to the pins of an external bus */
+#ifndef GPIO_BENCH_MASK
+#define GPIO_BENCH_MASK GPIO_BIT(ACT_LED_PIN)
+#endif
+
+static uint32_t popcount(uint32_t v) {
+    uint32_t n = 0;
+    while (v) {
+        v &= v - 1;
+        n++;
+    }
+    return n;
+}
+
+/*
+ * gpiobench_run - Measure GPIO toggle and read rates
+ */
+void gpiobench_run(void) {
+    const uint32_t mask = GPIO_BENCH_MASK;
+    uint32_t saved = gpio_read_bank(0) & mask;
+    uint64_t t0, ticks;
+    char text[48];
+
+    bench_header("gpio");
+
+    gpio_set_function_mask(0, mask, GPIO_FUNC_OUTPUT);
+
+    /* Two stores per round: set, clear */
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < TOGGLE_ROUNDS; i++) {
+        gpio_set_mask(0, mask);
+        gpio_clear_mask(0, mask);
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("set/clr toggle (edges)", 1, TOGGLE_ROUNDS * 2, ticks);
+
+    kformat(text, sizeof(text), "%u pin(s) per edge, up to 32 per store", popcount(mask));
+    bench_note("", text);
+
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < TOGGLE_ROUNDS * 2; i++) {
+        gpio_write_mask(0, mask, (i & 1) ? 0 : ~0u);
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("gpio_write_mask (edges)", 1, TOGGLE_ROUNDS * 2, ticks);
+
+    /* Read the level back before every write: bounded by read latency */
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < TOGGLE_ROUNDS * 2; i++) {
+        gpio_write_mask(0, mask, ~gpio_read_bank(0));
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("GPLEV read-modify-write", 1, TOGGLE_ROUNDS * 2, ticks);
+
+    volatile uint32_t sink = 0;
+    t0 = timer_ticks();
+    for (uint32_t i = 0; i < TOGGLE_ROUNDS * 2; i++) {
+        sink ^= gpio_read_bank(0);
+    }
+    ticks = timer_ticks() - t0;
+    bench_result("gpio_read_bank", 1, TOGGLE_ROUNDS * 2, ticks);
+    (void)sink;
+
+    gpio_write_mask(0, mask, saved);
+
+    /* Sustained sampling rate with the default pins, no trigger */
+    logic_config_t cfg;
+    logic_default_config(&cfg);
+    cfg.trigger = LOGIC_TRIG_NONE;
+    cfg.window_ms = LOGIC_BENCH_MS;
+    if (logic_capture(&cfg)) {
+        const logic_result_t *r = logic_result();
+        bench_result("logic capture (samples)", 1, r->samples, r->ticks);
+        kformat(text, sizeof(text), "core %u, %u changes recorded", LOGIC_CORE, r->changes);
+        bench_note("", text);
+    } else {
+        bench_note("logic capture", "skipped, sampling core busy or offline");
+    }
+}
@@ -0,0 +1,181 @@
+/*
+ * ipi.c - Inter-core Messages over the BCM2836 Local Mailboxes
+ */
+
+#include "ipi.h"
+#include "sync.h"
+
+/* smp_call work item, on the caller's stack */
+typedef struct {
+    smp_fn_t fn;
+    void *arg;
+    volatile uint32_t done;
+} __attribute__((aligned(16))) ipi_call_t;
+
+static ipi_handler_t handlers[IPI_TYPES];
+
+/* Last IPI_PONG value received, per core */
+static volatile uint32_t pong_value[NUM_CORES];
+
+static void call_handler(uint32_t from, uint32_t msg) {
+    ipi_call_t *call = IPI_PTR(msg);
+
+    call->fn(call->arg);
+    atomic_store_rel(&call->done, 1);
+    sev();
+}
+
+static void ping_handler(uint32_t from, uint32_t msg) {
+    ipi_send(from, IPI_MSG(IPI_PONG, IPI_VALUE(msg)));
+}
+
+static void pong_handler(uint32_t from, uint32_t msg) {
+    pong_value[smp_core_id()] = IPI_VALUE(msg);
+}
+
+/*
+ * ipi_init - Clear all local mailboxes and register the built-in types
+ *
+ * Call on core 0 before releasing cores 1-3.
+ */
+void ipi_init(void) {
+    for (uint32_t core = 0; core < NUM_CORES; core++) {
+        for (uint32_t n = 0; n < NUM_CORES; n++) {
+            *LOCAL_MBOX_CLR(core, n) = 0xFFFFFFFF;
+        }
+        /* Mailbox IRQs on (masked in PSTATE): lets wfi wake on a message */
+        *LOCAL_MBOX_CTRL(core) = 0xF;
+    }
+
+    handlers[IPI_CALL] = call_handler;
+    handlers[IPI_PING] = ping_handler;
+    handlers[IPI_PONG] = pong_handler;
+}
+
+/*
+ * ipi_register - Install the handler for a message type
+ * Returns: false if the type is out of range or built in
+ */
+bool ipi_register(uint32_t type, ipi_handler_t handler) {
+    if (type < IPI_TYPE_USER || type >= IPI_TYPES) {
+        return false;
+    }
+    handlers[type] = handler;
+    dsb(ish);
+    return true;
+}
+
+/*
+ * ipi_send - Post a message to another core and wake it
+ * @core: Receiver
+ * @msg: IPI_MSG() or IPI_PTR_MSG(); must have a non-zero type
+ * Returns: false for an invalid core or message
+ *
+ * Waits while the previous message from this core to @core is still
+ * unread, handling this core's own messages meanwhile so two cores
+ * sending to each other cannot deadlock.
+ */
+bool ipi_send(uint32_t core, uint32_t msg) {
+    uint32_t self = smp_core_id();
+
+    if (core >= NUM_CORES || core == self || (msg & IPI_TYPE_MASK) == 0) {
+        return false;
+    }
+
+    while (*LOCAL_MBOX_CLR(core, self) != 0) {
+        ipi_poll();
+    }
+
+    /* Data the message points at must be visible before the message */
+    dsb(sy);
+    *LOCAL_MBOX_SET(core, self) = msg;
+    dsb(sy);
+    sev();
+    return true;
+}
+
+/*
+ * ipi_poll - Handle pending messages for the calling core
+ * Returns: Number of messages handled
+ */
+uint32_t ipi_poll(void) {
+    uint32_t self = smp_core_id();
+    uint32_t handled = 0;
+
+    for (uint32_t from = 0; from < NUM_CORES; from++) {
+        uint32_t msg = *LOCAL_MBOX_CLR(self, from);
+
+        if (msg == 0) {
+            continue;
+        }
+        *LOCAL_MBOX_CLR(self, from) = msg;
+        dsb(sy);
+
+        ipi_handler_t handler = handlers[msg & IPI_TYPE_MASK];
+        if (handler) {
+            handler(from, msg);
+        }
+        handled++;
+    }
+    return handled;
+}
+
+/*
+ * ipi_pending - Whether a message is waiting for the calling core
+ *
+ * For wait loops that should end early to let ipi_poll() run.
+ */
+bool ipi_pending(void) {
+    uint32_t self = smp_core_id();
+
+    for (uint32_t from = 0; from < NUM_CORES; from++) {
+        if (*LOCAL_MBOX_CLR(self, from) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * ipi_ping - Send a ping and wait for the target to answer
+ * Returns: false if the core is not online
+ */
+bool ipi_ping(uint32_t core) {
+    static uint32_t seq[NUM_CORES];
+    uint32_t self = smp_core_id();
+    uint32_t value = ++seq[self] & 0x0FFFFFFF;
+
+    if (core >= smp_online_cores() || !ipi_send(core, IPI_MSG(IPI_PING, value))) {
+        return false;
+    }
+    while (pong_value[self] != value) {
+        ipi_poll();
+    }
+    return true;
+}
+
+/*
+ * smp_call - Run fn(arg) on another core and wait for it to return
+ * @core: Target core (the calling core runs fn directly)
+ * Returns: false if the core is not online
+ *
+ * Unlike smp_run(), the target need not be idle: fn runs at its next
+ * poll point, e.g. between scheduler tasks.
+ */
+bool smp_call(uint32_t core, smp_fn_t fn, void *arg) {
+    ipi_call_t call = { fn, arg, 0 };
+
+    if (core == smp_core_id()) {
+        fn(arg);
+        return true;
+    }
+    if (core >= smp_online_cores() || !ipi_send(core, IPI_PTR_MSG(IPI_CALL, &call))) {
+        return false;
+    }
+
+    while (!atomic_load_acq(&call.done)) {
+        ipi_poll();
+        wfe();
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+/*
+ * ipibench.c - Inter-core Message Latency
+ *
+ * Round trips from core 0 to each other core through the local
+ * mailboxes, in cycles: a ping answered by a pong, and an smp_call of
+ * an empty function. Cores 1-3 are idle in their dispatch loop, so the
+ * time includes their wake from wfe.
+ */
+
+#include "bench.h"
+#include "ipi.h"
+#include "pmu.h"
+#include "timer.h"
+#include "kprintf.h"
+
+#define IPI_ROUNDS      1000
+
+static void empty_call(void *arg) {
+}
+
+/* Average cycles per round trip as a note */
+static void note_cycles(const char *name, uint64_t cycles) {
+    char line[48];
+
+    kformat(line, sizeof(line), "%lu cycles/round trip", cycles / IPI_ROUNDS);
+    bench_note(name, line);
+}
+
+/*
+ * ipibench_run - Measure ping and smp_call round trips to cores 1-3
+ */
+void ipibench_run(void) {
+    char name[32];
+
+    bench_header("ipi");
+    pmu_init();
+
+    for (uint32_t core = 1; core < smp_online_cores(); core++) {
+        uint64_t t0 = timer_ticks();
+        uint64_t c0 = pmu_cycles();
+        for (uint32_t i = 0; i < IPI_ROUNDS; i++) {
+            ipi_ping(core);
+        }
+        uint64_t cycles = pmu_cycles() - c0;
+        kformat(name, sizeof(name), "ping core %u", core);
+        bench_result(name, 2, IPI_ROUNDS, timer_ticks() - t0);
+        note_cycles("", cycles);
+
+        t0 = timer_ticks();
+        c0 = pmu_cycles();
+        for (uint32_t i = 0; i < IPI_ROUNDS; i++) {
+            smp_call(core, empty_call, NULL);
+        }
+        cycles = pmu_cycles() - c0;
+        kformat(name, sizeof(name), "smp_call core %u", core);
+        bench_result(name, 2, IPI_ROUNDS, timer_ticks() - t0);
+        note_cycles("", cycles);
+    }
+}
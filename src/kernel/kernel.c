@@ -8,10 +8,34 @@
 
 #include "types.h"
 #include "framebuffer.h"
+#include "gfx.h"
+#include "dlist.h"
 #include "mailbox.h"
 #include "sysinfo.h"
 #include "string.h"
+#include "kprintf.h"
 #include "led.h"
+#include "uart.h"
+#include "snapshot.h"
+#include "telemetry.h"
+#include "governor.h"
+#include "timer.h"
+#include "bootprof.h"
+#include "trace.h"
+#include "smp.h"
+#include "mmu.h"
+#include "bench.h"
+#include "sched.h"
+#include "fiber.h"
+#include "emmc.h"
+#include "fat32.h"
+#include "assets.h"
+#include "monitor.h"
+#include "logic.h"
+#include "frame.h"
+#include "stack.h"
+#include "cursor.h"
+#include "ipi.h"
 
 /* Display resolution */
 #define SCREEN_WIDTH    1280
@@ -27,30 +51,47 @@
 #define MARGIN_Y        40
 #define LINE_HEIGHT     12      /* 8px font + 4px spacing */
 
+/* Telemetry panel (right-hand column) */
+#define PANEL_X         720
+#define PANEL_VALUE_X   (PANEL_X + 112)
+#define PANEL_Y         (MARGIN_Y + 70)
+#define PANEL_WIDTH     64      /* Max characters per value */
+
+/* Boot timeline (below telemetry panel) */
+#define TIMELINE_Y      (PANEL_Y + 160)
+#define TIMELINE_BAR_X  (PANEL_VALUE_X + 96)
+#define TIMELINE_BAR_W  200
+
+/* ARM clock policy (make GOVERNOR=performance|ondemand|powersave) */
+#ifndef GOVERNOR_POLICY
+#define GOVERNOR_POLICY "ondemand"
+#endif
+
 /* Delay for visible LED blinks */
 #define BLINK_DELAY     500000
 
-/* Draw a horizontal line */
-static void draw_hline(uint32_t y, uint32_t width) {
-    framebuffer_t *fb = fb_get_info();
-    for (uint32_t x = MARGIN_X; x < MARGIN_X + width && x < fb->width; x++) {
-        fb_put_pixel(x, y, FG_COLOR);
-    }
-}
+/* Heartbeat once boot is complete */
+#define HEARTBEAT_ON_US     125000
+#define HEARTBEAT_OFF_US    1000000
 
-/* Draw a box border */
-static void draw_box(uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
-    /* Top and bottom lines */
-    for (uint32_t i = 0; i < w; i++) {
-        fb_put_pixel(x + i, y, FG_COLOR);
-        fb_put_pixel(x + i, y + h - 1, FG_COLOR);
-    }
-    /* Left and right lines */
-    for (uint32_t i = 0; i < h; i++) {
-        fb_put_pixel(x, y + i, FG_COLOR);
-        fb_put_pixel(x + w - 1, y + i, FG_COLOR);
-    }
-}
+/* Lines of assets/strings.txt */
+#define STRINGS             "strings.txt"
+enum {
+    STR_TITLE,
+    STR_SUBTITLE,
+    STR_LOADED
+};
+
+/* Prompt line and its blinking cursor */
+#define PROMPT_TEXT         "> System ready "
+#define CURSOR_SIZE         16      /* Image side; the bar is one cell wide */
+#define CURSOR_BLINK_US     500000
+
+/* Kept for redrawing the spec sheet after the monitor screen */
+static sysinfo_t sysinfo;
+static uint32_t online_cores;
+static uint32_t first_pixel;
+static uint32_t prompt_y;
 
 /* Print a labeled value */
 static uint32_t print_info_line(uint32_t y, const char *label, const char *value) {
@@ -59,178 +100,728 @@ static uint32_t print_info_line(uint32_t y, const char *label, const char *value
     return y + LINE_HEIGHT;
 }
 
-/* Main kernel entry point (called from boot.S) */
-void kernel_main(void) {
-    sysinfo_t sysinfo;
-    char buffer[128];
-    uint32_t y;
+/* Telemetry panel rows */
+enum {
+    TELEM_ROW_TEMP,
+    TELEM_ROW_ARM,
+    TELEM_ROW_CORE,
+    TELEM_ROW_VCORE,
+    TELEM_ROW_VSDRAM,
+    TELEM_ROW_THROTTLE,
+    TELEM_ROW_SAMPLES,
+    TELEM_ROW_GOVERNOR,
+    TELEM_ROWS
+};
+
+/* Text currently on screen for each row, so unchanged rows are skipped */
+static char telem_shown[TELEM_ROWS][PANEL_WIDTH];
+
+/* Redraw a telemetry value only if its text changed */
+static void update_telem_row(uint32_t row, const char *value) {
+    char *shown = telem_shown[row];
     
-    /* Initialize LED for debugging */
-    led_init();
+    if (strcmp(shown, value) == 0) {
+        return;
+    }
     
-    /* Blink 1: Kernel started */
-    led_blink(1, BLINK_DELAY);
-    delay(BLINK_DELAY * 2);
+    uint32_t y = PANEL_Y + LINE_HEIGHT + 8 + row * LINE_HEIGHT;
+    uint32_t old_len = strlen(shown);
+    uint32_t len = strlen(value);
     
-    /* Initialize framebuffer */
-    if (!fb_init(SCREEN_WIDTH, SCREEN_HEIGHT, COLOR_DEPTH)) {
-        /* FB failed - blink rapidly forever */
-        while (1) {
-            led_blink(5, BLINK_DELAY / 5);
-            delay(BLINK_DELAY * 2);
-        }
+    fb_draw_string(PANEL_VALUE_X, y, value, FG_COLOR, BG_COLOR);
+    
+    /* Blank the tail of a longer previous value */
+    if (old_len > len) {
+        fb_fill_rect(PANEL_VALUE_X + len * 8, y, (old_len - len) * 8, 8, BG_COLOR);
     }
     
-    /* Blink 2: Framebuffer initialized */
-    led_blink(2, BLINK_DELAY);
-    delay(BLINK_DELAY * 2);
+    strcpy(shown, value);
+}
+
+/* Per-value formatter: writes at most size - 1 characters, returns the count */
+typedef size_t (*value_fmt_t)(char *buffer, size_t size, uint32_t value);
+
+/* Format "cur unit (min-max avg avg)" with the given per-value formatter */
+static void format_range(char *buffer, size_t size, uint32_t cur, const telemetry_stat_t *st,
+                         value_fmt_t fmt, const char *unit) {
+    char *p = buffer;
+    char *end = buffer + size;
+    
+    p += fmt(p, end - p, cur);
+    p += kformat(p, end - p, "%s (", unit);
+    p += fmt(p, end - p, st->min);
+    p += kformat(p, end - p, "-");
+    p += fmt(p, end - p, st->max);
+    p += kformat(p, end - p, " avg ");
+    p += fmt(p, end - p, st->avg);
+    kformat(p, end - p, ")");
+}
+
+static size_t fmt_temp(char *buffer, size_t size, uint32_t mc) {
+    return kformat(buffer, size, "%u.%u", mc / 1000, mc % 1000 / 100);
+}
+
+static size_t fmt_clock(char *buffer, size_t size, uint32_t hz) {
+    return kformat(buffer, size, "%u", hz / 1000000);
+}
+
+static size_t fmt_volt(char *buffer, size_t size, uint32_t uv) {
+    uint32_t mv = uv / 1000;
+    return kformat(buffer, size, "%u.%03u", mv / 1000, mv % 1000);
+}
+
+/* Throttle flags shown while active */
+static const struct {
+    uint32_t bit;
+    const char *name;
+} throttle_flags[] = {
+    { THROTTLE_UNDERVOLT,   "UNDERVOLT " },
+    { THROTTLE_FREQ_CAPPED, "CAPPED " },
+    { THROTTLE_THROTTLED,   "THROTTLED " },
+    { THROTTLE_SOFT_TEMP,   "SOFT-TEMP " },
+};
+
+/* Draw static labels of the telemetry panel */
+static void draw_telemetry_labels(void) {
+    static const char *labels[TELEM_ROWS] = {
+        "Temp:", "ARM Clock:", "Core Clock:", "Core Volt:",
+        "SDRAM Volt:", "Throttle:", "Samples:", "Governor:"
+    };
+    
+    fb_draw_string(PANEL_X, PANEL_Y, "=== TELEMETRY ===", FG_COLOR, BG_COLOR);
+    for (uint32_t row = 0; row < TELEM_ROWS; row++) {
+        fb_draw_string(PANEL_X + 8, PANEL_Y + LINE_HEIGHT + 8 + row * LINE_HEIGHT,
+                       labels[row], FG_COLOR, BG_COLOR);
+    }
+}
+
+/* Refresh telemetry values from the latest sample */
+static void update_telemetry_panel(void) {
+    const telemetry_sample_t *s = telemetry_latest();
+    telemetry_agg_t agg;
+    char buffer[PANEL_WIDTH];
+    
+    if (s == NULL) {
+        return;
+    }
+    telemetry_aggregate(&agg);
     
-    /* Clear screen to black */
-    fb_clear(BG_COLOR);
+    if (s->valid & TELEM_VALID_TEMP) {
+        format_range(buffer, sizeof(buffer), s->temp_mc, &agg.temp_mc, fmt_temp, " C");
+        update_telem_row(TELEM_ROW_TEMP, buffer);
+    }
+    if (s->valid & TELEM_VALID_ARM_CLOCK) {
+        format_range(buffer, sizeof(buffer), s->arm_clock, &agg.arm_clock, fmt_clock, " MHz");
+        update_telem_row(TELEM_ROW_ARM, buffer);
+    }
+    if (s->valid & TELEM_VALID_CORE_CLOCK) {
+        format_range(buffer, sizeof(buffer), s->core_clock, &agg.core_clock, fmt_clock, " MHz");
+        update_telem_row(TELEM_ROW_CORE, buffer);
+    }
+    if (s->valid & TELEM_VALID_VOLT_CORE) {
+        format_range(buffer, sizeof(buffer), s->volt_core, &agg.volt_core, fmt_volt, " V");
+        update_telem_row(TELEM_ROW_VCORE, buffer);
+    }
+    if (s->valid & TELEM_VALID_VOLT_SDRAM) {
+        format_range(buffer, sizeof(buffer), s->volt_sdram, &agg.volt_sdram, fmt_volt, " V");
+        update_telem_row(TELEM_ROW_VSDRAM, buffer);
+    }
+    if (s->valid & TELEM_VALID_THROTTLED) {
+        uint32_t now = s->throttled;
+        size_t len = 0;
+        for (uint32_t i = 0; i < sizeof(throttle_flags) / sizeof(throttle_flags[0]); i++) {
+            if (now & throttle_flags[i].bit) {
+                len += kformat(buffer + len, sizeof(buffer) - len, "%s", throttle_flags[i].name);
+            }
+        }
+        if (len == 0) {
+            kformat(buffer, sizeof(buffer), "%s",
+                    (agg.throttled_any & 0xF) ? "OK (was limited)" : "OK");
+        }
+        update_telem_row(TELEM_ROW_THROTTLE, buffer);
+    }
     
-    /* Blink 3: Screen cleared */
-    led_blink(3, BLINK_DELAY);
+    kformat(buffer, sizeof(buffer), "%u / %u @ %u ms",
+            telemetry_count(), TELEMETRY_RING_SIZE, TELEMETRY_PERIOD_MS);
+    update_telem_row(TELEM_ROW_SAMPLES, buffer);
     
-    /* Query system information */
-    sysinfo_init(&sysinfo);
+    const governor_t *gov = governor_get();
+    kformat(buffer, sizeof(buffer), "%s, cap %u MHz",
+            governor_policy_name(gov->policy), gov->cap / 1000000);
+    update_telem_row(TELEM_ROW_GOVERNOR, buffer);
+}
+
+/* Whether the monitor or the logic analyzer has the screen */
+static bool spec_sheet_hidden(void) {
+    return monitor_active() || logic_active();
+}
+
+/* Sample telemetry when due and refresh the panel */
+static void poll_telemetry(void) {
+    if (telemetry_poll()) {
+        const telemetry_sample_t *s = telemetry_latest();
+        if (s->valid & TELEM_VALID_TEMP) {
+            governor_thermal(s->temp_mc);
+        }
+        if (!spec_sheet_hidden()) {
+            update_telemetry_panel();
+        }
+    }
+}
+
+/* Fiber: slow heartbeat on the ACT LED */
+static void heartbeat_fiber(void *arg) {
+    while (1) {
+        led_on();
+        fiber_sleep_us(HEARTBEAT_ON_US);
+        led_off();
+        fiber_sleep_us(HEARTBEAT_OFF_US);
+    }
+}
+
+/* Frame client: sample telemetry when due and redraw changed values */
+static void telemetry_render(void *arg) {
+    poll_telemetry();
+}
+
+/*
+ * setup_cursor - Upload an underscore-shaped hardware cursor
+ * Returns: false if the firmware has no cursor support
+ */
+static bool setup_cursor(void) {
+    static uint32_t image[CURSOR_SIZE * CURSOR_SIZE];
+    uint32_t pixel = gfx_pixel(FG_COLOR);
+    
+    /* Bottom two rows of an 8x8 character cell, like '_' */
+    for (uint32_t y = 6; y < 8; y++) {
+        for (uint32_t x = 0; x < 8; x++) {
+            image[y * CURSOR_SIZE + x] = pixel;
+        }
+    }
+    return cursor_init(image, CURSOR_SIZE, CURSOR_SIZE, 0, 0);
+}
+
+/* Fiber: blink the hardware cursor after the prompt (hidden off the spec sheet) */
+static void cursor_fiber(void *arg) {
+    cursor_move(MARGIN_X + (sizeof(PROMPT_TEXT) - 1) * 8, prompt_y);
+    while (1) {
+        cursor_show(!cursor_visible() && !spec_sheet_hidden());
+        fiber_sleep_us(CURSOR_BLINK_US);
+    }
+}
+
+/* Log render time and clock over serial */
+static void report_render_time(uint64_t ticks) {
+    kprintf("Render: %lu us (ARM %u MHz, %s)\n", timer_ticks_to_us(ticks),
+            governor_get()->rate / 1000000, governor_policy_name(governor_get()->policy));
+}
+
+#ifdef FAST_BOOT
+/* Fast boot: LED held on as a non-blocking "booting" status */
+static void boot_status(int blinks, bool pause) {
+    (void)blinks;
+    (void)pause;
+    led_on();
+}
+#else
+/* Blocking LED diagnostic: blink count identifies the boot stage */
+static void boot_status(int blinks, bool pause) {
+    led_blink(blinks, BLINK_DELAY);
+    if (pause) {
+        delay(BLINK_DELAY * 2);
+    }
+    boot_mark("led diag");
+}
+#endif
+
+/* Draw the boot timeline: elapsed time per phase with a bar */
+static void draw_boot_timeline(uint32_t first_pixel) {
+    uint32_t y = TIMELINE_Y;
+    uint32_t count = bootprof_count();
+    uint64_t total = bootprof_elapsed_us(count - 1);
     
-    /* === Draw Header === */
-    y = MARGIN_Y;
+    fb_draw_string(PANEL_X, y, "=== BOOT TIMELINE ===", FG_COLOR, BG_COLOR);
+    y += LINE_HEIGHT + 8;
     
-    /* Title banner */
-    draw_box(MARGIN_X, y, 600, 50);
-    fb_draw_string(MARGIN_X + 16, y + 12, "RASPBERRY PI ZERO 2 W", FG_COLOR, BG_COLOR);
-    fb_draw_string(MARGIN_X + 16, y + 28, "Custom Bare-Metal Kernel v1.0", FG_COLOR, BG_COLOR);
+    for (uint32_t i = 1; i < count; i++) {
+        uint64_t us = bootprof_phase_us(i);
+        
+        fb_draw_string(PANEL_X + 8, y, bootprof_get(i)->name, FG_COLOR, BG_COLOR);
+        fb_printf(PANEL_VALUE_X, y, FG_COLOR, BG_COLOR, "%lu us", us);
+        
+        uint32_t bar = total ? (uint32_t)(us * TIMELINE_BAR_W / total) : 0;
+        if (bar == 0 && us) {
+            bar = 1;
+        }
+        fb_fill_rect(TIMELINE_BAR_X, y + 1, bar, 6, FG_COLOR);
+        y += LINE_HEIGHT;
+    }
     
-    y += 70;
+    y += 4;
+    fb_draw_string(PANEL_X + 8, y, "First pixel:", FG_COLOR, BG_COLOR);
+    fb_printf(PANEL_VALUE_X, y, FG_COLOR, BG_COLOR, "%lu us", bootprof_elapsed_us(first_pixel));
+    y += LINE_HEIGHT;
+    fb_draw_string(PANEL_X + 8, y, "Boot total:", FG_COLOR, BG_COLOR);
+    fb_printf(PANEL_VALUE_X, y, FG_COLOR, BG_COLOR, "%lu us", total);
+}
+
+static void draw_spec_sheet(void);
+
+/* Switch between the spec sheet and the live monitor */
+static void toggle_monitor(void) {
+    if (monitor_active()) {
+        monitor_stop();
+        draw_spec_sheet();
+    } else {
+        logic_close();
+        cursor_show(false);
+        monitor_start(&sysinfo);
+    }
+}
+
+/* Capture with the default config; stop early; back to the spec sheet */
+static void toggle_logic(void) {
+    logic_config_t cfg;
+    
+    if (logic_busy()) {
+        logic_abort();
+    } else if (logic_active()) {
+        logic_close();
+        draw_spec_sheet();
+    } else {
+        logic_default_config(&cfg);
+        monitor_stop();
+        cursor_show(false);
+        if (!logic_start(&cfg)) {
+            uart_puts("Logic: sampling core not available\n");
+            draw_spec_sheet();
+        }
+    }
+}
+
+/* Handle serial commands: snapshot, benchmarks, trace, monitor, logic, frames */
+static void poll_serial_commands(void) {
+    int c = uart_try_getc();
+    
+    if (c == SNAPSHOT_TRIGGER_KEY) {
+        snapshot_send();
+    } else if (c == BENCH_TRIGGER_KEY) {
+        bench_run_all();
+    } else if (c == TRACE_TRIGGER_KEY) {
+        trace_dump();
+    } else if (c == MONITOR_TRIGGER_KEY) {
+        toggle_monitor();
+    } else if (c == LOGIC_TRIGGER_KEY) {
+        toggle_logic();
+    } else if (c == FRAME_STATS_KEY) {
+        frame_report();
+    } else if (c == MONITOR_FASTER_KEY && monitor_active()) {
+        monitor_set_period_ms(monitor_period_ms() / 2);
+    } else if (c == MONITOR_SLOWER_KEY && monitor_active()) {
+        monitor_set_period_ms(monitor_period_ms() * 2);
+    }
+}
+
+/* Panel title, returns y of first info line */
+static uint32_t draw_panel_title(uint32_t y, const char *title) {
+    fb_draw_string(MARGIN_X, y, title, FG_COLOR, BG_COLOR);
+    return y + LINE_HEIGHT + 8;
+}
+
+/* === Board Information === */
+static void draw_board_panel(uint32_t y, const sysinfo_t *sysinfo) {
+    char buffer[64];
     
-    /* === Board Information === */
-    fb_draw_string(MARGIN_X, y, "=== BOARD INFORMATION ===", FG_COLOR, BG_COLOR);
-    y += LINE_HEIGHT + 8;
+    y = draw_panel_title(y, "=== BOARD INFORMATION ===");
     
     /* Model name */
-    const char *model_name = sysinfo_get_model_name(sysinfo.board_revision);
+    const char *model_name = sysinfo_get_model_name(sysinfo->board_revision);
     y = print_info_line(y, "Model:", model_name);
     
     /* Board revision */
-    format_hex32(sysinfo.board_revision, buffer);
+    kformat(buffer, sizeof(buffer), "0x%08X", sysinfo->board_revision);
     y = print_info_line(y, "Revision:", buffer);
     
     /* Serial number */
-    u64toa(sysinfo.serial_number, buffer, 16);
+    kformat(buffer, sizeof(buffer), "%lX", sysinfo->serial_number);
     y = print_info_line(y, "Serial:", buffer);
     
     /* Firmware version */
-    format_dec(sysinfo.firmware_version, buffer);
+    kformat(buffer, sizeof(buffer), "%u", sysinfo->firmware_version);
     y = print_info_line(y, "Firmware:", buffer);
+}
+
+/* === Processor Information === */
+static void draw_processor_panel(uint32_t y, const sysinfo_t *sysinfo) {
+    char buffer[64];
     
-    y += 16;
-    
-    /* === Processor Information === */
-    fb_draw_string(MARGIN_X, y, "=== PROCESSOR ===", FG_COLOR, BG_COLOR);
-    y += LINE_HEIGHT + 8;
+    y = draw_panel_title(y, "=== PROCESSOR ===");
     
     y = print_info_line(y, "SoC:", "BCM2710A1 (Broadcom)");
     y = print_info_line(y, "CPU:", "Quad-core ARM Cortex-A53");
     y = print_info_line(y, "Architecture:", "ARMv8-A (64-bit)");
     
     /* ARM clock speed */
-    format_mhz(sysinfo.arm_clock, buffer);
+    kformat(buffer, sizeof(buffer), "%u MHz", sysinfo->arm_clock / 1000000);
     y = print_info_line(y, "ARM Clock:", buffer);
     
     /* Core clock speed */
-    format_mhz(sysinfo.core_clock, buffer);
+    kformat(buffer, sizeof(buffer), "%u MHz", sysinfo->core_clock / 1000000);
     y = print_info_line(y, "Core Clock:", buffer);
+}
+
+/* === Memory Information === */
+static void draw_memory_panel(uint32_t y, const sysinfo_t *sysinfo) {
+    char buffer[64];
     
-    y += 16;
-    
-    /* === Memory Information === */
-    fb_draw_string(MARGIN_X, y, "=== MEMORY ===", FG_COLOR, BG_COLOR);
-    y += LINE_HEIGHT + 8;
+    y = draw_panel_title(y, "=== MEMORY ===");
     
     /* ARM memory */
-    format_mb(sysinfo.arm_mem_size, buffer);
-    strcat(buffer, " @ ");
-    char addr[16];
-    format_hex32(sysinfo.arm_mem_base, addr);
-    strcat(buffer, addr);
+    kformat(buffer, sizeof(buffer), "%u MB @ 0x%08X",
+            sysinfo->arm_mem_size / (1024 * 1024), sysinfo->arm_mem_base);
     y = print_info_line(y, "ARM Memory:", buffer);
     
     /* VideoCore memory */
-    format_mb(sysinfo.vc_mem_size, buffer);
-    strcat(buffer, " @ ");
-    format_hex32(sysinfo.vc_mem_base, addr);
-    strcat(buffer, addr);
+    kformat(buffer, sizeof(buffer), "%u MB @ 0x%08X",
+            sysinfo->vc_mem_size / (1024 * 1024), sysinfo->vc_mem_base);
     y = print_info_line(y, "GPU Memory:", buffer);
     
     /* SDRAM clock */
-    format_mhz(sysinfo.sdram_clock, buffer);
+    kformat(buffer, sizeof(buffer), "%u MHz", sysinfo->sdram_clock / 1000000);
     y = print_info_line(y, "SDRAM Clock:", buffer);
+}
+
+/* === Network Information === */
+static void draw_network_panel(uint32_t y, const sysinfo_t *sysinfo) {
+    char buffer[64];
     
-    y += 16;
-    
-    /* === Network Information === */
-    fb_draw_string(MARGIN_X, y, "=== NETWORK ===", FG_COLOR, BG_COLOR);
-    y += LINE_HEIGHT + 8;
+    y = draw_panel_title(y, "=== NETWORK ===");
     
     y = print_info_line(y, "WiFi:", "802.11 b/g/n (2.4 GHz)");
     y = print_info_line(y, "Bluetooth:", "Bluetooth 4.2, BLE");
     
     /* MAC address */
-    format_mac(sysinfo.mac_address, buffer);
+    const uint8_t *mac = (const uint8_t *)sysinfo->mac_address;
+    kformat(buffer, sizeof(buffer), "%02X:%02X:%02X:%02X:%02X:%02X",
+            mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
     y = print_info_line(y, "MAC Address:", buffer);
-    
-    y += 16;
-    
-    /* === Display Information === */
-    fb_draw_string(MARGIN_X, y, "=== DISPLAY ===", FG_COLOR, BG_COLOR);
-    y += LINE_HEIGHT + 8;
-    
+}
+
+/* === Display Information === */
+static void draw_display_panel(uint32_t y, const sysinfo_t *sysinfo) {
+    char buffer[64];
     framebuffer_t *fb = fb_get_info();
     
+    y = draw_panel_title(y, "=== DISPLAY ===");
+    
     /* Resolution */
-    utoa(fb->width, buffer, 10);
-    strcat(buffer, " x ");
-    char tmp[16];
-    utoa(fb->height, tmp, 10);
-    strcat(buffer, tmp);
-    strcat(buffer, " @ ");
-    utoa(fb->depth, tmp, 10);
-    strcat(buffer, tmp);
-    strcat(buffer, "bpp");
+    kformat(buffer, sizeof(buffer), "%u x %u @ %ubpp", fb->width, fb->height, fb->depth);
     y = print_info_line(y, "Resolution:", buffer);
     
     /* Pitch */
-    utoa(fb->pitch, buffer, 10);
-    strcat(buffer, " bytes/row");
+    kformat(buffer, sizeof(buffer), "%u bytes/row", fb->pitch);
     y = print_info_line(y, "Pitch:", buffer);
     
     /* Framebuffer address */
-    format_hex32((uint32_t)(uint64_t)fb->buffer, buffer);
+    kformat(buffer, sizeof(buffer), "0x%08X", (uint32_t)(uint64_t)fb->buffer);
     y = print_info_line(y, "FB Address:", buffer);
     
     /* Framebuffer size */
-    format_mb(fb->size, buffer);
+    kformat(buffer, sizeof(buffer), "%u MB", fb->size / (1024 * 1024));
     y = print_info_line(y, "FB Size:", buffer);
+}
+
+/* Spec-sheet panels, top to bottom, with their info line counts */
+typedef struct {
+    void (*draw)(uint32_t y, const sysinfo_t *sysinfo);
+    uint32_t lines;
+} panel_t;
+
+static const panel_t panels[] = {
+    { draw_board_panel,     4 },
+    { draw_processor_panel, 5 },
+    { draw_memory_panel,    3 },
+    { draw_network_panel,   3 },
+    { draw_display_panel,   4 },
+};
+
+#define NUM_PANELS      (sizeof(panels) / sizeof(panels[0]))
+#define PANEL_GAP       16
+
+/* One panel rendered as a task */
+typedef struct {
+    const panel_t *panel;
+    uint32_t y;
+    const sysinfo_t *sysinfo;
+    task_t task;
+} panel_job_t;
+
+static void panel_task(void *arg) {
+    panel_job_t *job = arg;
+    job->panel->draw(job->y, job->sysinfo);
+}
+
+/* Title banner logo from the asset bundle */
+static void draw_logo(void) {
+    uint32_t size;
+    const uint8_t *logo = asset_find("logo.qoi", &size);
     
-    y += 24;
+    if (logo) {
+        fb_draw_qoi(MARGIN_X + 600 - 48, MARGIN_Y + 5, logo, size);
+    }
+}
+
+/*
+ * draw_static_screen - Background, banner and footer in one tiled pass
+ * @panels_y: Top of the first spec-sheet panel
+ * @cores: Cores online (footer)
+ *
+ * Recorded into a display list so every framebuffer pixel is stored
+ * once, however many of these layers cover it.
+ */
+static void draw_static_screen(uint32_t panels_y, uint32_t cores) {
+    static gfx_surface_t screen;
+    static dlist_t dl;
+    char buffer[64];
+    uint32_t y = panels_y;
+    
+    for (uint32_t i = 0; i < NUM_PANELS; i++) {
+        y += LINE_HEIGHT + 8 + panels[i].lines * LINE_HEIGHT + PANEL_GAP;
+    }
+    y += 8;
+    
+    gfx_screen(&screen);
+    dl_begin(&dl, &screen);
+    dl_fill(&dl, 0, 0, screen.width, screen.height, BG_COLOR);
     
-    /* === Footer === */
-    draw_hline(y, 600);
+    /* Title banner */
+    dl_rect(&dl, MARGIN_X, MARGIN_Y, 600, 50, FG_COLOR);
+    dl_text(&dl, MARGIN_X + 16, MARGIN_Y + 12, asset_string(STRINGS, STR_TITLE), FG_COLOR, BG_COLOR);
+    dl_text(&dl, MARGIN_X + 16, MARGIN_Y + 28, asset_string(STRINGS, STR_SUBTITLE),
+            FG_COLOR, BG_COLOR);
+    
+    /* Footer */
+    dl_line(&dl, MARGIN_X, y, MARGIN_X + 600 - 1, y, FG_COLOR);
     y += 8;
-    fb_draw_string(MARGIN_X, y, "Kernel loaded at 0x80000 | Running on Core 0", FG_COLOR, BG_COLOR);
+    dl_text(&dl, MARGIN_X, y, asset_string(STRINGS, STR_LOADED), FG_COLOR, BG_COLOR);
     y += LINE_HEIGHT;
-    fb_draw_string(MARGIN_X, y, "Cores 1-3 parked in WFE loop", FG_COLOR, BG_COLOR);
+    kformat(buffer, sizeof(buffer), "%u/4 cores online - cores 1-3 idle in WFE", cores);
+    dl_text(&dl, MARGIN_X, y, buffer, FG_COLOR, BG_COLOR);
     
-    /* Draw decorative element - blinking cursor simulation */
+    /* Prompt; the hardware cursor blinks after it, else a drawn one */
     y += 24;
-    fb_draw_string(MARGIN_X, y, "> System ready _", FG_COLOR, BG_COLOR);
+    dl_text(&dl, MARGIN_X, y, cursor_available() ? PROMPT_TEXT : PROMPT_TEXT "_",
+            FG_COLOR, BG_COLOR);
+    prompt_y = y;
+    
+    dl_render(&dl);
+}
+
+/*
+ * draw_spec_sheet - Redraw the whole boot screen on one core
+ *
+ * Used when leaving the monitor; boot draws the same parts spread
+ * over the scheduler instead.
+ */
+static void draw_spec_sheet(void) {
+    uint32_t y = MARGIN_Y + 70;
+    
+    draw_static_screen(y, online_cores);
+    draw_logo();
+    for (uint32_t i = 0; i < NUM_PANELS; i++) {
+        panels[i].draw(y, &sysinfo);
+        y += LINE_HEIGHT + 8 + panels[i].lines * LINE_HEIGHT + PANEL_GAP;
+    }
     
-    /* Success - slow heartbeat blink */
+    draw_telemetry_labels();
+    memset(telem_shown, 0, sizeof(telem_shown));
+    update_telemetry_panel();
+    draw_boot_timeline(first_pixel);
+}
+
+/* Query hardware while the screen is being cleared */
+static void sysinfo_task(void *arg) {
+    trace_begin("sysinfo_init");
+    sysinfo_init((sysinfo_t *)arg);
+    trace_end("sysinfo_init");
+    telemetry_init();
+}
+
+/* Bring up the SD card and mount FAT32 while the screen renders */
+static void storage_task(void *arg) {
+    trace_begin("storage");
+    if (emmc_init()) {
+        fat_mount();
+    }
+    trace_end("storage");
+}
+
+/* Log what storage_task found */
+static void report_storage(void) {
+    uart_puts("SD: ");
+    if (!emmc_ready()) {
+        uart_puts("no card\n");
+        return;
+    }
+    if (!fat_mounted()) {
+        uart_puts("card present, no FAT32 volume\n");
+        return;
+    }
+    kprintf("FAT32 %u MB, %u byte clusters\n", fat_volume_mb(), fat_cluster_size());
+}
+
+static bool serial_pending(void *arg) {
+    return uart_rx_ready();
+}
+
+/* Fiber: run serial commands as they arrive */
+static void serial_fiber(void *arg) {
     while (1) {
-        led_on();
-        delay(BLINK_DELAY / 2);
-        led_off();
-        delay(BLINK_DELAY * 4);
+        fiber_wait_until(serial_pending, NULL);
+        poll_serial_commands();
+    }
+}
+
+/* Main kernel entry point (called from boot.S) */
+void kernel_main(void) {
+    uint32_t y;
+    uint64_t t0, render_ticks;
+    
+    bootprof_init();
+    
+    /* Identity map with caches first: exclusives need Normal memory */
+    bool mmu = mmu_init();
+    
+    /* Initialize LED and serial for debugging */
+    led_init();
+    uart_init(UART_BAUD);
+    uart_puts("\nPi Zero 2 W kernel started\n");
+    uart_puts(mmu ? "MMU: on, caches enabled\n" : "MMU: off, running uncached\n");
+    
+    /* Paint stacks for high-water marks; guard pages need the MMU */
+    stack_init();
+    
+    /* Boot is busy: ondemand/performance raise the ARM clock now */
+    governor_init(governor_parse_policy(GOVERNOR_POLICY));
+    
+    /* Release cores 1-3 into their idle/dispatch loop (needs the MMU) */
+    ipi_init();
+    uint32_t cores = smp_start_secondaries();
+    online_cores = cores;
+    if (smp_started()) {
+        kprintf("SMP: %u cores online\n", cores);
+    } else {
+        uart_puts("SMP: MMU off, cores 1-3 stay parked, running on core 0 only\n");
+    }
+    boot_mark("init");
+    
+    /* Blink 1: Kernel started */
+    boot_status(1, true);
+    
+    /* Initialize framebuffer */
+    if (!fb_init(SCREEN_WIDTH, SCREEN_HEIGHT, COLOR_DEPTH)) {
+        /* FB failed - blink rapidly forever */
+        while (1) {
+            led_blink(5, BLINK_DELAY / 5);
+            delay(BLINK_DELAY * 2);
+        }
+    }
+    
+    boot_mark("fb_init");
+    
+    /* Firmware-composited prompt cursor, if supported */
+    setup_cursor();
+    
+    /* Blink 2: Framebuffer initialized */
+    boot_status(2, true);
+    
+    /* All cores render until the screen is complete */
+    sched_start(cores);
+    
+    /* Query system information in the background */
+    task_t info_task;
+    task_spawn(&info_task, sysinfo_task, &sysinfo);
+    
+    /* SD card init waits on the card; keep it off the critical path */
+    task_t sd_task;
+    task_spawn(&sd_task, storage_task, NULL);
+    
+    /* Background, banner and footer, tiles spread across cores */
+    t0 = timer_ticks();
+    draw_static_screen(MARGIN_Y + 70, cores);
+    draw_logo();
+    render_ticks = timer_ticks() - t0;
+    first_pixel = boot_mark("first frame");
+    
+    /* Blink 3: Screen cleared */
+    boot_status(3, false);
+    
+    task_wait(&info_task);
+    boot_mark("sysinfo_init");
+    
+    t0 = timer_ticks();
+    y = MARGIN_Y + 70;
+    
+    /* Spec-sheet panels render concurrently, one task each */
+    panel_job_t jobs[NUM_PANELS];
+    for (uint32_t i = 0; i < NUM_PANELS; i++) {
+        jobs[i].panel = &panels[i];
+        jobs[i].y = y;
+        jobs[i].sysinfo = &sysinfo;
+        task_spawn(&jobs[i].task, panel_task, &jobs[i]);
+        y += LINE_HEIGHT + 8 + panels[i].lines * LINE_HEIGHT + PANEL_GAP;
+    }
+    
+    /* === Telemetry (live) === */
+    draw_telemetry_labels();
+    update_telemetry_panel();
+    
+    for (uint32_t i = 0; i < NUM_PANELS; i++) {
+        task_wait(&jobs[i].task);
+    }
+    render_ticks += timer_ticks() - t0;
+    boot_mark("render");
+    
+    task_wait(&sd_task);
+    boot_mark("storage");
+    sched_stop();
+    
+    report_storage();
+    report_render_time(render_ticks);
+    stack_report();
+    draw_boot_timeline(first_pixel);
+    bootprof_report();
+    kprintf("Time to first pixel: %lu us\n", bootprof_elapsed_us(first_pixel));
+    
+    /* Rendering done - ondemand drops to the minimum clock */
+    governor_idle();
+    update_telemetry_panel();
+    
+    uart_puts("Screen ready - send 's' for a framebuffer snapshot, 'b' for benchmarks, "
+              "'t' for a trace, 'm' for the monitor, 'l' for the logic analyzer, "
+              "'f' for frame pacing\n");
+#ifdef SNAPSHOT_ON_BOOT
+    snapshot_send();
+#endif
+#ifdef TRACE_ON_BOOT
+    trace_dump();
+#endif
+#ifdef BENCH_ON_BOOT
+    bench_run_all();
+#endif
+    
+    /* Telemetry panel and monitor redraw on vsync-paced frames */
+    frame_init(FRAME_HZ);
+    frame_register("telemetry", NULL, telemetry_render, NULL);
+    monitor_init();
+    
+    /* Success - heartbeat, frames and serial run as fibers from here */
+    fiber_create("heartbeat", heartbeat_fiber, NULL);
+    fiber_create("frame", frame_fiber, NULL);
+    fiber_create("serial", serial_fiber, NULL);
+    fiber_create("logic", logic_fiber, NULL);
+    if (cursor_available()) {
+        fiber_create("cursor", cursor_fiber, NULL);
     }
+    fiber_run();
 }
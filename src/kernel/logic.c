@@ -0,0 +1,446 @@
+/*
+ * logic.c - GPIO Logic Analyzer
+ *
+ * The sampling loop on LOGIC_CORE is two GPLEV loads, a compare and a
+ * counter increment; bank 1 is not read unless it has captured pins.
+ * The timer is only read when the levels change (for the record's
+ * timestamp) and every LOGIC_POLL_SAMPLES samples (for the deadline and
+ * abort flag), so a quiet bus samples at the rate of the GPLEV loads.
+ *
+ * The ring lives in its own section (.logic, not loaded or cleared)
+ * so it costs nothing at boot. Records are indexed by a counter that
+ * only grows; the slot is index & (LOGIC_RECORDS - 1).
+ */
+
+#include "logic.h"
+#include "framebuffer.h"
+#include "font8x8.h"
+#include "gfx.h"
+#include "kprintf.h"
+#include "fiber.h"
+#include "timer.h"
+#include "sync.h"
+
+#define RING_MASK       (LOGIC_RECORDS - 1)
+
+/* Colors and layout, matching the spec sheet */
+#define FG_COLOR        COLOR_TERM_GREEN
+#define BG_COLOR        COLOR_BLACK
+#define DIM_COLOR       (color_t){0x10, 0x40, 0x10, 0xFF}
+#define TRIG_COLOR      COLOR_YELLOW
+
+#define VIEW_X          40
+#define VIEW_Y          40
+#define VIEW_LINE       12
+#define WAVE_X          (VIEW_X + 56)
+#define WAVE_Y          (VIEW_Y + 5 * VIEW_LINE)
+#define WAVE_BOTTOM     680
+#define LANE_MAX_H      16
+#define AXIS_DIVS       8
+
+enum {
+    STATE_IDLE,
+    STATE_CAPTURING,
+    STATE_DONE,                 /* Set by LOGIC_CORE, picked up by logic_fiber */
+    STATE_VIEW
+};
+
+static logic_record_t ring[LOGIC_RECORDS] __attribute__((section(".logic"), aligned(64)));
+
+static volatile uint32_t state;
+static volatile uint32_t abort_req;
+static logic_config_t config;
+static logic_result_t result;
+static uint32_t first;          /* Ring index of logic_record(0) */
+
+static inline bool trigger_hit(uint32_t before, uint32_t after) {
+    uint32_t m = config.trig_mask;
+
+    switch (config.trigger) {
+    case LOGIC_TRIG_LEVEL:
+        return (after & m) == config.trig_value;
+    case LOGIC_TRIG_RISING:
+        return (~before & after & m) != 0;
+    case LOGIC_TRIG_FALLING:
+        return (before & ~after & m) != 0;
+    case LOGIC_TRIG_EDGE:
+        return ((before ^ after) & m) != 0;
+    default:
+        return true;
+    }
+}
+
+/* Sampling loop, runs on LOGIC_CORE */
+static void capture(void *arg) {
+    const uint32_t m0 = config.mask[0];
+    const uint32_t m1 = config.mask[1];
+    const uint32_t tb = config.trig_bank;
+    uint32_t lev[2], prev[2];
+    uint32_t n = 0, w = 0, trig_w = 0, stop_at = 0;
+    bool triggered = false;
+
+    uint64_t start = timer_ticks();
+    uint64_t deadline = start + timer_us_to_ticks((uint64_t)config.timeout_ms * 1000);
+    uint64_t now = start;
+
+    prev[0] = gpio_read_bank(0) & m0;
+    prev[1] = m1 ? gpio_read_bank(1) & m1 : 0;
+    ring[0] = (logic_record_t){ 0, 0, { prev[0], prev[1] } };
+    w = 1;
+
+    /* A level trigger may already hold; edges need a change */
+    if (config.trigger == LOGIC_TRIG_NONE || trigger_hit(prev[tb], prev[tb])) {
+        triggered = true;
+        stop_at = LOGIC_RECORDS;
+        deadline = start + timer_us_to_ticks((uint64_t)config.window_ms * 1000);
+    }
+
+    for (;;) {
+        lev[0] = gpio_read_bank(0) & m0;
+        lev[1] = m1 ? gpio_read_bank(1) & m1 : 0;
+        n++;
+
+        if (lev[0] != prev[0] || lev[1] != prev[1]) {
+            now = timer_ticks();
+            ring[w & RING_MASK] = (logic_record_t){ n, (uint32_t)(now - start),
+                                                    { lev[0], lev[1] } };
+
+            if (!triggered && trigger_hit(prev[tb], lev[tb])) {
+                uint32_t pre = w < LOGIC_PRE_RECORDS ? w : LOGIC_PRE_RECORDS;
+                triggered = true;
+                trig_w = w;
+                stop_at = w + LOGIC_RECORDS - pre;
+                deadline = now + timer_us_to_ticks((uint64_t)config.window_ms * 1000);
+            }
+            w++;
+            prev[0] = lev[0];
+            prev[1] = lev[1];
+            if (triggered && w == stop_at) {
+                break;
+            }
+        }
+
+        if ((n & (LOGIC_POLL_SAMPLES - 1)) == 0) {
+            now = timer_ticks();
+            if (now >= deadline || abort_req) {
+                break;
+            }
+        }
+    }
+    now = timer_ticks();
+
+    /* Oldest record kept: the pre-trigger share, or whatever the ring holds */
+    uint32_t oldest = w > LOGIC_RECORDS ? w - LOGIC_RECORDS : 0;
+    if (triggered) {
+        uint32_t pre = trig_w < LOGIC_PRE_RECORDS ? trig_w : LOGIC_PRE_RECORDS;
+        oldest = trig_w - pre;
+    }
+
+    first = oldest & RING_MASK;
+    result.samples = n + 1;
+    result.records = w - oldest;
+    result.changes = w;
+    result.ticks = now - start;
+    result.triggered = triggered;
+    result.trigger_record = trig_w - oldest;
+    result.aborted = abort_req != 0;
+
+    atomic_store_rel(&state, STATE_DONE);
+    sev();
+}
+
+/*
+ * logic_default_config - The capture 'l' runs (see LOGIC_MASK0)
+ */
+void logic_default_config(logic_config_t *cfg) {
+    cfg->mask[0] = LOGIC_MASK0;
+    cfg->mask[1] = LOGIC_MASK1;
+    cfg->trigger = LOGIC_TRIG_FALLING;
+    cfg->trig_bank = GPIO_BANK(ACT_LED_PIN);
+    cfg->trig_mask = GPIO_BIT(ACT_LED_PIN);
+    cfg->trig_value = 0;
+    cfg->window_ms = LOGIC_DEFAULT_WINDOW_MS;
+    cfg->timeout_ms = LOGIC_DEFAULT_TIMEOUT_MS;
+}
+
+/* Validate, copy the config and hand the capture to LOGIC_CORE */
+static bool begin(const logic_config_t *cfg) {
+    if (cfg->trig_bank > 1 || cfg->window_ms == 0 ||
+        cfg->window_ms > LOGIC_MAX_MS || cfg->timeout_ms > LOGIC_MAX_MS) {
+        return false;
+    }
+
+    config = *cfg;
+    config.mask[1] &= (1u << (GPIO_NUM_PINS - 32)) - 1;
+    config.mask[config.trig_bank] |= config.trig_mask;
+    abort_req = 0;
+
+    atomic_store_rel(&state, STATE_CAPTURING);
+    if (!smp_run(LOGIC_CORE, capture, NULL)) {
+        state = STATE_IDLE;
+        return false;
+    }
+    return true;
+}
+
+/* Screen shown while LOGIC_CORE samples */
+static void draw_capturing(void) {
+    fb_clear(BG_COLOR);
+    fb_draw_string(VIEW_X, VIEW_Y, "=== LOGIC ANALYZER ===", FG_COLOR, BG_COLOR);
+    fb_printf(VIEW_X, VIEW_Y + 2 * VIEW_LINE, FG_COLOR, BG_COLOR,
+              "Sampling on core %u, %s (up to %u ms)  -  l: stop", LOGIC_CORE,
+              config.trigger == LOGIC_TRIG_NONE ? "no trigger" : "waiting for trigger",
+              config.timeout_ms + config.window_ms);
+}
+
+/*
+ * logic_start - Begin a capture on LOGIC_CORE (non-blocking)
+ * @cfg: Pins, trigger and timing; copied
+ * Returns: false if busy, the config is invalid or LOGIC_CORE is offline
+ *
+ * Takes over the screen; logic_fiber() draws the result when done.
+ */
+bool logic_start(const logic_config_t *cfg) {
+    if (logic_busy() || !begin(cfg)) {
+        return false;
+    }
+    draw_capturing();
+    return true;
+}
+
+/*
+ * logic_capture - Capture and wait for the result, without drawing
+ * Returns: false if a capture is running or could not start
+ *
+ * For benchmarks; an open waveform view stays open.
+ */
+bool logic_capture(const logic_config_t *cfg) {
+    uint32_t was = state;
+
+    if (logic_busy() || !begin(cfg)) {
+        return false;
+    }
+    smp_wait(LOGIC_CORE);
+    state = was;
+    return true;
+}
+
+/*
+ * logic_abort - Stop the running capture early; what it has is kept
+ */
+void logic_abort(void) {
+    atomic_store_rel(&abort_req, 1);
+}
+
+/*
+ * logic_busy - Whether a capture is running or not yet picked up
+ */
+bool logic_busy(void) {
+    uint32_t s = atomic_load_acq(&state);
+    return s == STATE_CAPTURING || s == STATE_DONE;
+}
+
+/*
+ * logic_active - Whether the analyzer owns the screen
+ */
+bool logic_active(void) {
+    return state != STATE_IDLE;
+}
+
+/*
+ * logic_close - Leave the analyzer; the caller redraws its own screen
+ */
+void logic_close(void) {
+    if (logic_busy()) {
+        logic_abort();
+        smp_wait(LOGIC_CORE);
+    }
+    state = STATE_IDLE;
+}
+
+/*
+ * logic_result - Summary of the last capture
+ */
+const logic_result_t *logic_result(void) {
+    return &result;
+}
+
+/*
+ * logic_record - Record i (0..records-1) of the last capture, oldest first
+ */
+const logic_record_t *logic_record(uint32_t i) {
+    return &ring[(first + i) & RING_MASK];
+}
+
+/*
+ * logic_sample_rate - Sustained samples per second of the last capture
+ */
+uint64_t logic_sample_rate(void) {
+    return result.ticks ? (uint64_t)result.samples * timer_freq() / result.ticks : 0;
+}
+
+/*
+ * logic_report - Print the last capture's rate and compression over serial
+ */
+void logic_report(void) {
+    uint64_t rate = logic_sample_rate();
+    uint32_t banks = config.mask[1] ? 2 : 1;
+
+    kprintf("Logic: %u samples in %lu us = %lu.%02lu MS/s sustained (%u bank%s per sample)\n",
+            result.samples, timer_ticks_to_us(result.ticks), rate / 1000000,
+            (rate % 1000000) / 10000, banks, banks > 1 ? "s" : "");
+    kprintf("Logic: %u changes, %u kept, %u:1 run-length compression\n", result.changes,
+            result.records, result.records ? result.samples / result.records : 0);
+    if (!result.triggered) {
+        kprintf("Logic: no trigger within %u ms\n", config.timeout_ms);
+    } else if (config.trigger != LOGIC_TRIG_NONE) {
+        kprintf("Logic: triggered at %lu us\n",
+                timer_ticks_to_us(logic_record(result.trigger_record)->ticks));
+    }
+    if (result.aborted) {
+        kprintf("Logic: stopped early\n");
+    }
+}
+
+/* Time axis label, relative to the trigger when there is one */
+static void axis_label(int32_t x, int32_t y, int64_t us) {
+    uint64_t mag = us < 0 ? -us : us;
+
+    if (mag >= 10000) {
+        fb_printf(x, y, FG_COLOR, BG_COLOR, "%s%lu ms", us < 0 ? "-" : "", mag / 1000);
+    } else {
+        fb_printf(x, y, FG_COLOR, BG_COLOR, "%s%lu us", us < 0 ? "-" : "", mag);
+    }
+}
+
+/*
+ * logic_draw - Draw the last capture full screen, one lane per pin
+ *
+ * Walks the records once; only the pins that changed in a record end
+ * their current level segment and draw an edge.
+ */
+void logic_draw(void) {
+    static uint8_t lane_of[GPIO_NUM_PINS];
+    static int32_t seg_x[GPIO_NUM_PINS];
+    gfx_surface_t screen;
+    uint32_t lanes = 0;
+
+    gfx_screen(&screen);
+    fb_clear(BG_COLOR);
+    fb_draw_string(VIEW_X, VIEW_Y, "=== LOGIC ANALYZER ===", FG_COLOR, BG_COLOR);
+
+    uint64_t rate = logic_sample_rate();
+    fb_printf(VIEW_X, VIEW_Y + 2 * VIEW_LINE, FG_COLOR, BG_COLOR,
+              "%lu.%02lu MS/s on core %u, %u samples, %u changes kept (%u:1)",
+              rate / 1000000, (rate % 1000000) / 10000, LOGIC_CORE, result.samples,
+              result.records, result.records ? result.samples / result.records : 0);
+    fb_draw_string(VIEW_X, VIEW_Y + 3 * VIEW_LINE,
+                   !result.triggered ? "No trigger - latest changes shown  -  l: back" :
+                   "l: back", FG_COLOR, BG_COLOR);
+
+    if (result.records == 0) {
+        return;
+    }
+
+    for (uint32_t pin = 0; pin < GPIO_NUM_PINS; pin++) {
+        if (config.mask[GPIO_BANK(pin)] & GPIO_BIT(pin)) {
+            lane_of[pin] = lanes++;
+        }
+    }
+    if (lanes == 0) {
+        return;
+    }
+
+    int32_t lane_h = (WAVE_BOTTOM - WAVE_Y) / lanes;
+    if (lane_h > LANE_MAX_H) {
+        lane_h = LANE_MAX_H;
+    }
+    int32_t wave_w = screen.width - WAVE_X - VIEW_X;
+    uint32_t hi = gfx_pixel(FG_COLOR);
+    uint32_t lo = gfx_pixel(DIM_COLOR);
+
+    /* Time span: first kept change to the end of sampling */
+    const logic_record_t *r = logic_record(0);
+    uint64_t t0 = r->ticks;
+    uint64_t span = result.ticks > t0 ? result.ticks - t0 : 1;
+    uint32_t level[2] = { r->level[0], r->level[1] };
+
+    for (uint32_t pin = 0; pin < GPIO_NUM_PINS; pin++) {
+        if (config.mask[GPIO_BANK(pin)] & GPIO_BIT(pin)) {
+            int32_t y = WAVE_Y + lane_of[pin] * lane_h;
+            if (lane_h >= FONT_HEIGHT) {
+                fb_printf(VIEW_X, y + (lane_h - FONT_HEIGHT) / 2, FG_COLOR, BG_COLOR,
+                          "GP%u", pin);
+            }
+            seg_x[pin] = WAVE_X;
+        }
+    }
+
+    /* Level segments end and edges are drawn where a pin changes */
+    for (uint32_t i = 1; i <= result.records; i++) {
+        int32_t x = WAVE_X + wave_w;
+        uint32_t now[2] = { level[0], level[1] };
+
+        if (i < result.records) {
+            r = logic_record(i);
+            x = WAVE_X + (int32_t)((r->ticks - t0) * wave_w / span);
+            now[0] = r->level[0];
+            now[1] = r->level[1];
+        }
+
+        for (uint32_t bank = 0; bank < 2; bank++) {
+            uint32_t diff = i < result.records ? level[bank] ^ now[bank] : config.mask[bank];
+            while (diff) {
+                uint32_t pin = bank * 32 + __builtin_ctz(diff);
+                int32_t top = WAVE_Y + lane_of[pin] * lane_h + 2;
+                int32_t bottom = top + lane_h - 5;
+                bool high = level[bank] & (1u << (pin & 31));
+
+                gfx_hspan(&screen, seg_x[pin], x, high ? top : bottom, high ? hi : lo);
+                if (i < result.records) {
+                    gfx_line(&screen, x, top, x, bottom, FG_COLOR);
+                }
+                seg_x[pin] = x;
+                diff &= diff - 1;
+            }
+        }
+        level[0] = now[0];
+        level[1] = now[1];
+    }
+
+    /* Trigger marker and time axis */
+    int32_t axis_y = WAVE_Y + lanes * lane_h + 4;
+    uint64_t t_trig = t0;
+    if (result.triggered) {
+        t_trig = logic_record(result.trigger_record)->ticks;
+        int32_t x = WAVE_X + (int32_t)((t_trig - t0) * wave_w / span);
+        gfx_line(&screen, x, WAVE_Y, x, axis_y, TRIG_COLOR);
+    }
+    gfx_hspan(&screen, WAVE_X, WAVE_X + wave_w, axis_y, hi);
+    for (uint32_t d = 0; d <= AXIS_DIVS; d++) {
+        int32_t x = WAVE_X + wave_w * d / AXIS_DIVS;
+        uint64_t t = t0 + span * d / AXIS_DIVS;
+
+        gfx_line(&screen, x, axis_y, x, axis_y + 4, FG_COLOR);
+        if (d < AXIS_DIVS) {
+            axis_label(x, axis_y + 8, t >= t_trig ? (int64_t)timer_ticks_to_us(t - t_trig) :
+                       -(int64_t)timer_ticks_to_us(t_trig - t));
+        }
+    }
+}
+
+static bool capture_done(void *arg) {
+    return atomic_load_acq(&state) == STATE_DONE;
+}
+
+/*
+ * logic_fiber - Report and draw each capture logic_start() began
+ */
+void logic_fiber(void *arg) {
+    while (1) {
+        fiber_wait_until(capture_done, NULL);
+        logic_report();
+        logic_draw();
+        state = STATE_VIEW;
+    }
+}
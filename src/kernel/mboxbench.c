@@ -0,0 +1,97 @@
+/*
+ * mboxbench.c - Mailbox Property Cache
+ *
+ * Times single-tag property requests with the cache off (every request
+ * is a firmware round trip) and on, for an immutable tag (board
+ * revision) and a TTL tag (ARM clock rate), and reports the cache's
+ * hit rate, both for the queries made since boot and for this run.
+ * Then checks that a set tag drops the cached get: SET_CLOCK_RATE to
+ * the current ARM rate must invalidate GET_CLOCK_RATE so the next get
+ * misses.
+ */
+
+#include "bench.h"
+#include "mailbox.h"
+#include "kprintf.h"
+#include "timer.h"
+
+#define MBOX_ROUNDS     2000
+
+/* Hit rate and counters as a bench_note line */
+static void note_stats(const char *name, const mailbox_cache_stats_t *s) {
+    char line[96];
+    uint64_t lookups = s->hits + s->misses;
+    uint64_t rate = lookups ? s->hits * 1000 / lookups : 0;
+
+    kformat(line, sizeof(line), "%lu hits, %lu misses (%lu.%lu%%), %lu uncached, %lu dropped",
+            s->hits, s->misses, rate / 10, rate % 10, s->uncached, s->invalidations);
+    bench_note(name, line);
+}
+
+/* MBOX_ROUNDS requests for one tag, returns elapsed ticks */
+static uint64_t query_rounds(uint32_t tag, uint32_t id) {
+    uint64_t t0 = timer_ticks();
+
+    for (uint32_t i = 0; i < MBOX_ROUNDS; i++) {
+        uint32_t values[2] = { id, 0 };
+        mailbox_property(tag, values, 2);
+    }
+    return timer_ticks() - t0;
+}
+
+/* SET_CLOCK_RATE (same rate) between two gets: the second must miss */
+static void check_set_invalidates(void) {
+    mailbox_cache_stats_t before, after;
+    uint32_t get[2] = { CLOCK_ID_ARM, 0 };
+
+    if (!mailbox_property(TAG_GET_CLOCK_RATE, get, 2)) {
+        bench_note("set drops get", "FAIL: no ARM clock rate");
+        return;
+    }
+    uint32_t set[3] = { CLOCK_ID_ARM, get[1], 0 };
+
+    mailbox_cache_get_stats(&before);
+    bool set_ok = mailbox_property(TAG_SET_CLOCK_RATE, set, 3);
+    get[1] = 0;
+    mailbox_property(TAG_GET_CLOCK_RATE, get, 2);
+    mailbox_cache_get_stats(&after);
+
+    if (!set_ok) {
+        bench_note("set drops get", "FAIL: SET_CLOCK_RATE refused");
+    } else if (after.invalidations == before.invalidations || after.misses != before.misses + 1) {
+        bench_note("set drops get", "FAIL: GET_CLOCK_RATE still cached after SET_CLOCK_RATE");
+    } else {
+        bench_note("set drops get", "ok");
+    }
+}
+
+/*
+ * mboxbench_run - Compare cached and uncached property requests
+ */
+void mboxbench_run(void) {
+    mailbox_cache_stats_t boot, before, after;
+
+    bench_header("mailbox cache");
+    mailbox_cache_get_stats(&boot);
+    note_stats("since boot", &boot);
+
+    mailbox_cache_enable(false);
+    bench_result("board rev (firmware)", 1, MBOX_ROUNDS, query_rounds(TAG_GET_BOARD_REV, 0));
+    bench_result("ARM clock (firmware)", 1, MBOX_ROUNDS,
+                 query_rounds(TAG_GET_CLOCK_RATE, CLOCK_ID_ARM));
+    mailbox_cache_enable(true);
+
+    mailbox_cache_get_stats(&before);
+    bench_result("board rev (cached)", 1, MBOX_ROUNDS, query_rounds(TAG_GET_BOARD_REV, 0));
+    bench_result("ARM clock (10 ms TTL)", 1, MBOX_ROUNDS,
+                 query_rounds(TAG_GET_CLOCK_RATE, CLOCK_ID_ARM));
+    mailbox_cache_get_stats(&after);
+
+    after.hits -= before.hits;
+    after.misses -= before.misses;
+    after.uncached -= before.uncached;
+    after.invalidations -= before.invalidations;
+    note_stats("this run (cached)", &after);
+
+    check_set_invalidates();
+}
@@ -0,0 +1,224 @@
+/*
+ * membench.c - Memory Bandwidth (STREAM-style)
+ *
+ * The four STREAM kernels plus a pure write, over three arrays of
+ * 64-bit words, split evenly across 1-4 cores:
+ *   copy   c = a           16 bytes per element
+ *   scale  b = k * c       16
+ *   add    c = a + b       24
+ *   triad  a = b + k * c   24
+ *   write  a = v            8
+ * Working sets (all three arrays) are sized for L1 (32 KB per core),
+ * the shared 512 KB L2 and DRAM, in free RAM above the kernel image;
+ * then the same arrays inside the framebuffer (non-cacheable, as the
+ * ARM sees VideoCore memory), and a RAM to framebuffer copy, the path
+ * of every blit. Each figure is the best of BENCH_TRIALS passes.
+ *
+ * The kernels are integer: the kernel is built -mgeneral-regs-only,
+ * and bandwidth does not depend on the element type. The screen is
+ * saved to scratch RAM first and restored afterwards.
+ */
+
+#include "bench.h"
+#include "sync.h"
+#include "smp.h"
+#include "timer.h"
+#include "string.h"
+#include "kprintf.h"
+#include "sysinfo.h"
+#include "framebuffer.h"
+
+#define BENCH_TRIALS    3
+
+/* Bytes moved per measurement, per trial (repetitions are rounded) */
+#define RAM_TARGET      (64u * 1024 * 1024)
+#define FB_TARGET       (4u * 1024 * 1024)
+
+/* Scratch arrays start at the first 2 MB boundary above the image */
+#define SCRATCH_ALIGN   (2u * 1024 * 1024)
+#define DRAM_ARRAY      (8u * 1024 * 1024)
+
+#define SCALAR          3
+
+extern char __end[];
+
+typedef enum {
+    K_COPY,
+    K_SCALE,
+    K_ADD,
+    K_TRIAD,
+    K_WRITE,
+    K_COUNT
+} kernel_t;
+
+static const struct {
+    const char *name;
+    uint32_t bytes;             /* Per element */
+} kernels[K_COUNT] = {
+    { "copy", 16 },
+    { "scale", 16 },
+    { "add", 24 },
+    { "triad", 24 },
+    { "write", 8 },
+};
+
+/* One measurement, shared with the cores running it */
+typedef struct {
+    kernel_t kernel;
+    uint64_t *a;
+    uint64_t *b;
+    uint64_t *c;
+    uint64_t n;                 /* Elements per array */
+    uint32_t reps;
+    uint32_t cores;
+    uint64_t best;              /* Ticks, written by core 0 */
+} job_t;
+
+static job_t job;
+static barrier_t bar;
+
+static void run_kernel(kernel_t k, uint64_t *restrict a, uint64_t *restrict b,
+                       uint64_t *restrict c, uint64_t lo, uint64_t hi) {
+    switch (k) {
+    case K_COPY:
+        for (uint64_t i = lo; i < hi; i++) {
+            c[i] = a[i];
+        }
+        break;
+    case K_SCALE:
+        for (uint64_t i = lo; i < hi; i++) {
+            b[i] = SCALAR * c[i];
+        }
+        break;
+    case K_ADD:
+        for (uint64_t i = lo; i < hi; i++) {
+            c[i] = a[i] + b[i];
+        }
+        break;
+    case K_TRIAD:
+        for (uint64_t i = lo; i < hi; i++) {
+            a[i] = b[i] + SCALAR * c[i];
+        }
+        break;
+    default:
+        for (uint64_t i = lo; i < hi; i++) {
+            a[i] = i;
+        }
+        break;
+    }
+}
+
+/* Runs on cores 0..cores-1, each over its slice; core 0 times it */
+static void worker(void *arg) {
+    uint32_t core = smp_core_id();
+    uint64_t lo = job.n * core / job.cores;
+    uint64_t hi = job.n * (core + 1) / job.cores;
+
+    for (uint32_t trial = 0; trial < BENCH_TRIALS; trial++) {
+        barrier_wait(&bar);
+        uint64_t t0 = timer_ticks();
+        for (uint32_t r = 0; r < job.reps; r++) {
+            run_kernel(job.kernel, job.a, job.b, job.c, lo, hi);
+        }
+        barrier_wait(&bar);
+        if (core == 0) {
+            uint64_t t = timer_ticks() - t0;
+            if (t < job.best) {
+                job.best = t;
+            }
+        }
+    }
+}
+
+/* Best-trial bandwidth in hundredths of GB/s */
+static uint64_t measure(kernel_t k, uint32_t cores, uint64_t target) {
+    uint64_t per_rep = job.n * kernels[k].bytes;
+
+    job.kernel = k;
+    job.cores = cores;
+    job.reps = per_rep < target ? target / per_rep : 1;
+    job.best = ~0ull;
+    barrier_init(&bar, cores);
+    dsb(sy);
+
+    smp_run_on(cores, worker, NULL);
+
+    uint64_t ns = job.best * 1000000000 / timer_freq();
+    return ns ? per_rep * job.reps * 100 / ns : 0;
+}
+
+/* One line per core count: the given kernels in GB/s */
+static void report_set(const char *label, uint64_t *a, uint64_t *b, uint64_t *c,
+                       uint64_t bytes, uint64_t target, kernel_t first, kernel_t last) {
+    char name[32], line[96];
+
+    job.a = a;
+    job.b = b;
+    job.c = c;
+    job.n = bytes / sizeof(uint64_t);
+
+    for (uint32_t cores = 1; cores <= smp_online_cores(); cores++) {
+        size_t len = 0;
+
+        kformat(name, sizeof(name), "%s x%u", label, cores);
+        for (kernel_t k = first; k <= last; k++) {
+            uint64_t gbs = measure(k, cores, target);
+            len += kformat(line + len, sizeof(line) - len, "%s %lu.%02lu  ", kernels[k].name,
+                           gbs / 100, gbs % 100);
+        }
+        kformat(line + len, sizeof(line) - len, "GB/s");
+        bench_note(name, line);
+    }
+}
+
+/*
+ * membench_run - Bandwidth per cache tier, DRAM and framebuffer
+ */
+void membench_run(void) {
+    static const struct {
+        const char *label;
+        uint32_t array;         /* Bytes per array */
+    } tiers[] = {
+        { "L1 24 KB", 8 * 1024 },
+        { "L2 384 KB", 128 * 1024 },
+        { "DRAM 24 MB", DRAM_ARRAY },
+    };
+    framebuffer_t *fb = fb_get_info();
+    sysinfo_t info;
+    char line[64];
+
+    bench_header("memory bandwidth");
+
+    sysinfo_init(&info);
+    kformat(line, sizeof(line), "%u MHz (sysinfo_t.sdram_clock)", info.sdram_clock / 1000000);
+    bench_note("SDRAM clock", line);
+
+    uint64_t scratch = ((uint64_t)__end + SCRATCH_ALIGN - 1) & ~(uint64_t)(SCRATCH_ALIGN - 1);
+    uint64_t fb_save = scratch + 3 * DRAM_ARRAY;
+    if (fb_save + fb->size > info.arm_mem_size) {
+        bench_note("", "skipped, not enough free RAM above the image");
+        return;
+    }
+
+    uint64_t *ram = (uint64_t *)scratch;
+    for (uint32_t t = 0; t < sizeof(tiers) / sizeof(tiers[0]); t++) {
+        uint64_t words = tiers[t].array / sizeof(uint64_t);
+        report_set(tiers[t].label, ram, ram + words, ram + 2 * words, tiers[t].array,
+                   RAM_TARGET, K_COPY, K_WRITE);
+    }
+
+    if (fb->buffer == NULL || fb->size == 0) {
+        return;
+    }
+
+    /* Three arrays inside the framebuffer; the screen comes back after */
+    uint32_t array = (fb->size / 3) & ~63u;
+    uint64_t *fbw = (uint64_t *)fb->buffer;
+    uint64_t words = array / sizeof(uint64_t);
+
+    memcpy((void *)fb_save, fb->buffer, fb->size);
+    kformat(line, sizeof(line), "FB %u KB", 3 * array / 1024);
+    report_set(line, fbw, fbw + words, fbw + 2 * words, array, FB_TARGET, K_COPY, K_WRITE);
+    report_set("RAM->FB", ram, NULL, fbw, array, FB_TARGET, K_COPY, K_COPY);
+    memcpy(fb->buffer, (const void *)fb_save, fb->size);
+}
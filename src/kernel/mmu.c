@@ -0,0 +1,249 @@
+/*
+ * mmu.c - EL2 Identity Map and Caches
+ *
+ * Translation starts at level 1 (T0SZ = 32, 4 GB): entry 0 points at
+ * one level-2 table of 2 MB blocks for the first GB, entry 1 is a 1 GB
+ * device block for the ARM local peripherals. Blocks that need finer
+ * attributes are split into level-3 tables from a small static pool.
+ *
+ * The blocks holding the kernel image are split up front, so later
+ * per-page changes (e.g. unmapping a guard page) never have to break
+ * a live block the CPU is executing from.
+ */
+
+#include "mmu.h"
+#include "mailbox.h"
+#include "gpio.h"
+#include "sync.h"
+
+/* Level-3 tables available for splitting 2 MB blocks */
+#define MMU_L3_TABLES       8
+
+#define LOCAL_PERIPH_BASE   0x40000000
+#define GB                  0x40000000
+
+/* Descriptor bits */
+#define DESC_VALID          (1ul << 0)
+#define DESC_TABLE          (3ul << 0)      /* Level 1/2 table, level 3 page */
+#define DESC_BLOCK          (1ul << 0)      /* Level 1/2 block */
+#define DESC_ATTR(idx)      ((uint64_t)(idx) << 2)
+#define DESC_SH_INNER       (3ul << 8)
+#define DESC_AF             (1ul << 10)
+#define DESC_XN             (1ul << 54)
+#define DESC_ADDR_MASK      0x0000FFFFFFFFF000ul
+
+/* MAIR_EL2: attribute per MMU_* index */
+#define MAIR_VALUE          ((0x00ul << (8 * MMU_DEVICE)) |     \
+                             (0x44ul << (8 * MMU_NORMAL_NC)) |  \
+                             (0xFFul << (8 * MMU_NORMAL)))
+
+/* TCR_EL2: T0SZ=32, walks write-back cacheable inner shareable, 4 KB, 32-bit PA */
+#define TCR_VALUE           (32 | (1 << 8) | (1 << 10) | (3 << 12) | (1 << 23) | (1u << 31))
+
+#define SCTLR_M             (1 << 0)
+#define SCTLR_C             (1 << 2)
+#define SCTLR_I             (1 << 12)
+
+/* From linker.ld */
+extern char __dma_start[], __dma_end[], __end[];
+
+static uint64_t l1_table[512] __attribute__((aligned(4096)));
+static uint64_t l2_table[512] __attribute__((aligned(4096)));
+static uint64_t l3_pool[MMU_L3_TABLES][512] __attribute__((aligned(4096)));
+static uint32_t l3_used;
+
+/* Read by cores 1-3 before their MMU is on: written while core 0's is off */
+static volatile bool mmu_on;
+
+static inline uint32_t current_el(void) {
+    uint64_t el;
+    asm volatile("mrs %0, CurrentEL" : "=r"(el));
+    return (el >> 2) & 3;
+}
+
+static uint64_t make_desc(uint64_t pa, uint32_t type, uint64_t kind) {
+    if (type == MMU_UNMAPPED) {
+        return 0;
+    }
+    uint64_t desc = pa | kind | DESC_ATTR(type) | DESC_SH_INNER | DESC_AF;
+    if (type != MMU_NORMAL) {
+        desc |= DESC_XN;
+    }
+    return desc;
+}
+
+/*
+ * set_entry - Replace a live descriptor (break-before-make)
+ * @entry: Descriptor to change
+ * @desc: New value
+ * @va: Address it translates (for the TLB invalidate)
+ */
+static void set_entry(uint64_t *entry, uint64_t desc, uint64_t va) {
+    if (mmu_on && (*entry & DESC_VALID)) {
+        *entry = 0;
+        dsb(ishst);
+        asm volatile("tlbi vae2is, %0" :: "r"(va >> 12) : "memory");
+        dsb(ish);
+    }
+    *entry = desc;
+    dsb(ishst);
+}
+
+/*
+ * split_block - Turn a level-2 entry into a table of 4 KB pages
+ * @entry: Level-2 descriptor for the block containing @va
+ * @va: Any address in the block
+ * Returns: The level-3 table, NULL if the pool is exhausted
+ *
+ * The pages inherit the block's attributes (or stay unmapped).
+ */
+static uint64_t *split_block(uint64_t *entry, uint64_t va) {
+    if ((*entry & DESC_TABLE) == DESC_TABLE) {
+        return (uint64_t *)(*entry & DESC_ADDR_MASK);
+    }
+    if (l3_used >= MMU_L3_TABLES) {
+        return NULL;
+    }
+
+    uint64_t *l3 = l3_pool[l3_used++];
+    uint64_t block = va & ~(uint64_t)(MMU_BLOCK_SIZE - 1);
+    uint64_t attrs = (*entry & DESC_VALID) ? (*entry & ~DESC_ADDR_MASK & ~3ul) : 0;
+
+    for (uint32_t i = 0; i < 512; i++) {
+        l3[i] = attrs ? (block + i * MMU_PAGE_SIZE) | attrs | DESC_TABLE : 0;
+    }
+    set_entry(entry, (uint64_t)l3 | DESC_TABLE, block);
+    return l3;
+}
+
+/*
+ * mmu_map_range - Set the memory type of an identity-mapped range
+ * @base: Start (4 KB aligned)
+ * @size: Bytes (rounded up to 4 KB)
+ * @type: MMU_DEVICE, MMU_NORMAL_NC, MMU_NORMAL or MMU_UNMAPPED
+ * Returns: false if the range is outside the first GB or no level-3
+ *          table is left to split a block
+ *
+ * Safe with the MMU on, except for the range the caller is running
+ * from or using as stack.
+ */
+bool mmu_map_range(uint64_t base, uint64_t size, uint32_t type) {
+    uint64_t addr = base & ~(uint64_t)(MMU_PAGE_SIZE - 1);
+    uint64_t end = (base + size + MMU_PAGE_SIZE - 1) & ~(uint64_t)(MMU_PAGE_SIZE - 1);
+
+    if (end > GB) {
+        return false;
+    }
+
+    while (addr < end) {
+        uint64_t *entry = &l2_table[addr / MMU_BLOCK_SIZE];
+        bool whole = (addr & (MMU_BLOCK_SIZE - 1)) == 0 && end - addr >= MMU_BLOCK_SIZE;
+
+        if (whole && (*entry & DESC_TABLE) != DESC_TABLE) {
+            set_entry(entry, make_desc(addr, type, DESC_BLOCK), addr);
+            addr += MMU_BLOCK_SIZE;
+            continue;
+        }
+
+        uint64_t *l3 = split_block(entry, addr);
+        if (!l3) {
+            return false;
+        }
+        set_entry(&l3[(addr / MMU_PAGE_SIZE) & 511], make_desc(addr, type, DESC_TABLE), addr);
+        addr += MMU_PAGE_SIZE;
+    }
+
+    if (mmu_on) {
+        asm volatile("tlbi alle2is" ::: "memory");
+        dsb(ish);
+        isb();
+    }
+    return true;
+}
+
+/*
+ * mmu_enable_core - Load the tables and turn on MMU and caches (this core)
+ */
+static void mmu_enable_core(void) {
+    uint64_t sctlr;
+
+    asm volatile("msr mair_el2, %0" :: "r"(MAIR_VALUE));
+    asm volatile("msr tcr_el2, %0" :: "r"((uint64_t)TCR_VALUE));
+    asm volatile("msr ttbr0_el2, %0" :: "r"((uint64_t)l1_table));
+    isb();
+    asm volatile("tlbi alle2" ::: "memory");
+    dsb(ish);
+    asm volatile("ic iallu" ::: "memory");
+    dsb(ish);
+    isb();
+
+    asm volatile("mrs %0, sctlr_el2" : "=r"(sctlr));
+    sctlr |= SCTLR_M | SCTLR_C | SCTLR_I;
+    asm volatile("msr sctlr_el2, %0" :: "r"(sctlr) : "memory");
+    isb();
+}
+
+/*
+ * mmu_init - Build the identity map and enable MMU and caches on core 0
+ * Returns: false (MMU left off) if not at EL2 or the ARM memory size
+ *          is unavailable
+ *
+ * Must run before the secondary cores are released and before anything
+ * takes a spinlock; the memory size comes from the unlocked early query.
+ */
+bool mmu_init(void) {
+    uint32_t mem[2];
+
+#ifdef NO_MMU
+    return false;
+#endif
+
+    if (current_el() != 2 || !mailbox_property_early(TAG_GET_ARM_MEMORY, mem, 2) || mem[1] == 0) {
+        return false;
+    }
+
+    uint64_t arm_end = (uint64_t)mem[0] + mem[1];
+    if (arm_end > PERIPHERAL_BASE) {
+        arm_end = PERIPHERAL_BASE;
+    }
+
+    l1_table[0] = (uint64_t)l2_table | DESC_TABLE;
+    l1_table[1] = make_desc(LOCAL_PERIPH_BASE, MMU_DEVICE, DESC_BLOCK);
+
+    mmu_map_range(0, arm_end, MMU_NORMAL);
+    mmu_map_range(arm_end, PERIPHERAL_BASE - arm_end, MMU_NORMAL_NC);
+    mmu_map_range(PERIPHERAL_BASE, GB - PERIPHERAL_BASE, MMU_DEVICE);
+
+    /* Kernel image at page granularity, then the .dma pages */
+    for (uint64_t addr = 0; addr < (uint64_t)__end; addr += MMU_BLOCK_SIZE) {
+        split_block(&l2_table[addr / MMU_BLOCK_SIZE], addr);
+    }
+    uint64_t dma_size = (uint64_t)__dma_end - (uint64_t)__dma_start;
+    if (dma_size && !mmu_map_range((uint64_t)__dma_start, dma_size, MMU_NORMAL_NC)) {
+        return false;
+    }
+
+    /* Tables were written with the MMU off, so they are already in memory */
+    mmu_on = true;
+    mmu_enable_core();
+    return true;
+}
+
+/*
+ * mmu_enable_secondary - Turn on core 0's map on this core (from boot.S)
+ *
+ * Runs before anything else touches memory: with its MMU off the core
+ * would not see data core 0 holds in its cache.
+ */
+void mmu_enable_secondary(void) {
+    if (mmu_on) {
+        mmu_enable_core();
+    }
+}
+
+/*
+ * mmu_enabled - Whether mmu_init() turned on the MMU and caches
+ */
+bool mmu_enabled(void) {
+    return mmu_on;
+}
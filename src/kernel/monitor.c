@@ -0,0 +1,354 @@
+/*
+ * monitor.c - Live System Monitor Screen
+ *
+ * Every value on the screen is a field: its position and the text last
+ * drawn there. A frame formats each field into a scratch buffer and
+ * redraws only the character cells that differ from the cached text,
+ * plus the tail when the new text is shorter. Utilization bars are
+ * cached the same way, by filled width. A steady system therefore
+ * costs almost no framebuffer stores per frame.
+ */
+
+#include "monitor.h"
+#include "framebuffer.h"
+#include "font8x8.h"
+#include "gfx.h"
+#include "kprintf.h"
+#include "string.h"
+#include "cpustat.h"
+#include "mailbox.h"
+#include "telemetry.h"
+#include "fiber.h"
+#include "frame.h"
+#include "smp.h"
+#include "timer.h"
+#include "stack.h"
+
+/* Colors and layout, matching the spec sheet */
+#define FG_COLOR        COLOR_TERM_GREEN
+#define BG_COLOR        COLOR_BLACK
+#define DIM_COLOR       (color_t){0x10, 0x40, 0x10, 0xFF}
+
+#define MON_X           40
+#define MON_Y           40
+#define MON_VALUE_X     (MON_X + 160)
+#define MON_LINE        12
+#define MON_SECTION     24
+#define MON_BAR_X       MON_VALUE_X
+#define MON_BAR_W       256
+#define MON_BAR_H       8
+#define MON_CORE_TEXT_X (MON_BAR_X + MON_BAR_W + 16)
+
+#define FIELD_MAX       64
+
+extern char _start[], __bss_start[], __bss_end[];
+extern char __dma_start[], __dma_end[], __stacks_start[], __stacks_end[], __end[];
+
+/* Fields, in screen order */
+enum {
+    FIELD_CORE0,
+    FIELD_MBOX_RATE = FIELD_CORE0 + NUM_CORES,
+    FIELD_MBOX_LATENCY,
+    FIELD_FRAME,
+    FIELD_PACING,
+    FIELD_CLOCK,
+    FIELD_FIBERS,
+    FIELD_MEM_IMAGE,
+    FIELD_MEM_BSS,
+    FIELD_MEM_DMA,
+    FIELD_MEM_STACKS,
+    FIELD_MEM_STACK_PEAK,
+    FIELD_MEM_FREE,
+    FIELD_COUNT
+};
+
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    char shown[FIELD_MAX];
+} field_t;
+
+/* Counter values at the previous frame, for rates */
+typedef struct {
+    uint64_t ticks;
+    uint64_t idle[NUM_CORES];
+    uint64_t wakeups[NUM_CORES];
+    uint64_t mbox_calls;
+} mon_prev_t;
+
+static field_t fields[FIELD_COUNT];
+static uint32_t bar_shown[NUM_CORES];
+static mon_prev_t prev;
+static bool active;
+static uint32_t period_ms = MONITOR_PERIOD_MS;
+static uint64_t last_frame_ticks;
+static uint64_t due_us;
+static uint32_t arm_mem_size;
+static gfx_surface_t screen;
+
+/* Redraw the character cells of a field whose text changed */
+static void field_set(uint32_t id, const char *text) {
+    field_t *f = &fields[id];
+    uint32_t old_len = strlen(f->shown);
+    uint32_t len = 0;
+
+    for (; text[len] && len < FIELD_MAX - 1; len++) {
+        if (len >= old_len || f->shown[len] != text[len]) {
+            fb_draw_char(f->x + len * FONT_WIDTH, f->y, text[len], FG_COLOR, BG_COLOR);
+            f->shown[len] = text[len];
+        }
+    }
+
+    /* Blank the tail of a longer previous value */
+    if (old_len > len) {
+        fb_fill_rect(f->x + len * FONT_WIDTH, f->y, (old_len - len) * FONT_WIDTH, FONT_HEIGHT,
+                     BG_COLOR);
+    }
+    f->shown[len] = '\0';
+}
+
+/* Format and set a field */
+static void __attribute__((format(printf, 2, 3))) field_printf(uint32_t id, const char *fmt, ...) {
+    char buffer[FIELD_MAX];
+    va_list ap;
+
+    va_start(ap, fmt);
+    kvformat(buffer, sizeof(buffer), fmt, ap);
+    va_end(ap);
+    field_set(id, buffer);
+}
+
+/* Grow or shrink a utilization bar by the changed segment only */
+static void bar_set(uint32_t core, uint32_t y, uint32_t width) {
+    uint32_t old = bar_shown[core];
+
+    if (width > old) {
+        gfx_fill_rect(&screen, MON_BAR_X + old, y, width - old, MON_BAR_H, FG_COLOR);
+    } else if (width < old) {
+        gfx_fill_rect(&screen, MON_BAR_X + width, y, old - width, MON_BAR_H, DIM_COLOR);
+    }
+    bar_shown[core] = width;
+}
+
+/* Label at column MON_X + 8; places a field at the value column */
+static uint32_t label_field(uint32_t y, const char *label, uint32_t id, uint32_t x) {
+    fb_draw_string(MON_X + 8, y, label, FG_COLOR, BG_COLOR);
+    fields[id].x = x;
+    fields[id].y = y;
+    fields[id].shown[0] = '\0';
+    return y + MON_LINE;
+}
+
+static uint32_t section(uint32_t y, const char *title) {
+    fb_draw_string(MON_X, y, title, FG_COLOR, BG_COLOR);
+    return y + MON_LINE + 8;
+}
+
+static void snapshot_counters(mon_prev_t *p) {
+    mailbox_stats_t mbox;
+
+    p->ticks = timer_ticks();
+    for (uint32_t core = 0; core < NUM_CORES; core++) {
+        p->idle[core] = cpustat_idle_ticks(core);
+        p->wakeups[core] = cpustats[core].wakeups;
+    }
+    mailbox_get_stats(&mbox);
+    p->mbox_calls = mbox.calls;
+}
+
+/* Draw labels, empty bars and field positions */
+static void draw_layout(void) {
+    char label[16];
+    uint32_t y = MON_Y;
+
+    gfx_screen(&screen);
+    fb_clear(BG_COLOR);
+    fb_draw_string(MON_X, y, "=== SYSTEM MONITOR ===", FG_COLOR, BG_COLOR);
+    y += MON_SECTION;
+
+    y = section(y, "CPU (busy %, wakeups/s)");
+    for (uint32_t core = 0; core < NUM_CORES; core++) {
+        kformat(label, sizeof(label), "Core %u", core);
+        gfx_fill_rect(&screen, MON_BAR_X, y, MON_BAR_W, MON_BAR_H, DIM_COLOR);
+        bar_shown[core] = 0;
+        y = label_field(y, label, FIELD_CORE0 + core, MON_CORE_TEXT_X);
+    }
+    y += MON_SECTION - MON_LINE;
+
+    y = section(y, "MAILBOX");
+    y = label_field(y, "Calls:", FIELD_MBOX_RATE, MON_VALUE_X);
+    y = label_field(y, "Round trip:", FIELD_MBOX_LATENCY, MON_VALUE_X);
+    y += MON_SECTION - MON_LINE;
+
+    y = section(y, "SYSTEM");
+    y = label_field(y, "Frame:", FIELD_FRAME, MON_VALUE_X);
+    y = label_field(y, "Pacing:", FIELD_PACING, MON_VALUE_X);
+    y = label_field(y, "ARM:", FIELD_CLOCK, MON_VALUE_X);
+    y = label_field(y, "Fibers:", FIELD_FIBERS, MON_VALUE_X);
+    y += MON_SECTION - MON_LINE;
+
+    y = section(y, "MEMORY");
+    y = label_field(y, "Image:", FIELD_MEM_IMAGE, MON_VALUE_X);
+    y = label_field(y, "BSS:", FIELD_MEM_BSS, MON_VALUE_X);
+    y = label_field(y, "DMA:", FIELD_MEM_DMA, MON_VALUE_X);
+    y = label_field(y, "Stacks:", FIELD_MEM_STACKS, MON_VALUE_X);
+    y = label_field(y, "Stack peak:", FIELD_MEM_STACK_PEAK, MON_VALUE_X);
+    y = label_field(y, "Free:", FIELD_MEM_FREE, MON_VALUE_X);
+    y += MON_SECTION - MON_LINE;
+
+    fb_draw_string(MON_X, y, "m: back   +/-: refresh rate", FG_COLOR, BG_COLOR);
+}
+
+/* part / whole in tenths of a percent */
+static uint32_t tenths(uint64_t part, uint64_t whole) {
+    return whole ? (uint32_t)((part * 1000 + whole / 2) / whole) : 0;
+}
+
+/* One frame: rates since the previous frame, changed fields only */
+static void monitor_update(void) {
+    uint64_t t0 = timer_ticks();
+    mon_prev_t now;
+    mailbox_stats_t mbox;
+
+    snapshot_counters(&now);
+    mailbox_get_stats(&mbox);
+
+    uint64_t elapsed = now.ticks - prev.ticks;
+    uint64_t elapsed_us = timer_ticks_to_us(elapsed);
+    if (elapsed_us == 0) {
+        return;
+    }
+
+    for (uint32_t core = 0; core < NUM_CORES; core++) {
+        uint64_t idle = now.idle[core] - prev.idle[core];
+        uint64_t busy = idle < elapsed ? elapsed - idle : 0;
+        uint32_t pct = tenths(busy, elapsed);
+        uint64_t wakes = now.wakeups[core] - prev.wakeups[core];
+
+        bar_set(core, fields[FIELD_CORE0 + core].y, pct * MON_BAR_W / 1000);
+        if (core >= smp_online_cores()) {
+            field_set(FIELD_CORE0 + core, "offline");
+        } else {
+            field_printf(FIELD_CORE0 + core, "%3u.%u%%  %6lu/s", pct / 10, pct % 10,
+                         wakes * 1000000 / elapsed_us);
+        }
+    }
+
+    field_printf(FIELD_MBOX_RATE, "%lu/s (%lu total)",
+                 (now.mbox_calls - prev.mbox_calls) * 1000000 / elapsed_us, mbox.calls);
+    if (mbox.calls) {
+        field_printf(FIELD_MBOX_LATENCY, "last %lu us, avg %lu us, max %lu us",
+                     timer_ticks_to_us(mbox.last_ticks),
+                     timer_ticks_to_us(mbox.total_ticks / mbox.calls),
+                     timer_ticks_to_us(mbox.max_ticks));
+    }
+
+    field_printf(FIELD_FRAME, "%lu us every %u ms", timer_ticks_to_us(last_frame_ticks),
+                 period_ms);
+
+    const frame_stats_t *fs = frame_get_stats();
+    field_printf(FIELD_PACING, "%lu us %s, %lu missed, %lu skipped", (uint64_t)frame_period_us(),
+                 frame_vsync() ? "vsync" : "timer", fs->missed, fs->skipped);
+
+    const telemetry_sample_t *s = telemetry_latest();
+    if (s && (s->valid & TELEM_VALID_ARM_CLOCK) && (s->valid & TELEM_VALID_TEMP)) {
+        field_printf(FIELD_CLOCK, "%u MHz, %u.%u C", s->arm_clock / 1000000,
+                     s->temp_mc / 1000, (s->temp_mc % 1000) / 100);
+    }
+    field_printf(FIELD_FIBERS, "%u on core 0", fiber_count(0));
+
+    field_printf(FIELD_MEM_IMAGE, "%lu KB at %p", (uint64_t)(__bss_start - _start) / 1024,
+                 _start);
+    field_printf(FIELD_MEM_BSS, "%lu KB", (uint64_t)(__bss_end - __bss_start) / 1024);
+    field_printf(FIELD_MEM_DMA, "%lu KB (non-cacheable)",
+                 (uint64_t)(__dma_end - __dma_start) / 1024);
+    field_printf(FIELD_MEM_STACKS, "%lu KB core 0, %lu KB cores 1-3%s",
+                 stack_size(0) / 1024, (uint64_t)(__stacks_end - __stacks_start) / 1024,
+                 stack_guarded() ? ", guarded" : "");
+
+    char peaks[FIELD_MAX];
+    size_t len = 0;
+    for (uint32_t core = 0; core < NUM_CORES; core++) {
+        len += kformat(peaks + len, sizeof(peaks) - len, "%s%lu", core ? " / " : "",
+                       (stack_used(core) + 1023) / 1024);
+    }
+    kformat(peaks + len, sizeof(peaks) - len, " KB");
+    field_set(FIELD_MEM_STACK_PEAK, peaks);
+    if (arm_mem_size > (uint64_t)__end) {
+        field_printf(FIELD_MEM_FREE, "%lu MB of %u MB above %p",
+                     (arm_mem_size - (uint64_t)__end) / (1024 * 1024),
+                     arm_mem_size / (1024 * 1024), __end);
+    }
+
+    prev = now;
+    last_frame_ticks = timer_ticks() - t0;
+}
+
+/*
+ * monitor_start - Switch the screen to the monitor
+ * @sysinfo: Provides the ARM memory size for the free-memory figure
+ *
+ * Counters start from now, so the first frame shows the first period.
+ */
+void monitor_start(const sysinfo_t *sysinfo) {
+    arm_mem_size = sysinfo->arm_mem_size;
+    draw_layout();
+    snapshot_counters(&prev);
+    last_frame_ticks = 0;
+    due_us = 0;
+    active = true;
+}
+
+/*
+ * monitor_stop - Stop refreshing; the caller redraws its own screen
+ */
+void monitor_stop(void) {
+    active = false;
+}
+
+/*
+ * monitor_active - Whether the monitor owns the screen
+ */
+bool monitor_active(void) {
+    return active;
+}
+
+/*
+ * monitor_set_period_ms - Change the refresh period
+ * @ms: Clamped to MONITOR_MIN_MS..MONITOR_MAX_MS
+ */
+void monitor_set_period_ms(uint32_t ms) {
+    if (ms < MONITOR_MIN_MS) {
+        ms = MONITOR_MIN_MS;
+    } else if (ms > MONITOR_MAX_MS) {
+        ms = MONITOR_MAX_MS;
+    }
+    period_ms = ms;
+}
+
+/*
+ * monitor_period_ms - Current refresh period
+ */
+uint32_t monitor_period_ms(void) {
+    return period_ms;
+}
+
+static void monitor_frame_update(uint64_t dt_us, void *arg) {
+    if (active) {
+        due_us += dt_us;
+    }
+}
+
+static void monitor_frame_render(void *arg) {
+    if (active && due_us >= (uint64_t)period_ms * 1000) {
+        due_us = 0;
+        monitor_update();
+    }
+}
+
+/*
+ * monitor_init - Register with the frame scheduler; idle while off
+ */
+void monitor_init(void) {
+    frame_register("monitor", monitor_frame_update, monitor_frame_render, NULL);
+}
@@ -0,0 +1,64 @@
+/*
+ * qoibench.c - QOI Decoder Throughput
+ *
+ * Decodes the embedded logo repeatedly into an off-screen buffer on one
+ * core, then checks the last pass against a reference decode.
+ */
+
+#include "bench.h"
+#include "qoi.h"
+#include "assets.h"
+#include "timer.h"
+#include "string.h"
+
+#define DECODE_PIXELS   (4 * 1024 * 1024)   /* Per measurement */
+#define MAX_PIXELS      (64 * 64)
+
+static uint32_t first[MAX_PIXELS];
+static uint32_t pixels[MAX_PIXELS];
+
+/* Decode a whole image into dst; returns the pixel count or 0 */
+static uint32_t decode_image(const uint8_t *data, uint32_t size, uint32_t *dst) {
+    qoi_decoder_t dec;
+
+    if (!qoi_decode_init(&dec, data, size) || dec.width * dec.height > MAX_PIXELS) {
+        return 0;
+    }
+    while (qoi_decode_row(&dec, dst)) {
+        dst += dec.width;
+    }
+    return dec.width * dec.height;
+}
+
+/*
+ * qoibench_run - Measure QOI decode rate in pixels per second
+ */
+void qoibench_run(void) {
+    uint32_t size = 0;
+    const uint8_t *data = asset_find("logo.qoi", &size);
+
+    bench_header("qoi");
+
+    uint32_t count = data ? decode_image(data, size, first) : 0;
+    if (count == 0) {
+        bench_note("qoi decode", "FAIL: invalid image");
+        return;
+    }
+
+    uint32_t passes = DECODE_PIXELS / count;
+    uint64_t t0 = timer_ticks();
+    for (uint32_t i = 0; i < passes; i++) {
+        decode_image(data, size, pixels);
+    }
+    uint64_t ticks = timer_ticks() - t0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (pixels[i] != first[i]) {
+            bench_note("qoi decode", "FAIL: output differs between passes");
+            return;
+        }
+    }
+
+    /* ops = pixels, so Mops/s reads as Mpixel/s */
+    bench_result("qoi decode (pixels)", 1, (uint64_t)passes * count, ticks);
+}
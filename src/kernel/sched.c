@@ -0,0 +1,280 @@
+/*
+ * sched.c - Work-stealing Task Scheduler
+ *
+ * Deque operations follow Chase & Lev ("Dynamic Circular Work-Stealing
+ * Deque") with the fences from Le et al. for weak memory models. Indices
+ * only ever grow; the slot is index & (SCHED_DEQUE_SIZE - 1).
+ *
+ * Cores 1..n-1 run worker_loop() through smp_run() while the scheduler
+ * is started; core 0 takes part whenever it waits on a task.
+ */
+
+#include "sched.h"
+#include "smp.h"
+#include "sync.h"
+#include "trace.h"
+#include "cpustat.h"
+#include "ipi.h"
+#include "logic.h"
+
+#define DEQUE_MASK  (SCHED_DEQUE_SIZE - 1)
+
+typedef struct {
+    volatile uint64_t top;          /* Thieves take from here */
+    volatile uint64_t bottom;       /* Owner pushes/pops here */
+    task_t *volatile buf[SCHED_DEQUE_SIZE];
+} __attribute__((aligned(64))) deque_t;
+
+static deque_t deques[NUM_CORES];
+static sched_stats_t stats[NUM_CORES];
+
+static volatile uint32_t running;
+static uint32_t active_cores;
+
+/* Owner: push at bottom, false if full */
+static bool deque_push(deque_t *d, task_t *task) {
+    uint64_t b = d->bottom;
+    uint64_t t = atomic_load_acq64(&d->top);
+
+    if (b - t >= SCHED_DEQUE_SIZE) {
+        return false;
+    }
+
+    d->buf[b & DEQUE_MASK] = task;
+    dmb(ish);                       /* Slot visible before new bottom */
+    d->bottom = b + 1;
+    return true;
+}
+
+/* Owner: pop at bottom, races thieves only for the last task */
+static task_t *deque_pop(deque_t *d) {
+    uint64_t b = d->bottom - 1;
+
+    d->bottom = b;
+    dmb(ish);                       /* Publish bottom before reading top */
+    uint64_t t = d->top;
+
+    if ((int64_t)(b - t) < 0) {
+        d->bottom = b + 1;          /* Empty */
+        return NULL;
+    }
+
+    task_t *task = d->buf[b & DEQUE_MASK];
+    if (b == t) {
+        if (!atomic_cas64(&d->top, t, t + 1)) {
+            task = NULL;            /* A thief got it */
+        }
+        d->bottom = b + 1;
+    }
+    return task;
+}
+
+/* Thief: take from top */
+static task_t *deque_steal(deque_t *d) {
+    uint64_t t = atomic_load_acq64(&d->top);
+    dmb(ish);
+    uint64_t b = atomic_load_acq64(&d->bottom);
+
+    if ((int64_t)(b - t) <= 0) {
+        return NULL;
+    }
+
+    task_t *task = d->buf[t & DEQUE_MASK];
+    if (!atomic_cas64(&d->top, t, t + 1)) {
+        return NULL;                /* Lost the race, caller tries elsewhere */
+    }
+    return task;
+}
+
+static void run_task(uint32_t core, task_t *task) {
+    trace_begin("task");
+    task->fn(task->arg);
+    trace_end("task");
+    atomic_store_rel(&task->done, 1);
+    sev();
+    stats[core].executed++;
+}
+
+/* Own deque first, then steal round-robin from the others */
+static task_t *find_task(uint32_t core) {
+    task_t *task = deque_pop(&deques[core]);
+    if (task) {
+        return task;
+    }
+
+    for (uint32_t i = 1; i < active_cores; i++) {
+        uint32_t victim = (core + i) % active_cores;
+        task = deque_steal(&deques[victim]);
+        if (task) {
+            stats[core].steals++;
+            return task;
+        }
+    }
+    return NULL;
+}
+
+/* Worker loop for cores 1..n-1, returns on sched_stop() */
+static void worker_loop(void *arg) {
+    uint32_t core = smp_core_id();
+
+    while (atomic_load_acq(&running)) {
+        ipi_poll();                 /* smp_call between tasks */
+
+        task_t *task = find_task(core);
+        if (task) {
+            run_task(core, task);
+        } else {
+            cpustat_idle_enter(core);
+            wfe();                  /* task_spawn / sched_stop send sev */
+            cpustat_idle_exit(core);
+        }
+    }
+}
+
+/*
+ * sched_start - Start workers on cores 1..ncores-1
+ * Returns: Number of cores taking part (including core 0)
+ *
+ * Core 0 alone (no MMU, see smp_start_secondaries) leaves the scheduler
+ * stopped: the deques need exclusives, so every task runs inline.
+ * LOGIC_CORE is left out while a capture runs on it: smp_run() would
+ * wait for the whole capture, and a worker there would never steal.
+ */
+uint32_t sched_start(uint32_t ncores) {
+    uint32_t online = smp_online_cores();
+
+    if (!smp_started()) {
+        return 1;
+    }
+
+    if (ncores > online) {
+        ncores = online;
+    }
+    if (ncores > LOGIC_CORE && logic_busy()) {
+        ncores = LOGIC_CORE;
+    }
+    if (ncores == 0) {
+        ncores = 1;
+    }
+
+    for (uint32_t core = 0; core < NUM_CORES; core++) {
+        deques[core].top = 0;
+        deques[core].bottom = 0;
+        stats[core].executed = 0;
+        stats[core].steals = 0;
+        stats[core].inline_runs = 0;
+    }
+
+    active_cores = ncores;
+    atomic_store_rel(&running, 1);
+
+    for (uint32_t core = 1; core < ncores; core++) {
+        smp_run(core, worker_loop, NULL);
+    }
+
+    return ncores;
+}
+
+/*
+ * sched_stop - Stop workers; all spawned tasks must have been waited on
+ */
+void sched_stop(void) {
+    atomic_store_rel(&running, 0);
+    sev();
+
+    for (uint32_t core = 1; core < active_cores; core++) {
+        smp_wait(core);
+    }
+    active_cores = 1;
+}
+
+bool sched_running(void) {
+    return atomic_load_acq(&running) != 0;
+}
+
+/*
+ * task_spawn - Queue fn(arg) on the current core's deque
+ *
+ * Runs it immediately instead if the scheduler is stopped, the calling
+ * core is not a worker, or the deque is full.
+ */
+void task_spawn(task_t *task, task_fn_t fn, void *arg) {
+    uint32_t core = smp_core_id();
+
+    task->fn = fn;
+    task->arg = arg;
+    task->done = 0;
+
+    if (!atomic_load_acq(&running) || core >= active_cores ||
+        !deque_push(&deques[core], task)) {
+        stats[core].inline_runs++;
+        run_task(core, task);
+        return;
+    }
+
+    sev();                          /* Wake idle workers */
+}
+
+/*
+ * task_wait - Wait for a task, running other work in the meantime
+ */
+void task_wait(task_t *task) {
+    uint32_t core = smp_core_id();
+
+    while (!atomic_load_acq(&task->done)) {
+        task_t *other = core < active_cores ? find_task(core) : NULL;
+        if (other) {
+            run_task(core, other);
+        } else {
+            wfe();                  /* run_task sends sev on completion */
+        }
+    }
+}
+
+/* Recursive splitting for parallel_for */
+typedef struct {
+    uint32_t begin;
+    uint32_t end;
+    uint32_t grain;
+    range_fn_t fn;
+    void *arg;
+} pfor_range_t;
+
+static void pfor_task(void *p) {
+    pfor_range_t *r = p;
+
+    if (r->end - r->begin <= r->grain) {
+        trace_begin("parallel_for");
+        r->fn(r->begin, r->end, r->arg);
+        trace_end("parallel_for");
+        return;
+    }
+
+    /* Right half goes to the deque for thieves, left half runs here */
+    uint32_t mid = r->begin + (r->end - r->begin) / 2;
+    pfor_range_t right = { mid, r->end, r->grain, r->fn, r->arg };
+    pfor_range_t left = { r->begin, mid, r->grain, r->fn, r->arg };
+    task_t task;
+
+    task_spawn(&task, pfor_task, &right);
+    pfor_task(&left);
+    task_wait(&task);
+}
+
+/*
+ * parallel_for - Run fn over [begin, end) in chunks of at most `grain`
+ */
+void parallel_for(uint32_t begin, uint32_t end, uint32_t grain, range_fn_t fn, void *arg) {
+    pfor_range_t range = { begin, end, grain ? grain : 1, fn, arg };
+
+    if (end > begin) {
+        pfor_task(&range);
+    }
+}
+
+/*
+ * sched_get_stats - Counters for one core since sched_start
+ */
+const sched_stats_t *sched_get_stats(uint32_t core) {
+    return core < NUM_CORES ? &stats[core] : NULL;
+}
@@ -0,0 +1,108 @@
+/*
+ * schedbench.c - Task Scheduler Benchmarks
+ *
+ * Spawn/wait overhead on one core, and parallel_for scaling over 1-4
+ * cores on a compute-bound kernel whose checksum must not change with
+ * the core count.
+ */
+
+#include "bench.h"
+#include "sched.h"
+#include "smp.h"
+#include "sync.h"
+#include "timer.h"
+#include "kprintf.h"
+
+#define SPAWN_TASKS     10000       /* At least; whole batches are spawned */
+#define SPAWN_BATCH     64
+#define PFOR_ITEMS      4096
+#define PFOR_GRAIN      16
+#define PFOR_WORK       256         /* xorshift rounds per item */
+
+static volatile uint32_t checksum;
+
+static void empty_task(void *arg) {
+}
+
+/* Compute-bound body: hash each item, fold into a shared checksum */
+static void hash_range(uint32_t begin, uint32_t end, void *arg) {
+    uint32_t sum = 0;
+
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t x = i * 2654435761u + 1;
+        for (uint32_t r = 0; r < PFOR_WORK; r++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+        }
+        sum += x;
+    }
+    atomic_fetch_add(&checksum, sum);
+}
+
+/* Print per-core executed/stolen counts for the last run */
+static void report_distribution(uint32_t cores) {
+    char text[96];
+    size_t len = 0;
+
+    text[0] = '\0';
+    for (uint32_t core = 0; core < cores && len < sizeof(text); core++) {
+        const sched_stats_t *st = sched_get_stats(core);
+        len += kformat(text + len, sizeof(text) - len, "c%u=%u/%u ",
+                       core, st->executed, st->steals);
+    }
+    bench_note("  tasks run/stolen", text);
+}
+
+/*
+ * schedbench_run - Spawn overhead and parallel_for scaling
+ */
+void schedbench_run(void) {
+    static task_t tasks[SPAWN_BATCH];
+    uint64_t start, ticks, base = 0;
+    uint32_t expect = 0, spawned = 0;
+    char text[48];
+
+    bench_header("task scheduler");
+
+    /* Spawn/wait round trip, single core, in batches */
+    sched_start(1);
+    start = timer_ticks();
+    while (spawned < SPAWN_TASKS) {
+        for (uint32_t i = 0; i < SPAWN_BATCH; i++) {
+            task_spawn(&tasks[i], empty_task, NULL);
+        }
+        for (uint32_t i = 0; i < SPAWN_BATCH; i++) {
+            task_wait(&tasks[i]);
+        }
+        spawned += SPAWN_BATCH;
+    }
+    ticks = timer_ticks() - start;
+    sched_stop();
+    bench_result("spawn+wait (empty)", 1, spawned, ticks);
+
+    /* parallel_for scaling */
+    for (uint32_t cores = 1; cores <= smp_online_cores(); cores++) {
+        checksum = 0;
+        sched_start(cores);
+        start = timer_ticks();
+        parallel_for(0, PFOR_ITEMS, PFOR_GRAIN, hash_range, NULL);
+        ticks = timer_ticks() - start;
+        sched_stop();
+
+        if (cores == 1) {
+            base = ticks;
+            expect = checksum;
+        } else if (checksum != expect) {
+            bench_note("parallel_for", "FAIL: checksum differs from 1 core");
+            continue;
+        }
+
+        bench_result("parallel_for", cores, PFOR_ITEMS, ticks);
+
+        kformat(text, sizeof(text), "speedup x%lu.%02lu",
+                ticks ? base / ticks : 0, ticks ? (base * 100 / ticks) % 100 : 0);
+        bench_note("", text);
+        report_distribution(cores);
+    }
+}
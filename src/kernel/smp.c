@@ -0,0 +1,187 @@
+/*
+ * smp.c - Secondary Core Bring-up and Dispatch
+ *
+ * Each secondary core owns one dispatch slot. Core 0 publishes a
+ * function with a store-release and sev; the core runs it, clears the
+ * slot and sends an event back.
+ */
+
+#include "smp.h"
+#include "sync.h"
+#include "timer.h"
+#include "cache.h"
+#include "cpustat.h"
+#include "stack.h"
+#include "ipi.h"
+#include "mmu.h"
+
+/* How long to wait for a released core to check in */
+#define SMP_START_TIMEOUT_US    100000
+
+/* Entry point in boot.S */
+extern void secondary_start(void);
+
+/* Per-core dispatch slot */
+typedef struct {
+    volatile uint64_t fn;           /* smp_fn_t, 0 when idle */
+    void *volatile arg;
+    volatile uint32_t online;
+} smp_slot_t;
+
+static smp_slot_t slots[NUM_CORES];
+
+/* Set before cores 1-3 are released; until then only core 0 runs */
+static volatile bool started;
+
+/*
+ * smp_secondary_main - Idle/dispatch loop for cores 1-3 (from boot.S)
+ */
+void smp_secondary_main(uint32_t core) {
+    smp_slot_t *slot = &slots[core];
+
+    stack_install_vectors();
+    atomic_store_rel(&slot->online, 1);
+    sev();
+
+    while (1) {
+        uint64_t fn;
+
+        cpustat_idle_enter(core);
+        while ((fn = atomic_load_acq64(&slot->fn)) == 0) {
+            ipi_poll();
+            wfe();
+        }
+        cpustat_idle_exit(core);
+
+        ((smp_fn_t)fn)(slot->arg);
+
+        atomic_store_rel64(&slot->fn, 0);
+        sev();
+    }
+}
+
+/*
+ * smp_start_secondaries - Release cores 1-3 via the spin table
+ * Returns: Number of cores online, including core 0
+ *
+ * Without the MMU (NO_MMU, not entered at EL2, no memory size) cores
+ * 1-3 stay parked: every lock, deque and handshake between cores is
+ * built on exclusives, which need Normal memory. Core 0 then runs
+ * alone and smp_started() stays false.
+ */
+uint32_t smp_start_secondaries(void) {
+    slots[0].online = 1;
+    if (!mmu_enabled()) {
+        return 1;
+    }
+    started = true;
+
+    for (uint32_t core = 1; core < NUM_CORES; core++) {
+        volatile uint64_t *release = (volatile uint64_t *)(uint64_t)(SPIN_TABLE_BASE + core * 8);
+        *release = (uint64_t)secondary_start;
+        
+        /* The parked core polls with its MMU (and caches) off */
+        dcache_clean_range((const void *)release, sizeof(*release));
+    }
+    dsb(sy);
+    sev();
+
+    uint64_t deadline = timer_ticks() + timer_us_to_ticks(SMP_START_TIMEOUT_US);
+    while (smp_online_cores() < NUM_CORES && timer_ticks() < deadline) {
+        cpu_relax();
+    }
+
+    return smp_online_cores();
+}
+
+/*
+ * smp_online_cores - Number of cores that have checked in
+ */
+uint32_t smp_online_cores(void) {
+    uint32_t count = 0;
+    for (uint32_t core = 0; core < NUM_CORES; core++) {
+        count += atomic_load_acq(&slots[core].online);
+    }
+    return count;
+}
+
+/*
+ * smp_started - Whether cores 1-3 have been released
+ *
+ * Until then core 0 runs alone, possibly with the MMU off, where the
+ * exclusives behind the spinlocks may never succeed: drivers used
+ * during early boot skip their locks while this is false.
+ */
+bool smp_started(void) {
+    return started;
+}
+
+/*
+ * smp_lock - spin_lock() once cores 1-3 run, nothing before
+ *
+ * For locks core 0 may also take while it runs alone, possibly with
+ * the MMU off (see smp_started).
+ */
+void smp_lock(spinlock_t *lock) {
+    if (started) {
+        spin_lock(lock);
+    }
+}
+
+/*
+ * smp_unlock - Release a lock taken with smp_lock()
+ */
+void smp_unlock(spinlock_t *lock) {
+    if (started) {
+        spin_unlock(lock);
+    }
+}
+
+/*
+ * smp_run - Start fn(arg) on a secondary core (non-blocking)
+ * Returns: false if the core is not online (or is core 0)
+ *
+ * Waits for any previous work on that core to finish first.
+ */
+bool smp_run(uint32_t core, smp_fn_t fn, void *arg) {
+    if (core == 0 || core >= NUM_CORES || !atomic_load_acq(&slots[core].online)) {
+        return false;
+    }
+
+    smp_wait(core);
+    slots[core].arg = arg;
+    atomic_store_rel64(&slots[core].fn, (uint64_t)fn);
+    sev();
+
+    return true;
+}
+
+/*
+ * smp_wait - Wait until a secondary core is idle
+ */
+void smp_wait(uint32_t core) {
+    while (atomic_load_acq64(&slots[core].fn) != 0) {
+        wfe();
+    }
+}
+
+/*
+ * smp_run_on - Run fn(arg) on cores 0..ncores-1 and wait for all
+ *
+ * Core 0 takes part itself. Cores that are not online are skipped.
+ */
+void smp_run_on(uint32_t ncores, smp_fn_t fn, void *arg) {
+    if (ncores > NUM_CORES) {
+        ncores = NUM_CORES;
+    }
+
+    for (uint32_t core = 1; core < ncores; core++) {
+        smp_run(core, fn, arg);
+    }
+
+    fn(arg);
+
+    for (uint32_t core = 1; core < ncores; core++) {
+        smp_wait(core);
+    }
+}
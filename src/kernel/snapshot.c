@@ -0,0 +1,177 @@
+/*
+ * snapshot.c - Framebuffer Snapshot Streaming
+ *
+ * Encodes the framebuffer row by row straight onto the UART; nothing is
+ * buffered beyond the current and previous scanline pointers. A mostly
+ * black 1280x720 screen encodes to a few KB instead of 3.6 MB.
+ */
+
+#include "snapshot.h"
+#include "framebuffer.h"
+#include "uart.h"
+
+/* Pixels are BGRA in memory; alpha is ignored */
+#define RGB_MASK        0x00FFFFFF
+
+#define FNV_OFFSET      0x811C9DC5
+#define FNV_PRIME       0x01000193
+
+/* Encoded stream statistics (row records only) */
+static uint32_t snap_bytes;
+static uint32_t snap_hash;
+
+/* Emit one byte of the row-record stream */
+static void emit(uint8_t b) {
+    snap_bytes++;
+    snap_hash = (snap_hash ^ b) * FNV_PRIME;
+    uart_putc(b);
+}
+
+/* Emit a 16/32-bit little-endian value (header/trailer, not hashed) */
+static void put_u16(uint16_t v) {
+    uart_putc(v & 0xFF);
+    uart_putc(v >> 8);
+}
+
+static void put_u32(uint32_t v) {
+    put_u16(v & 0xFFFF);
+    put_u16(v >> 16);
+}
+
+/* Emit op byte with count, extended as a varint when count > 63 */
+static void emit_op(uint32_t type, uint32_t count) {
+    if (count <= 63) {
+        emit((type << 6) | (count - 1));
+        return;
+    }
+
+    emit((type << 6) | 63);
+    count -= 64;
+    while (count >= 0x80) {
+        emit((count & 0x7F) | 0x80);
+        count >>= 7;
+    }
+    emit(count);
+}
+
+static void emit_rgb(uint32_t px) {
+    emit((px >> 16) & 0xFF);                    /* R */
+    emit((px >> 8) & 0xFF);                     /* G */
+    emit(px & 0xFF);                            /* B */
+}
+
+static void emit_literal(const uint32_t *row, uint32_t start, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    emit_op(SNAP_OP_LIT, count);
+    for (uint32_t i = 0; i < count; i++) {
+        emit_rgb(row[start + i]);
+    }
+}
+
+/*
+ * encode_row - Encode one scanline against the previous one
+ * @row: Current scanline
+ * @prev: Previous scanline, or NULL for row 0 (compared against black)
+ * @width: Pixels per scanline
+ */
+static void encode_row(const uint32_t *row, const uint32_t *prev, uint32_t width) {
+    uint32_t x;
+
+    /* Whole-row repeat is the common case on a mostly static screen */
+    for (x = 0; x < width; x++) {
+        uint32_t above = prev ? prev[x] : 0;
+        if ((row[x] ^ above) & RGB_MASK) {
+            break;
+        }
+    }
+    if (x == width) {
+        emit(SNAP_ROW_REPEAT);
+        return;
+    }
+
+    emit(SNAP_ROW_OPS);
+
+    uint32_t lit_start = 0;
+    uint32_t lit_len = 0;
+
+    x = 0;
+    while (x < width) {
+        uint32_t px = row[x] & RGB_MASK;
+
+        /* Length of run matching the row above */
+        uint32_t up = 0;
+        while (x + up < width &&
+               !((row[x + up] ^ (prev ? prev[x + up] : 0)) & RGB_MASK)) {
+            up++;
+        }
+
+        /* Length of single-colour run */
+        uint32_t fill = 1;
+        while (x + fill < width && (row[x + fill] & RGB_MASK) == px) {
+            fill++;
+        }
+
+        if (up < 2 && fill < 2) {
+            /* Neither run pays for its op byte - extend literal */
+            if (lit_len == 0) {
+                lit_start = x;
+            }
+            lit_len++;
+            x++;
+            continue;
+        }
+
+        emit_literal(row, lit_start, lit_len);
+        lit_len = 0;
+
+        if (up >= fill) {
+            emit_op(SNAP_OP_UP, up);
+            x += up;
+        } else {
+            emit_op(SNAP_OP_FILL, fill);
+            emit_rgb(px);
+            x += fill;
+        }
+    }
+
+    emit_literal(row, lit_start, lit_len);
+}
+
+/*
+ * snapshot_send - Stream the framebuffer over the UART
+ * Returns: Encoded size in bytes (row records), 0 if unsupported
+ */
+uint32_t snapshot_send(void) {
+    framebuffer_t *fb = fb_get_info();
+
+    if (fb->buffer == NULL || fb->depth != 32) {
+        return 0;
+    }
+
+    snap_bytes = 0;
+    snap_hash = FNV_OFFSET;
+
+    /* Header */
+    uart_write((const uint8_t *)"FBSNAP", 6);
+    uart_putc(SNAPSHOT_VERSION);
+    uart_putc(SNAPSHOT_FMT_RGB888);
+    put_u16(fb->width);
+    put_u16(fb->height);
+
+    const uint32_t *prev = NULL;
+    for (uint32_t y = 0; y < fb->height; y++) {
+        const uint32_t *row = (const uint32_t *)(fb->buffer + y * fb->pitch);
+        encode_row(row, prev, fb->width);
+        prev = row;
+    }
+
+    /* Trailer */
+    uart_write((const uint8_t *)"FBEND", 5);
+    put_u32(snap_bytes);
+    put_u32(snap_hash);
+    uart_flush();
+
+    return snap_bytes;
+}
@@ -0,0 +1,160 @@
+/*
+ * stack.c - Stack Painting, Guard Pages and Fault Reports
+ *
+ * Painting costs one pass over each stack at boot; the high-water scan
+ * walks up from the bottom of a stack to the first overwritten word,
+ * so it reads only the part that has never been used.
+ */
+
+#include "stack.h"
+#include "kprintf.h"
+#include "uart.h"
+
+/* From linker.ld / vectors.S */
+extern char __stacks_start[];
+extern char fault_vectors[];
+
+/* Used by vectors.S, one per core */
+uint8_t __attribute__((aligned(16))) fault_stacks[NUM_CORES][FAULT_STACK_SIZE];
+
+static bool guarded;
+
+static const char *const vector_names[4] = {
+    "synchronous", "IRQ", "FIQ", "SError"
+};
+
+static const char *const vector_origins[4] = {
+    "EL2 SP0", "EL2", "lower EL (AArch64)", "lower EL (AArch32)"
+};
+
+/* Lowest usable address of a core's stack */
+static uint64_t stack_bottom(uint32_t core) {
+    if (core == 0) {
+        return CORE0_STACK_TOP - CORE0_STACK_SIZE;
+    }
+    return (uint64_t)__stacks_start + (core - 1) * STACK_SLOT_SIZE + STACK_GUARD_SIZE;
+}
+
+/* Guard page below a core's stack */
+static uint64_t stack_guard(uint32_t core) {
+    return stack_bottom(core) - STACK_GUARD_SIZE;
+}
+
+/* Fill [start, end) with the paint pattern */
+static void paint(uint64_t start, uint64_t end) {
+    for (volatile uint64_t *p = (uint64_t *)start; p < (uint64_t *)end; p++) {
+        *p = STACK_PAINT;
+    }
+}
+
+/* Paint this stack below the caller's frame (no calls below this point) */
+static void __attribute__((noinline)) paint_below_sp(uint64_t bottom) {
+    uint64_t sp;
+
+    asm volatile("mov %0, sp" : "=r"(sp));
+    paint(bottom, sp & ~7ul);
+}
+
+/*
+ * stack_init - Paint all stacks and unmap their guard pages
+ *
+ * Call on core 0 before releasing cores 1-3 (their stacks are painted
+ * whole) and after mmu_init(); the guard pages are only installed if
+ * the MMU is on. Stack used before this call is not counted.
+ */
+void stack_init(void) {
+    paint_below_sp(stack_bottom(0));
+    for (uint32_t core = 1; core < NUM_CORES; core++) {
+        paint(stack_bottom(core), stack_bottom(core) + stack_size(core));
+    }
+
+    if (mmu_enabled()) {
+        guarded = true;
+        for (uint32_t core = 0; core < NUM_CORES; core++) {
+            if (!mmu_map_range(stack_guard(core), STACK_GUARD_SIZE, MMU_UNMAPPED)) {
+                guarded = false;
+            }
+        }
+    }
+    stack_install_vectors();
+}
+
+/*
+ * stack_install_vectors - Point VBAR_EL2 at the fault vectors (this core)
+ */
+void stack_install_vectors(void) {
+    uint64_t el;
+
+    asm volatile("mrs %0, CurrentEL" : "=r"(el));
+    if (((el >> 2) & 3) == 2) {
+        asm volatile("msr vbar_el2, %0; isb" :: "r"((uint64_t)fault_vectors) : "memory");
+    }
+}
+
+/*
+ * stack_guarded - Whether overflowing a stack faults
+ */
+bool stack_guarded(void) {
+    return guarded;
+}
+
+/*
+ * stack_size - Usable bytes of a core's stack
+ */
+uint64_t stack_size(uint32_t core) {
+    return core == 0 ? CORE0_STACK_SIZE : SECONDARY_STACK_SIZE;
+}
+
+/*
+ * stack_used - High-water mark of a core's stack
+ * Returns: Bytes from the top down to the deepest overwritten word
+ */
+uint64_t stack_used(uint32_t core) {
+    const volatile uint64_t *p = (const uint64_t *)stack_bottom(core);
+    const volatile uint64_t *end = (const uint64_t *)(stack_bottom(core) + stack_size(core));
+
+    while (p < end && *p == STACK_PAINT) {
+        p++;
+    }
+    return (uint64_t)end - (uint64_t)p;
+}
+
+/*
+ * stack_report - Print per-core stack high-water marks over serial
+ */
+void stack_report(void) {
+    for (uint32_t core = 0; core < smp_online_cores(); core++) {
+        uint64_t used = stack_used(core);
+        uint64_t size = stack_size(core);
+
+        kprintf("Stack core %u: %lu of %lu bytes (%lu%%)%s\n", core, used, size,
+                used * 100 / size, guarded ? ", guarded" : "");
+    }
+}
+
+/*
+ * fault_handler - Report an exception and halt this core (from vectors.S)
+ * @vector: Vector table index (origin * 4 + type)
+ */
+void fault_handler(uint32_t vector) {
+    uint64_t esr, elr, far;
+    uint32_t core = smp_core_id();
+
+    asm volatile("mrs %0, esr_el2" : "=r"(esr));
+    asm volatile("mrs %0, elr_el2" : "=r"(elr));
+    asm volatile("mrs %0, far_el2" : "=r"(far));
+
+    kprintf("\n*** %s exception from %s on core %u\n", vector_names[vector & 3],
+            vector_origins[(vector >> 2) & 3], core);
+    kprintf("    ESR %08lX  ELR %016lX  FAR %016lX\n", esr, elr, far);
+
+    for (uint32_t c = 0; c < NUM_CORES; c++) {
+        if (far >= stack_guard(c) && far < stack_guard(c) + STACK_GUARD_SIZE) {
+            kprintf("    stack overflow: core %u guard page\n", c);
+        }
+    }
+
+    while (1) {
+        asm volatile("wfe");
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ * sync.c - SMP Synchronization Primitives (out-of-line parts)
+ *
+ * Atomics and locks are inline in sync.h; the barrier lives here.
+ */
+
+#include "sync.h"
+#include "smp.h"
+
+/*
+ * barrier_init - Prepare a barrier for `total` participating cores
+ */
+void barrier_init(barrier_t *b, uint32_t total) {
+    b->count = 0;
+    b->sense = 0;
+    b->total = total;
+    for (uint32_t i = 0; i < BARRIER_MAX_CORES; i++) {
+        b->local_sense[i] = 0;
+    }
+}
+
+/*
+ * barrier_wait - Block until all participants have arrived
+ *
+ * The last arrival resets the count and flips the shared sense; the
+ * others sleep in wfe until they see it match their own flipped sense.
+ * Flipping sense each round makes the barrier reusable back to back.
+ */
+void barrier_wait(barrier_t *b) {
+    uint32_t core = smp_core_id();
+    uint32_t sense = !b->local_sense[core];
+
+    b->local_sense[core] = sense;
+
+    if (atomic_fetch_add(&b->count, 1) == b->total - 1) {
+        b->count = 0;
+        atomic_store_rel(&b->sense, sense);
+        sev();
+    } else {
+        while (atomic_load_acq(&b->sense) != sense) {
+            wfe();
+        }
+    }
+}
@@ -0,0 +1,163 @@
+/*
+ * syncbench.c - Contention Microbenchmarks for sync.h
+ *
+ * Each primitive is hammered by 1, 2 and 4 cores at once. Every run
+ * also checks the result (counter totals, reader-visible invariants),
+ * so a broken primitive shows up as FAIL rather than a fast number.
+ */
+
+#include "bench.h"
+#include "sync.h"
+#include "smp.h"
+#include "timer.h"
+#include "kprintf.h"
+
+#define SYNC_ITERS      20000
+#define BARRIER_ITERS   2000
+
+static spinlock_t lock = SPINLOCK_INIT;
+static rwlock_t rw = RWLOCK_INIT;
+static seqlock_t sl = SEQLOCK_INIT;
+static barrier_t bar;
+
+static volatile uint32_t counter;
+static volatile uint32_t data_a, data_b;    /* Writers keep a == b */
+static volatile uint32_t errors;
+static volatile uint32_t writer_done;
+static volatile uint32_t seq_reads;
+static volatile uint32_t seq_retries;
+
+static void worker_atomic(void *arg) {
+    for (uint32_t i = 0; i < SYNC_ITERS; i++) {
+        atomic_fetch_add(&counter, 1);
+    }
+}
+
+static void worker_ticket(void *arg) {
+    for (uint32_t i = 0; i < SYNC_ITERS; i++) {
+        spin_lock(&lock);
+        counter++;
+        spin_unlock(&lock);
+    }
+}
+
+/* 1 write in 8 */
+static void worker_rwlock(void *arg) {
+    for (uint32_t i = 0; i < SYNC_ITERS; i++) {
+        if ((i & 7) == 0) {
+            write_lock(&rw);
+            data_a++;
+            data_b++;
+            counter++;
+            write_unlock(&rw);
+        } else {
+            read_lock(&rw);
+            if (data_a != data_b) {
+                atomic_fetch_add(&errors, 1);
+            }
+            read_unlock(&rw);
+        }
+    }
+}
+
+/* Core 0 writes, the others read until it is done */
+static void worker_seqlock(void *arg) {
+    if (smp_core_id() == 0) {
+        for (uint32_t i = 0; i < SYNC_ITERS; i++) {
+            write_seqlock(&sl);
+            data_a++;
+            data_b++;
+            counter++;
+            write_sequnlock(&sl);
+        }
+        atomic_store_rel(&writer_done, 1);
+        return;
+    }
+
+    uint32_t reads = 0, retries = 0;
+    while (!atomic_load_acq(&writer_done)) {
+        uint32_t seq, a, b;
+        do {
+            seq = read_seqbegin(&sl);
+            a = data_a;
+            b = data_b;
+        } while (read_seqretry(&sl, seq) && ++retries);
+
+        if (a != b) {
+            atomic_fetch_add(&errors, 1);
+        }
+        reads++;
+    }
+    atomic_fetch_add(&seq_reads, reads);
+    atomic_fetch_add(&seq_retries, retries);
+}
+
+static void worker_barrier(void *arg) {
+    for (uint32_t i = 0; i < BARRIER_ITERS; i++) {
+        barrier_wait(&bar);
+        atomic_fetch_add(&counter, 1);
+    }
+}
+
+/* Reset shared state, run on `cores`, return elapsed ticks */
+static uint64_t run(uint32_t cores, smp_fn_t fn) {
+    counter = 0;
+    data_a = 0;
+    data_b = 0;
+    errors = 0;
+    writer_done = 0;
+    seq_reads = 0;
+    seq_retries = 0;
+    barrier_init(&bar, cores);
+    dsb(sy);
+
+    uint64_t start = timer_ticks();
+    smp_run_on(cores, fn, NULL);
+    return timer_ticks() - start;
+}
+
+/* Report a run, or FAIL if the shared counter/invariant is wrong */
+static void report(const char *name, uint32_t cores, uint32_t expect, uint64_t ticks) {
+    char text[64];
+
+    if (counter != expect || errors) {
+        kformat(text, sizeof(text), "FAIL: counter %u expected %u, errors %u",
+                counter, expect, errors);
+        bench_note(name, text);
+        return;
+    }
+    bench_result(name, cores, counter, ticks);
+}
+
+/*
+ * syncbench_run - Contention benchmark for every primitive
+ */
+void syncbench_run(void) {
+    uint32_t online = smp_online_cores();
+    char text[48];
+
+    bench_header("sync primitives");
+
+    for (uint32_t cores = 1; cores <= online; cores *= 2) {
+        uint64_t t;
+
+        t = run(cores, worker_atomic);
+        report("atomic_fetch_add", cores, cores * SYNC_ITERS, t);
+
+        t = run(cores, worker_ticket);
+        report("ticket spinlock", cores, cores * SYNC_ITERS, t);
+
+        t = run(cores, worker_rwlock);
+        report("rwlock (1/8 writes)", cores, cores * SYNC_ITERS / 8, t);
+
+        t = run(cores, worker_seqlock);
+        report("seqlock writer", cores, SYNC_ITERS, t);
+        if (cores > 1) {
+            kformat(text, sizeof(text), "reads %u, retries %u", seq_reads, seq_retries);
+            bench_note("seqlock readers", text);
+        }
+
+        t = run(cores, worker_barrier);
+        report("barrier arrival", cores, cores * BARRIER_ITERS, t);
+    }
+}
@@ -8,58 +8,28 @@
 #include "mailbox.h"
 
 /*
- * Helper to send a simple property request
+ * Helper to send a simple property request (no request arguments)
  */
-static bool query_property(uint32_t tag, uint32_t req_size, uint32_t *response, uint32_t resp_count) {
-    uint32_t i = 0;
-    
-    mailbox_buffer[i++] = 0;                    /* Size (fill later) */
-    mailbox_buffer[i++] = 0;                    /* Request code */
-    mailbox_buffer[i++] = tag;
-    mailbox_buffer[i++] = req_size;
-    mailbox_buffer[i++] = 0;                    /* Request/response code */
-    
+static bool query_property(uint32_t tag, uint32_t *response, uint32_t resp_count) {
     /* Clear response area */
     for (uint32_t j = 0; j < resp_count; j++) {
-        mailbox_buffer[i++] = 0;
-    }
-    
-    mailbox_buffer[i++] = TAG_END;
-    mailbox_buffer[0] = i * 4;
-    
-    if (!mailbox_call(MAILBOX_CH_PROP)) {
-        return false;
-    }
-    
-    /* Copy response */
-    for (uint32_t j = 0; j < resp_count; j++) {
-        response[j] = mailbox_buffer[5 + j];
+        response[j] = 0;
     }
     
-    return true;
+    return mailbox_property(tag, response, resp_count);
 }
 
 /*
  * Query clock rate for a specific clock
  */
 static uint32_t query_clock_rate(uint32_t clock_id) {
-    uint32_t i = 0;
-    
-    mailbox_buffer[i++] = 0;
-    mailbox_buffer[i++] = 0;
-    mailbox_buffer[i++] = TAG_GET_CLOCK_RATE;
-    mailbox_buffer[i++] = 8;
-    mailbox_buffer[i++] = 0;
-    mailbox_buffer[i++] = clock_id;
-    mailbox_buffer[i++] = 0;                    /* Rate (response) */
-    mailbox_buffer[i++] = TAG_END;
-    mailbox_buffer[0] = i * 4;
-    
-    if (!mailbox_call(MAILBOX_CH_PROP)) {
+    uint32_t values[2] = { clock_id, 0 };
+    
+    if (!mailbox_property(TAG_GET_CLOCK_RATE, values, 2)) {
         return 0;
     }
     
-    return mailbox_buffer[6];
+    return values[1];
 }
 
 /*
@@ -74,39 +44,39 @@ bool sysinfo_init(sysinfo_t *info) {
     }
     
     /* Get firmware version */
-    if (query_property(TAG_GET_FIRMWARE, 4, resp, 1)) {
+    if (query_property(TAG_GET_FIRMWARE, resp, 1)) {
         info->firmware_version = resp[0];
     }
     
     /* Get board model */
-    if (query_property(TAG_GET_BOARD_MODEL, 4, resp, 1)) {
+    if (query_property(TAG_GET_BOARD_MODEL, resp, 1)) {
         info->board_model = resp[0];
     }
     
     /* Get board revision */
-    if (query_property(TAG_GET_BOARD_REV, 4, resp, 1)) {
+    if (query_property(TAG_GET_BOARD_REV, resp, 1)) {
         info->board_revision = resp[0];
     }
     
     /* Get serial number */
-    if (query_property(TAG_GET_BOARD_SERIAL, 8, resp, 2)) {
+    if (query_property(TAG_GET_BOARD_SERIAL, resp, 2)) {
         info->serial_number = ((uint64_t)resp[1] << 32) | resp[0];
     }
     
     /* Get ARM memory */
-    if (query_property(TAG_GET_ARM_MEMORY, 8, resp, 2)) {
+    if (query_property(TAG_GET_ARM_MEMORY, resp, 2)) {
         info->arm_mem_base = resp[0];
         info->arm_mem_size = resp[1];
     }
     
     /* Get VideoCore memory */
-    if (query_property(TAG_GET_VC_MEMORY, 8, resp, 2)) {
+    if (query_property(TAG_GET_VC_MEMORY, resp, 2)) {
         info->vc_mem_base = resp[0];
         info->vc_mem_size = resp[1];
     }
     
     /* Get MAC address */
-    if (query_property(TAG_GET_MAC_ADDR, 6, resp, 2)) {
+    if (query_property(TAG_GET_MAC_ADDR, resp, 2)) {
         info->mac_address[0] = (resp[0] >> 0) & 0xFF;
         info->mac_address[1] = (resp[0] >> 8) & 0xFF;
         info->mac_address[2] = (resp[0] >> 16) & 0xFF;
@@ -0,0 +1,215 @@
+/*
+ * telemetry.c - Periodic Hardware Telemetry
+ *
+ * Every field comes from one property message, so a sample costs a
+ * single mailbox round trip. telemetry_poll() is meant to be called from
+ * the main loop; it only touches the mailbox when a period has elapsed.
+ */
+
+#include "telemetry.h"
+#include "mailbox.h"
+#include "timer.h"
+
+/* Sample history */
+static telemetry_sample_t ring[TELEMETRY_RING_SIZE];
+static uint32_t ring_head;          /* Next slot to write */
+static uint32_t ring_count;
+
+static uint64_t period_ticks;
+static uint64_t next_sample;
+
+/*
+ * Append a tag with one id/value pair, returns index of the tag header
+ */
+static uint32_t put_tag(uint32_t *i, uint32_t tag, uint32_t size, uint32_t id) {
+    uint32_t start = *i;
+
+    mailbox_buffer[(*i)++] = tag;
+    mailbox_buffer[(*i)++] = size;
+    mailbox_buffer[(*i)++] = 0;                 /* Request/response code */
+    mailbox_buffer[(*i)++] = id;
+    if (size > 4) {
+        mailbox_buffer[(*i)++] = 0;             /* Value (response) */
+    }
+
+    return start;
+}
+
+/* True if the firmware filled in this tag */
+static bool tag_ok(uint32_t tag_index) {
+    return (mailbox_buffer[tag_index + 2] & TAG_RESPONSE) != 0;
+}
+
+/*
+ * telemetry_sample - Take one sample now (single mailbox call)
+ * @sample: Output
+ * Returns: true if the mailbox call succeeded
+ */
+bool telemetry_sample(telemetry_sample_t *sample) {
+    uint32_t i = 0;
+
+    mailbox_lock();
+
+    mailbox_buffer[i++] = 0;                    /* Size (fill later) */
+    mailbox_buffer[i++] = 0;                    /* Request code */
+
+    uint32_t t_temp  = put_tag(&i, TAG_GET_TEMPERATURE, 8, 0);
+    uint32_t t_arm   = put_tag(&i, TAG_GET_CLOCK_MEASURED, 8, CLOCK_ID_ARM);
+    uint32_t t_core  = put_tag(&i, TAG_GET_CLOCK_MEASURED, 8, CLOCK_ID_CORE);
+    uint32_t t_thr   = put_tag(&i, TAG_GET_THROTTLED, 4, 0);
+    uint32_t t_vcore = put_tag(&i, TAG_GET_VOLTAGE, 8, VOLTAGE_ID_CORE);
+    uint32_t t_vsdr  = put_tag(&i, TAG_GET_VOLTAGE, 8, VOLTAGE_ID_SDRAM_C);
+
+    mailbox_buffer[i++] = TAG_END;
+    mailbox_buffer[0] = i * 4;
+
+    sample->timestamp = timer_ticks();
+    sample->valid = 0;
+
+    if (!mailbox_call(MAILBOX_CH_PROP)) {
+        mailbox_unlock();
+        return false;
+    }
+
+    /* Value is the second word after the tag header (first is the id) */
+    if (tag_ok(t_temp)) {
+        sample->temp_mc = mailbox_buffer[t_temp + 4];
+        sample->valid |= TELEM_VALID_TEMP;
+    }
+    if (tag_ok(t_arm)) {
+        sample->arm_clock = mailbox_buffer[t_arm + 4];
+        sample->valid |= TELEM_VALID_ARM_CLOCK;
+    }
+    if (tag_ok(t_core)) {
+        sample->core_clock = mailbox_buffer[t_core + 4];
+        sample->valid |= TELEM_VALID_CORE_CLOCK;
+    }
+    if (tag_ok(t_thr)) {
+        sample->throttled = mailbox_buffer[t_thr + 3];
+        sample->valid |= TELEM_VALID_THROTTLED;
+    }
+    if (tag_ok(t_vcore)) {
+        sample->volt_core = mailbox_buffer[t_vcore + 4];
+        sample->valid |= TELEM_VALID_VOLT_CORE;
+    }
+    if (tag_ok(t_vsdr)) {
+        sample->volt_sdram = mailbox_buffer[t_vsdr + 4];
+        sample->valid |= TELEM_VALID_VOLT_SDRAM;
+    }
+
+    mailbox_unlock();
+    return true;
+}
+
+/*
+ * telemetry_init - Reset history and take the first sample
+ */
+void telemetry_init(void) {
+    ring_head = 0;
+    ring_count = 0;
+    period_ticks = timer_us_to_ticks(TELEMETRY_PERIOD_MS * 1000);
+    next_sample = timer_ticks();
+    telemetry_poll();
+}
+
+/*
+ * telemetry_poll - Sample if the period has elapsed
+ * Returns: true if a new sample was added to the ring
+ */
+bool telemetry_poll(void) {
+    uint64_t now = timer_ticks();
+
+    if (now < next_sample) {
+        return false;
+    }
+
+    /* Stay on the fixed grid; skip missed periods rather than bursting */
+    next_sample += period_ticks;
+    if (next_sample <= now) {
+        next_sample = now + period_ticks;
+    }
+
+    if (!telemetry_sample(&ring[ring_head])) {
+        return false;
+    }
+
+    ring_head = (ring_head + 1) % TELEMETRY_RING_SIZE;
+    if (ring_count < TELEMETRY_RING_SIZE) {
+        ring_count++;
+    }
+
+    return true;
+}
+
+/*
+ * telemetry_latest - Most recent sample, NULL if none yet
+ */
+const telemetry_sample_t *telemetry_latest(void) {
+    if (ring_count == 0) {
+        return NULL;
+    }
+    return &ring[(ring_head + TELEMETRY_RING_SIZE - 1) % TELEMETRY_RING_SIZE];
+}
+
+/*
+ * telemetry_count - Number of samples held in the ring
+ */
+uint32_t telemetry_count(void) {
+    return ring_count;
+}
+
+/* Fold one value into a running min/max, sum kept by caller */
+static void stat_add(telemetry_stat_t *st, uint64_t *sum, uint32_t value) {
+    if (st->count == 0 || value < st->min) {
+        st->min = value;
+    }
+    if (st->count == 0 || value > st->max) {
+        st->max = value;
+    }
+    *sum += value;
+    st->count++;
+}
+
+static void stat_finish(telemetry_stat_t *st, uint64_t sum) {
+    st->avg = st->count ? (uint32_t)(sum / st->count) : 0;
+}
+
+/*
+ * telemetry_aggregate - Min/max/avg of each field over the ring
+ */
+void telemetry_aggregate(telemetry_agg_t *agg) {
+    uint64_t s_temp = 0, s_arm = 0, s_core = 0, s_vcore = 0, s_vsdr = 0;
+
+    for (uint32_t i = 0; i < sizeof(telemetry_agg_t); i++) {
+        ((uint8_t*)agg)[i] = 0;
+    }
+
+    for (uint32_t n = 0; n < ring_count; n++) {
+        const telemetry_sample_t *s = &ring[n];
+
+        if (s->valid & TELEM_VALID_TEMP) {
+            stat_add(&agg->temp_mc, &s_temp, s->temp_mc);
+        }
+        if (s->valid & TELEM_VALID_ARM_CLOCK) {
+            stat_add(&agg->arm_clock, &s_arm, s->arm_clock);
+        }
+        if (s->valid & TELEM_VALID_CORE_CLOCK) {
+            stat_add(&agg->core_clock, &s_core, s->core_clock);
+        }
+        if (s->valid & TELEM_VALID_VOLT_CORE) {
+            stat_add(&agg->volt_core, &s_vcore, s->volt_core);
+        }
+        if (s->valid & TELEM_VALID_VOLT_SDRAM) {
+            stat_add(&agg->volt_sdram, &s_vsdr, s->volt_sdram);
+        }
+        if (s->valid & TELEM_VALID_THROTTLED) {
+            agg->throttled_any |= s->throttled;
+        }
+    }
+
+    stat_finish(&agg->temp_mc, s_temp);
+    stat_finish(&agg->arm_clock, s_arm);
+    stat_finish(&agg->core_clock, s_core);
+    stat_finish(&agg->volt_core, s_vcore);
+    stat_finish(&agg->volt_sdram, s_vsdr);
+}
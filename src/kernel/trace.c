@@ -0,0 +1,91 @@
+/*
+ * trace.c - Event Tracing (rings and JSON export)
+ *
+ * Recording is inline in trace.h. The dump turns recording off, prints
+ * every core's ring oldest first and turns it back on, so the rings
+ * hold still while they are read (an event a core was already writing
+ * may still land). Timestamps are counter ticks since power-on,
+ * printed in microseconds with nanosecond decimals as the format
+ * expects.
+ */
+
+#include "trace.h"
+#include "timer.h"
+#include "kprintf.h"
+#include "sync.h"
+
+/* Lines framing the JSON in a serial log (see tools/trace_extract.py) */
+#define TRACE_START_LINE    "--- TRACE JSON BEGIN ---"
+#define TRACE_END_LINE      "--- TRACE JSON END ---"
+
+trace_ring_t trace_rings[NUM_CORES];
+volatile bool trace_enabled = true;
+
+/*
+ * trace_clear - Drop all recorded events
+ *
+ * Only safe while the other cores are not tracing (e.g. idle in WFE).
+ */
+void trace_clear(void) {
+    for (uint32_t core = 0; core < NUM_CORES; core++) {
+        trace_rings[core].head = 0;
+    }
+}
+
+/* Ticks to "us.nnn" without overflowing ticks * 10^9 */
+static void put_ts(uint64_t ticks, uint64_t freq) {
+    uint64_t ns = (ticks / freq) * 1000000000 + (ticks % freq) * 1000000000 / freq;
+    kprintf("%lu.%03lu", ns / 1000, ns % 1000);
+}
+
+/*
+ * trace_dump - Write all rings over serial as Chrome Trace Event JSON
+ *
+ * Events a core overwrote are gone; an end whose begin was lost shows
+ * up unmatched, which viewers ignore.
+ */
+void trace_dump(void) {
+    uint64_t freq = timer_freq();
+    bool was_enabled = trace_enabled;
+    bool first = true;
+
+    trace_enabled = false;
+    dsb(ish);
+
+    kprintf("\n" TRACE_START_LINE "\n{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    for (uint32_t core = 0; core < NUM_CORES; core++) {
+        const trace_ring_t *ring = &trace_rings[core];
+        uint64_t head = ring->head;
+        uint64_t start = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+
+        if (head == 0) {
+            continue;
+        }
+
+        kprintf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,"
+                "\"args\":{\"name\":\"core %u\"}}",
+                first ? "" : ",\n", core, core);
+        first = false;
+
+        for (uint64_t i = start; i < head; i++) {
+            const trace_event_t *ev = &ring->events[i & (TRACE_RING_SIZE - 1)];
+            char phase = ev->ts_phase >> 56;
+
+            kprintf(",\n{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":0,\"tid\":%u,\"ts\":",
+                    ev->name, phase, core);
+            put_ts(ev->ts_phase & TRACE_TS_MASK, freq);
+            kprintf(phase == TRACE_INSTANT ? ",\"s\":\"t\"}" : "}");
+        }
+        if (start) {
+            kprintf(",\n{\"name\":\"%lu events dropped\",\"ph\":\"i\",\"pid\":0,\"tid\":%u,"
+                    "\"s\":\"t\",\"ts\":", start, core);
+            put_ts(ring->events[start & (TRACE_RING_SIZE - 1)].ts_phase & TRACE_TS_MASK, freq);
+            kprintf("}");
+        }
+    }
+
+    kprintf("\n]}\n" TRACE_END_LINE "\n");
+
+    trace_enabled = was_enabled;
+}
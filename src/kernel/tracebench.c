@@ -0,0 +1,60 @@
+/*
+ * tracebench.c - Trace Event Cost
+ *
+ * Records events back to back on core 0 and reports PMU cycles per
+ * event, with tracing on and with it switched off at run time. Core
+ * 0's ring is saved and restored around the run so the boot trace
+ * survives for a later dump.
+ */
+
+#include "bench.h"
+#include "trace.h"
+#include "pmu.h"
+#include "timer.h"
+#include "kprintf.h"
+#include "string.h"
+
+#define TRACE_ROUNDS    100000
+
+static trace_ring_t saved_ring;
+
+static uint64_t record_events(uint64_t *ticks) {
+    uint64_t t0 = timer_ticks();
+    uint64_t c0 = pmu_cycles();
+
+    for (uint32_t i = 0; i < TRACE_ROUNDS; i++) {
+        trace_instant("tracebench");
+    }
+
+    uint64_t cycles = pmu_cycles() - c0;
+    *ticks = timer_ticks() - t0;
+    return cycles;
+}
+
+/*
+ * tracebench_run - Measure the cost of recording one event
+ */
+void tracebench_run(void) {
+    uint64_t cycles, ticks;
+    char text[48];
+    bool was_enabled = trace_enabled;
+
+    bench_header("trace");
+    pmu_init();
+    memcpy(&saved_ring, &trace_rings[0], sizeof(saved_ring));
+
+    trace_enabled = true;
+    cycles = record_events(&ticks);
+    bench_result("trace_instant", 1, TRACE_ROUNDS, ticks);
+    kformat(text, sizeof(text), "%lu cycles/event", cycles / TRACE_ROUNDS);
+    bench_note("", text);
+
+    trace_enabled = false;
+    cycles = record_events(&ticks);
+    bench_result("trace_instant (off)", 1, TRACE_ROUNDS, ticks);
+    kformat(text, sizeof(text), "%lu cycles/event", cycles / TRACE_ROUNDS);
+    bench_note("", text);
+
+    memcpy(&trace_rings[0], &saved_ring, sizeof(saved_ring));
+    trace_enabled = was_enabled;
+}
@@ -0,0 +1,448 @@
+/*
+ * gfx.c - 2D Primitives
+ *
+ * Everything ends in gfx_hspan(): lines emit one span per run of
+ * pixels on a row, circles and rounded rectangles one span per run of
+ * the midpoint algorithm (outline) or per row (fill), polygons one
+ * span per pair of edge crossings.
+ */
+
+#include "gfx.h"
+#include "font8x8.h"
+
+/* 64-bit view of the pixel rows, allowed to alias the uint32_t pixels */
+typedef uint64_t __attribute__((may_alias)) pixel_pair_t;
+
+/*
+ * gfx_screen - Describe the framebuffer as a surface
+ */
+void gfx_screen(gfx_surface_t *s) {
+    framebuffer_t *fb = fb_get_info();
+
+    s->pixels = (uint32_t *)fb->buffer;
+    s->stride = fb->pitch / 4;
+    s->x = 0;
+    s->y = 0;
+    s->width = fb->width;
+    s->height = fb->height;
+}
+
+/*
+ * gfx_fill_words - Store one pixel value into a run of pixels
+ * @dst: First pixel (4-byte aligned)
+ * @count: Pixels
+ * @pixel: Value (see gfx_pixel)
+ *
+ * Aligns to 8 bytes, then stores pixel pairs, four pairs per loop.
+ */
+void gfx_fill_words(uint32_t *dst, uint32_t count, uint32_t pixel) {
+    if (((uint64_t)dst & 4) && count) {
+        *dst++ = pixel;
+        count--;
+    }
+
+    uint64_t pair = pixel | ((uint64_t)pixel << 32);
+    pixel_pair_t *d = (pixel_pair_t *)dst;
+
+    while (count >= 8) {
+        d[0] = pair;
+        d[1] = pair;
+        d[2] = pair;
+        d[3] = pair;
+        d += 4;
+        count -= 8;
+    }
+    while (count >= 2) {
+        *d++ = pair;
+        count -= 2;
+    }
+    if (count) {
+        *(uint32_t *)d = pixel;
+    }
+}
+
+/*
+ * gfx_hspan - Fill pixels x0..x1 (inclusive, either order) of row y
+ */
+void gfx_hspan(const gfx_surface_t *s, int32_t x0, int32_t x1, int32_t y, uint32_t pixel) {
+    if (x0 > x1) {
+        int32_t t = x0;
+        x0 = x1;
+        x1 = t;
+    }
+
+    y -= s->y;
+    x0 -= s->x;
+    x1 -= s->x;
+    if (y < 0 || y >= (int32_t)s->height || x1 < 0 || x0 >= (int32_t)s->width) {
+        return;
+    }
+    if (x0 < 0) {
+        x0 = 0;
+    }
+    if (x1 >= (int32_t)s->width) {
+        x1 = s->width - 1;
+    }
+
+    gfx_fill_words(s->pixels + (uint32_t)y * s->stride + x0, x1 - x0 + 1, pixel);
+}
+
+/* Fill pixels y0..y1 (inclusive, y0 <= y1) of column x */
+static void vspan(const gfx_surface_t *s, int32_t x, int32_t y0, int32_t y1, uint32_t pixel) {
+    x -= s->x;
+    y0 -= s->y;
+    y1 -= s->y;
+    if (x < 0 || x >= (int32_t)s->width || y1 < 0 || y0 >= (int32_t)s->height) {
+        return;
+    }
+    if (y0 < 0) {
+        y0 = 0;
+    }
+    if (y1 >= (int32_t)s->height) {
+        y1 = s->height - 1;
+    }
+
+    uint32_t *p = s->pixels + (uint32_t)y0 * s->stride + x;
+    for (int32_t y = y0; y <= y1; y++) {
+        *p = pixel;
+        p += s->stride;
+    }
+}
+
+/*
+ * gfx_line - Draw a line between two points (both included)
+ *
+ * Bresenham, emitting each run of pixels on a row as one span:
+ * shallow lines become a few long spans, horizontal and vertical
+ * lines a single span or column.
+ */
+void gfx_line(const gfx_surface_t *s, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+              color_t color) {
+    uint32_t pixel = gfx_pixel(color);
+
+    if (y0 == y1) {
+        gfx_hspan(s, x0, x1, y0, pixel);
+        return;
+    }
+    if (x0 == x1) {
+        vspan(s, x0, y0 < y1 ? y0 : y1, y0 < y1 ? y1 : y0, pixel);
+        return;
+    }
+
+    int32_t dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int32_t dy = y1 > y0 ? y0 - y1 : y1 - y0;      /* Negative */
+    int32_t sx = x1 > x0 ? 1 : -1;
+    int32_t sy = y1 > y0 ? 1 : -1;
+    int32_t err = dx + dy;
+    int32_t run = x0;
+
+    while (x0 != x1 || y0 != y1) {
+        int32_t e2 = 2 * err;
+        int32_t last = x0;
+
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            gfx_hspan(s, run, last, y0, pixel);
+            err += dx;
+            y0 += sy;
+            run = x0;
+        }
+    }
+    gfx_hspan(s, run, x0, y0, pixel);
+}
+
+/*
+ * gfx_rect - Draw a rectangle outline
+ */
+void gfx_rect(const gfx_surface_t *s, int32_t x, int32_t y, int32_t w, int32_t h,
+              color_t color) {
+    uint32_t pixel = gfx_pixel(color);
+
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    gfx_hspan(s, x, x + w - 1, y, pixel);
+    gfx_hspan(s, x, x + w - 1, y + h - 1, pixel);
+    if (h > 2) {
+        vspan(s, x, y + 1, y + h - 2, pixel);
+        vspan(s, x + w - 1, y + 1, y + h - 2, pixel);
+    }
+}
+
+/*
+ * gfx_fill_rect - Fill a rectangle
+ */
+void gfx_fill_rect(const gfx_surface_t *s, int32_t x, int32_t y, int32_t w, int32_t h,
+                   color_t color) {
+    uint32_t pixel = gfx_pixel(color);
+
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    for (int32_t row = y; row < y + h; row++) {
+        gfx_hspan(s, x, x + w - 1, row, pixel);
+    }
+}
+
+/*
+ * rounded - Midpoint circle split into four corner arcs
+ * @l, @t, @r, @b: Centres of the corner arcs (left/right x, top/bottom y)
+ * @rad: Corner radius
+ * @fill: Fill the shape instead of drawing the outline
+ *
+ * A circle is the case l == r, t == b. With (x, y) walking one octant
+ * (x <= y), the steep octants put one pixel on rows t - x and b + x,
+ * the shallow ones a run of x on rows t - y and b + y that is emitted
+ * when y is about to change. The first run (x from 0) also covers the
+ * straight top and bottom edges.
+ */
+static void rounded(const gfx_surface_t *s, int32_t l, int32_t t, int32_t r, int32_t b,
+                    int32_t rad, bool fill, uint32_t pixel) {
+    int32_t x = 0, y = rad, d = 1 - rad, run = 0;
+
+    while (x <= y) {
+        if (fill) {
+            gfx_hspan(s, l - y, r + y, t - x, pixel);
+            gfx_hspan(s, l - y, r + y, b + x, pixel);
+        } else {
+            gfx_hspan(s, l - y, l - y, t - x, pixel);
+            gfx_hspan(s, r + y, r + y, t - x, pixel);
+            gfx_hspan(s, l - y, l - y, b + x, pixel);
+            gfx_hspan(s, r + y, r + y, b + x, pixel);
+        }
+
+        if (d >= 0 || x + 1 > y) {
+            if (fill || run == 0) {
+                gfx_hspan(s, l - x, r + x, t - y, pixel);
+                gfx_hspan(s, l - x, r + x, b + y, pixel);
+            } else {
+                gfx_hspan(s, l - x, l - run, t - y, pixel);
+                gfx_hspan(s, r + run, r + x, t - y, pixel);
+                gfx_hspan(s, l - x, l - run, b + y, pixel);
+                gfx_hspan(s, r + run, r + x, b + y, pixel);
+            }
+            run = x + 1;
+        }
+
+        if (d < 0) {
+            d += 2 * x + 3;
+        } else {
+            d += 2 * (x - y) + 5;
+            y--;
+        }
+        x++;
+    }
+
+    /* Straight sides between the top and bottom arcs */
+    if (b - t > 1) {
+        if (fill) {
+            for (int32_t row = t + 1; row < b; row++) {
+                gfx_hspan(s, l - rad, r + rad, row, pixel);
+            }
+        } else {
+            vspan(s, l - rad, t + 1, b - 1, pixel);
+            vspan(s, r + rad, t + 1, b - 1, pixel);
+        }
+    }
+}
+
+/* Radius that fits a w x h rectangle */
+static int32_t clamp_radius(int32_t w, int32_t h, int32_t r) {
+    int32_t max = (w < h ? w - 1 : h - 1) / 2;
+    if (r > max) {
+        r = max;
+    }
+    return r < 0 ? 0 : r;
+}
+
+/*
+ * gfx_round_rect - Draw a rectangle outline with rounded corners
+ * @r: Corner radius (clamped to half the shorter side)
+ */
+void gfx_round_rect(const gfx_surface_t *s, int32_t x, int32_t y, int32_t w, int32_t h,
+                    int32_t r, color_t color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    r = clamp_radius(w, h, r);
+    rounded(s, x + r, y + r, x + w - 1 - r, y + h - 1 - r, r, false, gfx_pixel(color));
+}
+
+/*
+ * gfx_fill_round_rect - Fill a rectangle with rounded corners
+ */
+void gfx_fill_round_rect(const gfx_surface_t *s, int32_t x, int32_t y, int32_t w, int32_t h,
+                         int32_t r, color_t color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    r = clamp_radius(w, h, r);
+    rounded(s, x + r, y + r, x + w - 1 - r, y + h - 1 - r, r, true, gfx_pixel(color));
+}
+
+/*
+ * gfx_circle - Draw a circle outline
+ */
+void gfx_circle(const gfx_surface_t *s, int32_t cx, int32_t cy, int32_t r, color_t color) {
+    if (r >= 0) {
+        rounded(s, cx, cy, cx, cy, r, false, gfx_pixel(color));
+    }
+}
+
+/*
+ * gfx_fill_circle - Fill a circle
+ */
+void gfx_fill_circle(const gfx_surface_t *s, int32_t cx, int32_t cy, int32_t r, color_t color) {
+    if (r >= 0) {
+        rounded(s, cx, cy, cx, cy, r, true, gfx_pixel(color));
+    }
+}
+
+/*
+ * gfx_text - Draw a string, like fb_draw_string() ('\n' starts a new line)
+ *
+ * Glyphs fully on the surface are stored a row of 8 pixels at a time;
+ * those on an edge are clipped per pixel.
+ */
+void gfx_text(const gfx_surface_t *s, int32_t x, int32_t y, const char *str,
+              color_t fg, color_t bg) {
+    uint32_t fgp = gfx_pixel(fg), bgp = gfx_pixel(bg);
+    int32_t orig_x = x;
+
+    for (; *str; str++) {
+        if (*str == '\n') {
+            x = orig_x;
+            y += FONT_HEIGHT + 2;
+            continue;
+        }
+
+        int32_t lx = x - s->x, ly = y - s->y;
+        x += FONT_WIDTH;
+        if (lx <= -FONT_WIDTH || lx >= (int32_t)s->width ||
+            ly <= -FONT_HEIGHT || ly >= (int32_t)s->height) {
+            continue;
+        }
+
+        const uint8_t *glyph = fb_glyph(*str);
+        bool inside = lx >= 0 && ly >= 0 && lx + FONT_WIDTH <= (int32_t)s->width &&
+                      ly + FONT_HEIGHT <= (int32_t)s->height;
+
+        for (int32_t row = 0; row < FONT_HEIGHT; row++) {
+            if (!inside && (uint32_t)(ly + row) >= s->height) {
+                continue;
+            }
+            uint32_t *p = s->pixels + (uint32_t)(ly + row) * s->stride + lx;
+            uint8_t bits = glyph[row];
+            for (int32_t col = 0; col < FONT_WIDTH; col++) {
+                if (inside || (uint32_t)(lx + col) < s->width) {
+                    p[col] = (bits & (0x80 >> col)) ? fgp : bgp;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * gfx_polygon - Draw a closed polygon outline
+ */
+void gfx_polygon(const gfx_surface_t *s, const gfx_point_t *pts, uint32_t n, color_t color) {
+    for (uint32_t i = 0; i < n; i++) {
+        const gfx_point_t *a = &pts[i];
+        const gfx_point_t *b = &pts[i + 1 < n ? i + 1 : 0];
+        gfx_line(s, a->x, a->y, b->x, b->y, color);
+    }
+}
+
+/* Non-horizontal polygon edge, x in 16.16 fixed point */
+typedef struct {
+    int32_t y0, y1;         /* Rows y0 <= y < y1 cross this edge */
+    int64_t x;              /* At y0 */
+    int64_t dx;             /* Per row */
+} poly_edge_t;
+
+/*
+ * gfx_fill_polygon - Fill a polygon (even-odd rule)
+ * @pts: Vertices, in order; the last connects back to the first
+ * @n: Vertex count (3 to GFX_POLY_MAX)
+ * Returns: false if n is out of range
+ *
+ * Each row is sampled at pixel centres: the crossings of the edges
+ * active on it are sorted and every other interval is filled.
+ */
+bool gfx_fill_polygon(const gfx_surface_t *s, const gfx_point_t *pts, uint32_t n,
+                      color_t color) {
+    poly_edge_t edges[GFX_POLY_MAX];
+    int64_t xs[GFX_POLY_MAX];
+    uint32_t pixel = gfx_pixel(color);
+    uint32_t count = 0;
+
+    if (n < 3 || n > GFX_POLY_MAX) {
+        return false;
+    }
+
+    int32_t ymin = pts[0].y, ymax = pts[0].y;
+
+    for (uint32_t i = 0; i < n; i++) {
+        gfx_point_t a = pts[i];
+        gfx_point_t b = pts[i + 1 < n ? i + 1 : 0];
+
+        if (a.y == b.y) {
+            continue;
+        }
+        if (a.y > b.y) {
+            gfx_point_t t = a;
+            a = b;
+            b = t;
+        }
+        poly_edge_t *e = &edges[count++];
+        e->y0 = a.y;
+        e->y1 = b.y;
+        e->x = (int64_t)a.x << 16;
+        e->dx = ((int64_t)(b.x - a.x) << 16) / (b.y - a.y);
+        if (a.y < ymin) {
+            ymin = a.y;
+        }
+        if (b.y > ymax) {
+            ymax = b.y;
+        }
+    }
+
+    /* Only rows on the surface */
+    if (ymin < s->y) {
+        ymin = s->y;
+    }
+    if (ymax > s->y + (int32_t)s->height) {
+        ymax = s->y + s->height;
+    }
+
+    for (int32_t y = ymin; y < ymax; y++) {
+        uint32_t k = 0;
+
+        for (uint32_t i = 0; i < count; i++) {
+            const poly_edge_t *e = &edges[i];
+            if (y < e->y0 || y >= e->y1) {
+                continue;
+            }
+            int64_t x = e->x + e->dx * (y - e->y0);
+            uint32_t j = k++;
+            while (j > 0 && xs[j - 1] > x) {
+                xs[j] = xs[j - 1];
+                j--;
+            }
+            xs[j] = x;
+        }
+
+        /* Pixels whose centre lies in [xs[i], xs[i + 1]) */
+        for (uint32_t i = 0; i + 1 < k; i += 2) {
+            int32_t x0 = (xs[i] + 0xFFFF) >> 16;
+            int32_t x1 = ((xs[i + 1] + 0xFFFF) >> 16) - 1;
+            if (x0 <= x1) {
+                gfx_hspan(s, x0, x1, y, pixel);
+            }
+        }
+    }
+    return true;
+}
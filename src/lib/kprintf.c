@@ -0,0 +1,381 @@
+/*
+ * kprintf.c - Formatted Output
+ *
+ * The formatter walks the format string once, copying literal text as
+ * it scans and converted numbers straight to the output. Numbers are
+ * built backwards in a KFMT_NUM_MAX stack buffer.
+ */
+
+#include "kprintf.h"
+#include "uart.h"
+
+#define FLAG_LEFT       (1 << 0)
+#define FLAG_ZERO       (1 << 1)
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char hex_lower[] = "0123456789abcdef";
+static const char hex_upper[] = "0123456789ABCDEF";
+
+/*
+ * kfmt_dec - Decimal digits of a value, written backwards
+ * @end: One past the last digit
+ * @value: Number
+ * Returns: First digit
+ *
+ * Two digits per step. Dividing by the constant 100 compiles to a
+ * multiply-high and shift; values that fit 32 bits take the cheaper
+ * 32-bit multiply.
+ */
+char *kfmt_dec(char *end, uint64_t value) {
+    char *p = end;
+
+    while (value > 0xFFFFFFFFu) {
+        uint64_t q = value / 100;
+        const char *d = &digit_pairs[(value - q * 100) * 2];
+        *--p = d[1];
+        *--p = d[0];
+        value = q;
+    }
+
+    uint32_t v = (uint32_t)value;
+    while (v >= 100) {
+        uint32_t q = v / 100;
+        const char *d = &digit_pairs[(v - q * 100) * 2];
+        *--p = d[1];
+        *--p = d[0];
+        v = q;
+    }
+    if (v >= 10) {
+        *--p = digit_pairs[v * 2 + 1];
+        *--p = digit_pairs[v * 2];
+    } else {
+        *--p = '0' + v;
+    }
+    return p;
+}
+
+/*
+ * kfmt_hex - Hex digits of a value, written backwards
+ * @end: One past the last digit
+ * @value: Number
+ * @upper: Use A-F instead of a-f
+ * Returns: First digit
+ */
+char *kfmt_hex(char *end, uint64_t value, bool upper) {
+    const char *digits = upper ? hex_upper : hex_lower;
+    char *p = end;
+
+    do {
+        *--p = digits[value & 0xF];
+        value >>= 4;
+    } while (value);
+    return p;
+}
+
+/*
+ * Output state. kformat writes straight into the caller's buffer
+ * (sink == NULL: excess is dropped); sinks get a stack staging buffer
+ * that is flushed when full and at the end. The write pointer itself
+ * is kept in a local and passed along: char stores may alias this
+ * struct, so o->p would be reloaded and stored for every byte.
+ */
+typedef struct {
+    char *end;
+    char *start;
+    ksink_t sink;
+    void *ctx;
+    size_t flushed;
+} kout_t;
+
+static char *out_flush(kout_t *o, char *p) {
+    if (o->sink && p > o->start) {
+        o->sink(o->ctx, o->start, p - o->start);
+        o->flushed += p - o->start;
+        p = o->start;
+    }
+    return p;
+}
+
+/* Slow path of out_bytes: the output is full */
+static char *out_bytes_slow(kout_t *o, char *p, const char *s, size_t n) {
+    while (n) {
+        if (p == o->end) {
+            if (!o->sink) {
+                return p;
+            }
+            p = out_flush(o, p);
+        }
+        *p++ = *s++;
+        n--;
+    }
+    return p;
+}
+
+static inline char *out_bytes(kout_t *o, char *p, const char *s, size_t n) {
+    if ((size_t)(o->end - p) < n) {
+        return out_bytes_slow(o, p, s, n);
+    }
+    while (n--) {
+        *p++ = *s++;
+    }
+    return p;
+}
+
+static char *out_fill(kout_t *o, char *p, char c, int32_t n) {
+    while (n-- > 0) {
+        if (p == o->end) {
+            if (!o->sink) {
+                return p;
+            }
+            p = out_flush(o, p);
+        }
+        *p++ = c;
+    }
+    return p;
+}
+
+/* Core formatter: one pass over fmt (see kprintf.h); returns the write pointer */
+static char *kvprintf_out(kout_t *o, char *p, const char *fmt, va_list ap) {
+    char num[KFMT_NUM_MAX];
+    char c;
+
+    while (1) {
+        /* Literal run, copied while scanning for the next conversion */
+        while ((c = *fmt) != '%') {
+            if (c == '\0') {
+                return p;
+            }
+            if (p == o->end) {
+                if (!o->sink) {
+                    return p;
+                }
+                p = out_flush(o, p);
+            }
+            *p++ = c;
+            fmt++;
+        }
+        fmt++;
+
+        uint32_t flags = 0;
+        int32_t width = 0;
+        int32_t prec = -1;
+        uint32_t longs = 0;
+
+        for (;; fmt++) {
+            if (*fmt == '-') {
+                flags |= FLAG_LEFT;
+            } else if (*fmt == '0') {
+                flags |= FLAG_ZERO;
+            } else {
+                break;
+            }
+        }
+
+        if (*fmt == '*') {
+            width = va_arg(ap, int);
+            if (width < 0) {
+                flags |= FLAG_LEFT;
+                width = -width;
+            }
+            fmt++;
+        } else {
+            while (*fmt >= '0' && *fmt <= '9') {
+                width = width * 10 + (*fmt++ - '0');
+            }
+        }
+
+        if (*fmt == '.') {
+            fmt++;
+            prec = 0;
+            if (*fmt == '*') {
+                prec = va_arg(ap, int);
+                fmt++;
+            } else {
+                while (*fmt >= '0' && *fmt <= '9') {
+                    prec = prec * 10 + (*fmt++ - '0');
+                }
+            }
+        }
+
+        while (*fmt == 'l' || *fmt == 'z') {
+            longs++;
+            fmt++;
+        }
+
+        const char *body;
+        int32_t len = -1;
+        char sign = 0;
+        bool numeric = true;
+        uint64_t value;
+        char *end = num + sizeof(num);
+
+        switch (*fmt) {
+        case 'd':
+        case 'i': {
+            int64_t v = longs ? va_arg(ap, int64_t) : va_arg(ap, int32_t);
+            if (v < 0) {
+                sign = '-';
+                value = -(uint64_t)v;
+            } else {
+                value = v;
+            }
+            body = kfmt_dec(end, value);
+            break;
+        }
+        case 'u':
+            value = longs ? va_arg(ap, uint64_t) : va_arg(ap, uint32_t);
+            body = kfmt_dec(end, value);
+            break;
+        case 'x':
+        case 'X':
+            value = longs ? va_arg(ap, uint64_t) : va_arg(ap, uint32_t);
+            body = kfmt_hex(end, value, *fmt == 'X');
+            break;
+        case 'p':
+            value = (uint64_t)va_arg(ap, void *);
+            body = kfmt_hex(end, value, false);
+            p = out_bytes(o, p, "0x", 2);
+            break;
+        case 's':
+            body = va_arg(ap, const char *);
+            if (body == NULL) {
+                body = "(null)";
+            }
+            len = 0;
+            while (body[len] && (prec < 0 || len < prec)) {
+                len++;
+            }
+            numeric = false;
+            break;
+        case 'c':
+            num[0] = (char)va_arg(ap, int);
+            body = num;
+            end = num + 1;
+            numeric = false;
+            break;
+        case '\0':
+            return p;
+        default:        /* "%%" and unknown conversions print themselves */
+            body = fmt;
+            end = (char *)fmt + 1;
+            numeric = false;
+            break;
+        }
+        fmt++;
+
+        if (len < 0) {
+            len = end - body;
+        }
+
+        /* Common case: no width or precision */
+        if (width == 0 && prec < 0) {
+            if (sign) {
+                p = out_bytes(o, p, &sign, 1);
+            }
+            p = out_bytes(o, p, body, len);
+            continue;
+        }
+
+        /* Precision: minimum digits (a zero value with .0 stays "0") */
+        int32_t zeros = numeric && prec > len ? prec - len : 0;
+        int32_t fill = width - len - zeros - (sign ? 1 : 0);
+
+        if (numeric && (flags & FLAG_ZERO) && !(flags & FLAG_LEFT) && prec < 0 && fill > 0) {
+            zeros += fill;
+            fill = 0;
+        }
+
+        if (!(flags & FLAG_LEFT)) {
+            p = out_fill(o, p, ' ', fill);
+        }
+        if (sign) {
+            p = out_bytes(o, p, &sign, 1);
+        }
+        p = out_fill(o, p, '0', zeros);
+        p = out_bytes(o, p, body, len);
+        if (flags & FLAG_LEFT) {
+            p = out_fill(o, p, ' ', fill);
+        }
+    }
+}
+
+/*
+ * kvprintf_sink - Format into a sink
+ * @sink: Output function, called with chunks of up to 64 characters
+ * @ctx: Passed to sink
+ * @fmt: Format string (see kprintf.h)
+ * @ap: Arguments
+ * Returns: Characters produced
+ */
+size_t kvprintf_sink(ksink_t sink, void *ctx, const char *fmt, va_list ap) {
+    char stage[64];
+    kout_t o = { stage + sizeof(stage), stage, sink, ctx, 0 };
+
+    char *p = kvprintf_out(&o, stage, fmt, ap);
+    out_flush(&o, p);
+    return o.flushed;
+}
+
+/*
+ * kvformat - Format into a buffer
+ * @buf: Destination, always NUL-terminated when size > 0
+ * @size: Bytes available in buf
+ * @fmt: Format string
+ * @ap: Arguments
+ * Returns: Characters written, excluding the NUL (output beyond
+ *          size - 1 is dropped)
+ */
+size_t kvformat(char *buf, size_t size, const char *fmt, va_list ap) {
+    if (size == 0) {
+        return 0;
+    }
+
+    kout_t o = { buf + size - 1, buf, NULL, NULL, 0 };
+    char *p = kvprintf_out(&o, buf, fmt, ap);
+    *p = '\0';
+    return p - buf;
+}
+
+/*
+ * kformat - Format into a buffer (see kvformat)
+ */
+size_t kformat(char *buf, size_t size, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    size_t n = kvformat(buf, size, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+/* UART sink: '\n' becomes "\r\n" like uart_puts */
+static void uart_sink(void *ctx, const char *s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] == '\n') {
+            uart_putc('\r');
+        }
+        uart_putc(s[i]);
+    }
+}
+
+/*
+ * kprintf - Format to the serial port
+ * Returns: Characters produced (before newline translation)
+ */
+size_t kprintf(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    size_t n = kvprintf_sink(uart_sink, NULL, fmt, ap);
+    va_end(ap);
+    return n;
+}
@@ -0,0 +1,166 @@
+/*
+ * qoi.c - Streaming QOI Decoder
+ *
+ * The hot loop keeps the previous pixel packed in a register and only
+ * unpacks channels for DIFF/LUMA ops; runs are written with a plain
+ * store loop. The end padding (8 bytes) is never part of an op, so
+ * reading up to 5 bytes from any p < data_end stays in bounds.
+ */
+
+#include "qoi.h"
+
+#define QOI_OP_INDEX    0x00    /* 00xxxxxx */
+#define QOI_OP_DIFF     0x40    /* 01xxxxxx */
+#define QOI_OP_LUMA     0x80    /* 10xxxxxx */
+#define QOI_OP_RUN      0xC0    /* 11xxxxxx */
+#define QOI_OP_RGB      0xFE
+#define QOI_OP_RGBA     0xFF
+#define QOI_MASK_2      0xC0
+
+#define QOI_MAGIC       0x716F6966  /* "qoif" */
+
+/* Sanity bound on dimensions (the format allows 400 Mpixels) */
+#define QOI_MAX_DIM     8192
+
+static inline uint32_t rd32_be(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+/*
+ * Index hash (r*3 + g*5 + b*7 + a*11) % 64 on a packed 0xAARRGGBB pixel:
+ * spread the four channels into 16-bit slots (b, r, g, a from the bottom),
+ * then one multiply sums them, weighted, into the top slot. Slots cannot
+ * carry into each other (4 * 255 * 11 < 65536).
+ */
+static inline uint32_t qoi_hash(uint32_t px) {
+    uint64_t v = ((uint64_t)(px & 0xFF00FF00) << 24) | (px & 0x00FF00FF);
+    return (uint32_t)((v * (11 + (5ull << 16) + (3ull << 32) + (7ull << 48))) >> 48) & 63;
+}
+
+static inline uint32_t pack(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+    return (a << 24) | ((r & 0xFF) << 16) | ((g & 0xFF) << 8) | (b & 0xFF);
+}
+
+/*
+ * qoi_decode_init - Parse the header and reset decoder state
+ * @dec: Decoder
+ * @data: QOI file contents
+ * @size: Bytes of data
+ * Returns: false if the header is invalid
+ */
+bool qoi_decode_init(qoi_decoder_t *dec, const uint8_t *data, uint32_t size) {
+    if (size < QOI_HEADER_SIZE + QOI_PADDING_SIZE || rd32_be(data) != QOI_MAGIC) {
+        return false;
+    }
+
+    dec->width = rd32_be(data + 4);
+    dec->height = rd32_be(data + 8);
+    dec->channels = data[12];
+
+    if (dec->width == 0 || dec->height == 0 ||
+        dec->width > QOI_MAX_DIM || dec->height > QOI_MAX_DIM ||
+        (dec->channels != QOI_CHANNELS_RGB && dec->channels != QOI_CHANNELS_RGBA)) {
+        return false;
+    }
+
+    dec->p = data + QOI_HEADER_SIZE;
+    dec->data_end = data + size - QOI_PADDING_SIZE;
+    dec->row = 0;
+    dec->px = 0xFF000000;
+    dec->run = 0;
+    for (uint32_t i = 0; i < 64; i++) {
+        dec->index[i] = 0;
+    }
+
+    return true;
+}
+
+/*
+ * qoi_decode_row - Decode the next row
+ * @dec: Decoder from qoi_decode_init()
+ * @dst: dec->width pixels (0xAARRGGBB)
+ * Returns: false once every row has been decoded
+ *
+ * Truncated data repeats the last pixel, as the reference decoder does.
+ */
+bool qoi_decode_row(qoi_decoder_t *dec, uint32_t *dst) {
+    if (dec->row >= dec->height) {
+        return false;
+    }
+
+    const uint8_t *p = dec->p;
+    const uint8_t *data_end = dec->data_end;
+    uint32_t *index = dec->index;
+    uint32_t px = dec->px;
+    uint32_t run = dec->run;
+    uint32_t *end = dst + dec->width;
+
+    while (dst < end) {
+        if (run > 0) {
+            uint32_t n = (uint32_t)(end - dst);
+            if (n > run) {
+                n = run;
+            }
+            run -= n;
+            while (n--) {
+                *dst++ = px;
+            }
+            continue;
+        }
+
+        if (p >= data_end) {
+            run = (uint32_t)(end - dst);
+            continue;
+        }
+
+        uint32_t op = *p++;
+
+        if (op == QOI_OP_RGB) {
+            px = (px & 0xFF000000) | ((uint32_t)p[0] << 16) | (p[1] << 8) | p[2];
+            p += 3;
+        } else if (op == QOI_OP_RGBA) {
+            px = pack(p[0], p[1], p[2], p[3]);
+            p += 4;
+        } else {
+            switch (op & QOI_MASK_2) {
+            case QOI_OP_INDEX:
+                *dst++ = px = index[op];
+                continue;               /* Already in the index */
+
+            case QOI_OP_DIFF: {
+                uint32_t r = (px >> 16) + ((op >> 4) & 3) - 2;
+                uint32_t g = (px >> 8) + ((op >> 2) & 3) - 2;
+                uint32_t b = px + (op & 3) - 2;
+                px = pack(r, g, b, px >> 24);
+                break;
+            }
+
+            case QOI_OP_LUMA: {
+                uint32_t b2 = *p++;
+                uint32_t vg = (op & 0x3F) - 32;
+                uint32_t r = (px >> 16) + vg - 8 + ((b2 >> 4) & 0x0F);
+                uint32_t g = (px >> 8) + vg;
+                uint32_t b = px + vg - 8 + (b2 & 0x0F);
+                px = pack(r, g, b, px >> 24);
+                break;
+            }
+
+            default:    /* QOI_OP_RUN: same pixel, 1..62 times */
+                /* Hashed like any other op, as the reference decoder does;
+                   matters for the initial pixel, never stored otherwise */
+                index[qoi_hash(px)] = px;
+                run = (op & 0x3F) + 1;
+                continue;
+            }
+        }
+
+        index[qoi_hash(px)] = px;
+        *dst++ = px;
+    }
+
+    dec->p = p;
+    dec->px = px;
+    dec->run = run;
+    dec->row++;
+    return true;
+}
@@ -3,6 +3,7 @@
  */
 
 #include "string.h"
+#include "kprintf.h"
 
 void *memset(void *s, int c, size_t n) {
     uint8_t *p = (uint8_t *)s;
@@ -40,12 +41,45 @@ char *strcat(char *dest, const char *src) {
     return dest;
 }
 
+int strcmp(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return (uint8_t)*a - (uint8_t)*b;
+}
+
 static const char hex_chars[] = "0123456789ABCDEF";
 
+/* Base 10 and 16 without a runtime divide (see kprintf.c) */
+static bool fast_base(uint64_t value, char *buffer, int base) {
+    char tmp[KFMT_NUM_MAX];
+    char *end = tmp + sizeof(tmp);
+    char *p;
+    
+    if (base == 10) {
+        p = kfmt_dec(end, value);
+    } else if (base == 16) {
+        p = kfmt_hex(end, value, true);
+    } else {
+        return false;
+    }
+    
+    while (p < end) {
+        *buffer++ = *p++;
+    }
+    *buffer = '\0';
+    return true;
+}
+
 void utoa(uint32_t value, char *buffer, int base) {
     char tmp[33];
     char *p = tmp;
     
+    if (fast_base(value, buffer, base)) {
+        return;
+    }
+    
     if (value == 0) {
         *buffer++ = '0';
         *buffer = '\0';
@@ -75,6 +109,10 @@ void u64toa(uint64_t value, char *buffer, int base) {
     char tmp[65];
     char *p = tmp;
     
+    if (fast_base(value, buffer, base)) {
+        return;
+    }
+    
     if (value == 0) {
         *buffer++ = '0';
         *buffer = '\0';
@@ -134,6 +172,26 @@ void format_mb(uint32_t bytes, char *buffer) {
     *buffer = '\0';
 }
 
+/* Fixed-point thousandths, e.g. 48312 -> "48.3" with 1 decimal */
+void format_milli(uint32_t milli, uint32_t decimals, char *buffer) {
+    utoa(milli / 1000, buffer, 10);
+    if (decimals == 0) {
+        return;
+    }
+    
+    /* Find end */
+    while (*buffer) buffer++;
+    
+    *buffer++ = '.';
+    uint32_t frac = milli % 1000;
+    for (uint32_t i = 0; i < decimals && i < 3; i++) {
+        frac *= 10;
+        *buffer++ = '0' + frac / 1000;
+        frac %= 1000;
+    }
+    *buffer = '\0';
+}
+
 void format_mac(uint8_t *mac, char *buffer) {
     for (int i = 0; i < 6; i++) {
         *buffer++ = hex_chars[(mac[i] >> 4) & 0xF];
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""
+fbsnap_decode.py - Decode a framebuffer snapshot captured from the UART
+
+Usage: fbsnap_decode.py <capture> [output.png|output.ppm]
+
+The capture may contain other serial output (boot log) around the
+snapshot; the decoder scans for the "FBSNAP" magic. If the capture holds
+several snapshots, each one is written (out.png, out-1.png, ...).
+See include/snapshot.h for the stream format.
+"""
+
+import struct
+import sys
+import zlib
+
+MAGIC = b"FBSNAP"
+TRAILER = b"FBEND"
+
+ROW_REPEAT = 0x00
+ROW_OPS = 0x01
+
+OP_UP = 0
+OP_FILL = 1
+OP_LIT = 2
+
+FNV_OFFSET = 0x811C9DC5
+FNV_PRIME = 0x01000193
+
+
+class DecodeError(Exception):
+    pass
+
+
+def fnv1a(data):
+    h = FNV_OFFSET
+    for b in data:
+        h = ((h ^ b) * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def decode(buf, pos):
+    """Decode one snapshot starting at the magic. Returns (w, h, rgb, end)."""
+    pos += len(MAGIC)
+    version, fmt, width, height = struct.unpack_from("<BBHH", buf, pos)
+    pos += 6
+    if version != 1 or fmt != 0:
+        raise DecodeError("unsupported version %d / format %d" % (version, fmt))
+
+    start = pos
+    stride = width * 3
+    prev = bytes(stride)
+    out = bytearray()
+
+    def count_of(op):
+        nonlocal pos
+        n = op & 0x3F
+        if n < 63:
+            return n + 1
+        value, shift = 0, 0
+        while True:
+            b = buf[pos]
+            pos += 1
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return 64 + value
+
+    for _ in range(height):
+        kind = buf[pos]
+        pos += 1
+        if kind == ROW_REPEAT:
+            row = prev
+        elif kind == ROW_OPS:
+            row = bytearray()
+            while len(row) < stride:
+                op = buf[pos]
+                pos += 1
+                n = count_of(op)
+                kind = op >> 6
+                if kind == OP_UP:
+                    x = len(row)
+                    row += prev[x:x + n * 3]
+                elif kind == OP_FILL:
+                    row += buf[pos:pos + 3] * n
+                    pos += 3
+                elif kind == OP_LIT:
+                    row += buf[pos:pos + n * 3]
+                    pos += n * 3
+                else:
+                    raise DecodeError("bad op 0x%02x" % op)
+            if len(row) != stride:
+                raise DecodeError("row overrun")
+            row = bytes(row)
+        else:
+            raise DecodeError("bad row record 0x%02x" % kind)
+        out += row
+        prev = row
+
+    length = pos - start
+    if buf[pos:pos + len(TRAILER)] != TRAILER:
+        raise DecodeError("missing trailer")
+    pos += len(TRAILER)
+    sent_len, sent_hash = struct.unpack_from("<II", buf, pos)
+    pos += 8
+    if sent_len != length or sent_hash != fnv1a(buf[start:start + length]):
+        raise DecodeError("length/checksum mismatch (truncated capture?)")
+
+    return width, height, bytes(out), pos
+
+
+def write_ppm(path, width, height, rgb):
+    with open(path, "wb") as f:
+        f.write(b"P6\n%d %d\n255\n" % (width, height))
+        f.write(rgb)
+
+
+def write_png(path, width, height, rgb):
+    stride = width * 3
+    raw = b"".join(b"\x00" + rgb[y * stride:(y + 1) * stride]
+                   for y in range(height))
+
+    def chunk(tag, data):
+        body = tag + data
+        return (struct.pack(">I", len(data)) + body +
+                struct.pack(">I", zlib.crc32(body) & 0xFFFFFFFF))
+
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, height,
+                                           8, 2, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(raw, 9)))
+        f.write(chunk(b"IEND", b""))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    with open(sys.argv[1], "rb") as f:
+        buf = f.read()
+    output = sys.argv[2] if len(sys.argv) > 2 else "snapshot.png"
+    base, dot, ext = output.rpartition(".")
+    if not dot:
+        base, ext = output, "png"
+
+    count = 0
+    pos = buf.find(MAGIC)
+    while pos >= 0:
+        try:
+            width, height, rgb, end = decode(buf, pos)
+        except (DecodeError, IndexError, struct.error) as e:
+            print("snapshot at offset %d: %s" % (pos, e), file=sys.stderr)
+            pos = buf.find(MAGIC, pos + 1)
+            continue
+
+        path = "%s.%s" % (base, ext) if count == 0 else \
+               "%s-%d.%s" % (base, count, ext)
+        (write_png if ext.lower() == "png" else write_ppm)(path, width,
+                                                           height, rgb)
+        encoded = end - pos
+        print("%s: %dx%d, %d bytes on the wire (%.1f%% of raw %d)" %
+              (path, width, height, encoded,
+               100.0 * encoded / (width * height * 4), width * height * 4))
+        count += 1
+        pos = buf.find(MAGIC, end)
+
+    if count == 0:
+        print("no snapshot found in %s" % sys.argv[1], file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
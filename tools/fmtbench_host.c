@@ -0,0 +1,195 @@
+/*
+ * fmtbench_host.c - Host check and microbenchmark of kformat
+ *
+ * Builds src/lib/kprintf.c for the host (make fmtbench-host) and:
+ *   - checks kformat() against the C library's snprintf(): fixed cases,
+ *     then FMT_RANDOM random %d/%i/%u/%x/%X conversions, 32 and 64-bit,
+ *     with random flags, widths and precisions;
+ *   - times the three lines kernel_main draws (resolution, memory,
+ *     temperature range) built with kformat and with snprintf.
+ * The in-kernel "format" benchmark (fmtbench.c) measures the same lines
+ * on the target against the old utoa/strcat chains.
+ *
+ * kformat deliberately differs from C in one place: a zero value with
+ * precision .0 prints "0" (C prints nothing). The random cases avoid it.
+ *
+ * Usage: fmtbench_host [random cases]
+ * Exit status is non-zero on any mismatch.
+ */
+
+/* Kernel types.h first: the system headers then redefine NULL cleanly */
+#include "kprintf.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FMT_RANDOM      2000000
+#define FMT_ROUNDS      2000000
+
+/* Mismatches printed before going quiet */
+#define MAX_REPORTS     10
+
+static uint64_t failures;
+
+/* kprintf.c's UART sink; nothing here prints through it */
+void uart_putc(char c) {
+    putchar(c);
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static uint64_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void report(const char *fmt, const char *got, size_t got_n, const char *want, int want_n) {
+    if (failures++ < MAX_REPORTS) {
+        printf("\"%s\": kformat \"%s\" (%zu), snprintf \"%s\" (%d)\n", fmt, got, got_n, want, want_n);
+    }
+}
+
+/* Format with both and compare text and length */
+#define CHECK(fmt, ...) do {                                            \
+        char got_[128], want_[128];                                     \
+        size_t got_n_ = kformat(got_, sizeof(got_), fmt, __VA_ARGS__);  \
+        int want_n_ = snprintf(want_, sizeof(want_), fmt, __VA_ARGS__); \
+        if (strcmp(got_, want_) != 0 || got_n_ != (size_t)want_n_) {    \
+            report(fmt, got_, got_n_, want_, want_n_);                  \
+        }                                                               \
+    } while (0)
+
+static void check_fixed(void) {
+    CHECK("%u x %u @ %ubpp", 1920u, 1080u, 32u);
+    CHECK("%u MB @ 0x%08X", 948u, 0u);
+    CHECK("%d|%i|%d", 0, -1, (int)0x80000000);
+    CHECK("%ld|%lld|%zu", (long)-9223372036854775807L - 1, 123456789012345LL, (size_t)~0ul);
+    CHECK("%lu|%lx|%lX", ~0ul, 0xDEADBEEFCAFEF00Dul, 0xDEADBEEFCAFEF00Dul);
+    CHECK("[%5d][%-5d][%05d]", 42, 42, -42);
+    CHECK("[%.3u][%8.3u][%-8.3x][%08x]", 7u, 7u, 0xAu, 0xBEEFu);
+    CHECK("[%*d][%-*d][%.*u]", 6, -3, 6, -3, 4, 9u);
+    CHECK("[%s][%10s][%-10s][%.3s]", "abc", "abc", "abc", "abcdef");
+    CHECK("[%c%c][%%][%5c]", 'o', 'k', 'x');
+    CHECK("%u.%03u s, %2u%%", 12u, 5u, 7u);
+}
+
+/* One random integer conversion: flags, width, precision, length */
+static void check_random(uint64_t rounds) {
+    static const char convs[] = "diuxX";
+
+    for (uint64_t i = 0; i < rounds; i++) {
+        uint64_t r = rng();
+        uint64_t v = rng();
+        char fmt[32];
+        char *p = fmt;
+        bool longs = r & 1;
+        char conv = convs[(r >> 1) % 5];
+        uint32_t width = (r >> 4) & 0x1F;
+        int prec = (r >> 9) & 1 ? (int)((r >> 10) % 22) : -1;
+
+        /* Small values too, so padding and the one-digit paths get hit */
+        switch ((r >> 16) & 3) {
+        case 0:
+            v &= 0xFF;
+            break;
+        case 1:
+            v &= 0xFFFFF;
+            break;
+        default:
+            break;
+        }
+        if (prec == 0 && (longs ? v : (uint32_t)v) == 0) {
+            prec = 1;
+        }
+
+        *p++ = '%';
+        if ((r >> 18) & 1) {
+            *p++ = '-';
+        }
+        if ((r >> 19) & 1) {
+            *p++ = '0';
+        }
+        if (width) {
+            p += sprintf(p, "%u", width);
+        }
+        if (prec >= 0) {
+            p += sprintf(p, ".%d", prec);
+        }
+        if (longs) {
+            *p++ = 'l';
+        }
+        *p++ = conv;
+        *p = '\0';
+
+        if (longs) {
+            CHECK(fmt, v);
+        } else {
+            CHECK(fmt, (uint32_t)v);
+        }
+    }
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Inputs read through volatiles so neither side is constant-folded */
+static volatile uint32_t in_width = 1920, in_height = 1080, in_depth = 32;
+static volatile uint32_t in_mem_size = 948 * 1024 * 1024, in_mem_base = 0;
+static volatile uint32_t in_temp = 48312, in_min = 45120, in_max = 51004, in_avg = 47777;
+
+/* The kernel_main lines (fmtbench.c) with either formatter */
+#define FORMAT_LINES(fn, res, mem, range, size) do {                                    \
+        uint32_t t = in_temp, lo = in_min, hi = in_max, avg = in_avg;                   \
+        fn(res, size, "%u x %u @ %ubpp", in_width, in_height, in_depth);                \
+        fn(mem, size, "%u MB @ 0x%08X", in_mem_size / (1024 * 1024), in_mem_base);      \
+        fn(range, size, "%u.%u C (%u.%u-%u.%u avg %u.%u)",                              \
+           t / 1000, t % 1000 / 100, lo / 1000, lo % 1000 / 100,                        \
+           hi / 1000, hi % 1000 / 100, avg / 1000, avg % 1000 / 100);                   \
+    } while (0)
+
+static void bench(void) {
+    char res[64], mem[64], range[64];
+    char res2[64], mem2[64], range2[64];
+    double t0, k_ns, s_ns;
+
+    t0 = now_ns();
+    for (uint32_t i = 0; i < FMT_ROUNDS; i++) {
+        FORMAT_LINES(kformat, res, mem, range, sizeof(res));
+        asm volatile("" ::: "memory");
+    }
+    k_ns = (now_ns() - t0) / FMT_ROUNDS;
+
+    t0 = now_ns();
+    for (uint32_t i = 0; i < FMT_ROUNDS; i++) {
+        FORMAT_LINES(snprintf, res2, mem2, range2, sizeof(res2));
+        asm volatile("" ::: "memory");
+    }
+    s_ns = (now_ns() - t0) / FMT_ROUNDS;
+
+    printf("kformat  (3 lines): %7.1f ns\n", k_ns);
+    printf("snprintf (3 lines): %7.1f ns  (kformat %.2fx)\n", s_ns, s_ns / k_ns);
+    if (strcmp(res, res2) != 0 || strcmp(mem, mem2) != 0 || strcmp(range, range2) != 0) {
+        printf("OUTPUT MISMATCH\n");
+        failures++;
+    }
+    printf("%s | %s | %s\n", res, mem, range);
+}
+
+int main(int argc, char **argv) {
+    uint64_t rounds = argc > 1 ? strtoull(argv[1], NULL, 0) : FMT_RANDOM;
+
+    check_fixed();
+    check_random(rounds);
+    printf("kformat vs snprintf: fixed cases + %llu random, %llu mismatches\n",
+           (unsigned long long)rounds, (unsigned long long)failures);
+
+    bench();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""
+footprint.py - Image and stack footprint report
+
+Usage: footprint.py <kernel.elf> <object.o>...
+
+Prints three tables:
+  - the sections of the linked image (address, size), including the
+    NOLOAD .dma and .stacks regions
+  - text/rodata/data/bss per object file, largest first, from the
+    object's own section headers (before --gc-sections or merging)
+  - the largest stack frames, from the .su files gcc writes next to
+    each object with -fstack-usage
+
+Only the ELF section headers are read, so no cross binutils are needed.
+"""
+
+import os
+import struct
+import sys
+
+SHT_NOBITS = 8
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+SHF_EXECINSTR = 0x4
+
+TOP_FRAMES = 15
+
+
+def sections(path):
+    """Yield (name, type, flags, addr, size) for each section of an ELF64 file."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF" or data[4] != 2:
+        raise ValueError(f"{path}: not an ELF64 file")
+
+    shoff, = struct.unpack_from("<Q", data, 0x28)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x3A)
+
+    headers = []
+    for i in range(shnum):
+        headers.append(struct.unpack_from("<IIQQQQIIQQ", data, shoff + i * shentsize))
+
+    strtab = headers[shstrndx]
+    str_off = strtab[4]
+    for name_off, sh_type, flags, addr, _off, size, *_ in headers:
+        end = data.index(b"\0", str_off + name_off)
+        yield data[str_off + name_off:end].decode(), sh_type, flags, addr, size
+
+
+def classify(sh_type, flags):
+    """Bucket an allocated section: text, rodata, data or bss."""
+    if sh_type == SHT_NOBITS:
+        return "bss"
+    if flags & SHF_EXECINSTR:
+        return "text"
+    if flags & SHF_WRITE:
+        return "data"
+    return "rodata"
+
+
+def image_report(elf):
+    print(f"Image sections ({elf})")
+    print(f"  {'section':<12} {'address':>10} {'size':>10}")
+    total = 0
+    for name, sh_type, flags, addr, size in sections(elf):
+        if flags & SHF_ALLOC and size:
+            print(f"  {name:<12} {addr:#10x} {size:>10}")
+            total += size
+    print(f"  {'total':<12} {'':>10} {total:>10}")
+    print()
+
+
+def object_report(objects):
+    rows = []
+    for obj in objects:
+        sizes = {"text": 0, "rodata": 0, "data": 0, "bss": 0}
+        for _name, sh_type, flags, _addr, size in sections(obj):
+            if flags & SHF_ALLOC:
+                sizes[classify(sh_type, flags)] += size
+        rows.append((obj, sizes))
+
+    rows.sort(key=lambda r: sum(r[1].values()), reverse=True)
+    print("Per object (bytes)")
+    print(f"  {'text':>8} {'rodata':>8} {'data':>8} {'bss':>8} {'total':>8}  object")
+    totals = {"text": 0, "rodata": 0, "data": 0, "bss": 0}
+    for obj, s in rows:
+        for k in totals:
+            totals[k] += s[k]
+        print(f"  {s['text']:>8} {s['rodata']:>8} {s['data']:>8} {s['bss']:>8} "
+              f"{sum(s.values()):>8}  {obj}")
+    print(f"  {totals['text']:>8} {totals['rodata']:>8} {totals['data']:>8} "
+          f"{totals['bss']:>8} {sum(totals.values()):>8}  (sum)")
+    print()
+
+
+def stack_report(objects):
+    frames = []
+    for obj in objects:
+        su = os.path.splitext(obj)[0] + ".su"
+        if not os.path.exists(su):
+            continue
+        with open(su) as f:
+            for line in f:
+                parts = line.rstrip("\n").split("\t")
+                if len(parts) >= 3:
+                    frames.append((int(parts[1]), parts[2], parts[0]))
+
+    if not frames:
+        print("No .su files (build with -fstack-usage)")
+        return
+
+    frames.sort(reverse=True)
+    print(f"Largest stack frames (of {len(frames)} functions)")
+    for size, kind, where in frames[:TOP_FRAMES]:
+        print(f"  {size:>8}  {kind:<16} {where}")
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    image_report(sys.argv[1])
+    objects = [o for o in sys.argv[2:] if os.path.exists(o)]
+    object_report(objects)
+    stack_report(objects)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
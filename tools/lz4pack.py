@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""
+lz4pack.py - Build the self-decompressing kernel image
+
+Usage: lz4pack.py <stub.bin> <kernel8.img> <kernel __end (hex)> <output.img>
+
+Compresses kernel8.img as a single LZ4 block, fills in the header at
+the end of the stub (see src/lz4stub.S) and writes stub + payload.
+The stub relocates itself above max(__end, end of the packed image),
+rounded up to 64 KB, before inflating the kernel to 0x80000.
+"""
+
+import struct
+import sys
+
+STUB_MAGIC = 0x4C5A3453
+LOAD_ADDR = 0x80000
+RELOC_ALIGN = 0x10000
+HEADER_SIZE = 40
+
+MIN_MATCH = 4
+MF_LIMIT = 12           # Last match must start this far from the end
+LAST_LITERALS = 5       # ...and end this far from it
+MAX_OFFSET = 0xFFFF
+
+
+def put_length(out, n):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+
+def emit(out, literals, offset=0, match_len=0):
+    lit_len = len(literals)
+    ml = match_len - MIN_MATCH if match_len else 0
+    out.append((min(lit_len, 15) << 4) | min(ml, 15))
+    if lit_len >= 15:
+        put_length(out, lit_len - 15)
+    out += literals
+    if match_len:
+        out += struct.pack("<H", offset)
+        if ml >= 15:
+            put_length(out, ml - 15)
+
+
+def compress(data):
+    """Greedy LZ4 block compressor (hash of the next 4 bytes -> last position)."""
+    n = len(data)
+    out = bytearray()
+    table = {}
+    anchor = 0
+    i = 0
+
+    while i + MF_LIMIT <= n:
+        key = data[i:i + MIN_MATCH]
+        cand = table.get(key)
+        table[key] = i
+
+        if cand is None or i - cand > MAX_OFFSET:
+            i += 1
+            continue
+
+        length = MIN_MATCH
+        limit = n - LAST_LITERALS - i
+        while length < limit and data[cand + length] == data[i + length]:
+            length += 1
+
+        # Extend backwards over pending literals
+        while i > anchor and cand > 0 and data[i - 1] == data[cand - 1]:
+            i -= 1
+            cand -= 1
+            length += 1
+
+        emit(out, data[anchor:i], i - cand, length)
+        i += length
+        anchor = i
+        if i - 2 >= 0 and i + MIN_MATCH <= n:
+            table[data[i - 2:i + 2]] = i - 2
+
+    emit(out, data[anchor:])
+    return bytes(out)
+
+
+def decompress(block):
+    """Reference decoder, used to check the output before writing it."""
+    out = bytearray()
+    i = 0
+    while i < len(block):
+        token = block[i]
+        i += 1
+        lit = token >> 4
+        if lit == 15:
+            while True:
+                b = block[i]
+                i += 1
+                lit += b
+                if b != 255:
+                    break
+        out += block[i:i + lit]
+        i += lit
+        if i >= len(block):
+            break
+        offset = block[i] | (block[i + 1] << 8)
+        i += 2
+        ml = token & 15
+        if ml == 15:
+            while True:
+                b = block[i]
+                i += 1
+                ml += b
+                if b != 255:
+                    break
+        for _ in range(ml + MIN_MATCH):
+            out.append(out[-offset])
+    return bytes(out)
+
+
+def main():
+    if len(sys.argv) != 5:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    with open(sys.argv[1], "rb") as f:
+        stub = bytearray(f.read())
+    with open(sys.argv[2], "rb") as f:
+        kernel = f.read()
+    kernel_end = int(sys.argv[3], 16)
+
+    header = len(stub) - HEADER_SIZE
+    if header < 0 or struct.unpack_from("<Q", stub, header)[0] != STUB_MAGIC:
+        print("%s: stub header not found" % sys.argv[1], file=sys.stderr)
+        return 1
+
+    payload = compress(kernel)
+    if decompress(payload) != kernel:
+        print("internal error: LZ4 round trip failed", file=sys.stderr)
+        return 1
+
+    image_end = LOAD_ADDR + len(stub) + len(payload)
+    reloc = max(kernel_end, image_end)
+    reloc = (reloc + RELOC_ALIGN - 1) & ~(RELOC_ALIGN - 1)
+
+    struct.pack_into("<QQQQQ", stub, header, STUB_MAGIC, LOAD_ADDR,
+                     len(kernel), len(payload), reloc)
+
+    with open(sys.argv[4], "wb") as f:
+        f.write(stub)
+        f.write(payload)
+
+    total = len(stub) + len(payload)
+    print("%s: %d bytes (stub %d + payload %d), %.1f%% of %d; "
+          "relocates to 0x%x" % (sys.argv[4], total, len(stub), len(payload),
+                                 100.0 * total / len(kernel), len(kernel),
+                                 reloc))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
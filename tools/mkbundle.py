@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+mkbundle.py - Pack a directory of assets into one indexed archive
+
+Usage: mkbundle.py <asset dir> <output>
+
+Layout (little endian, offsets from the start of the bundle):
+
+  header   magic "ABND", entry count, hash slots (power of two),
+           total size
+  index    one 16-byte slot per hash slot: FNV-1a hash of the name,
+           name offset, data offset, size; empty slots have name
+           offset 0xFFFFFFFF. Lookup probes linearly from hash & (slots - 1)
+  names    NUL-terminated file names
+  data     each file, 16-byte aligned
+
+Files ending in .txt become string tables: every line is stored
+NUL-terminated, so the kernel can hand out pointers to them in place.
+Everything else is stored as is. Files starting with '.' are skipped.
+The layout must match include/assets.h.
+"""
+
+import os
+import struct
+import sys
+
+MAGIC = b"ABND"
+EMPTY = 0xFFFFFFFF
+ALIGN = 16
+
+
+def fnv1a(name):
+    h = 0x811C9DC5
+    for b in name.encode():
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def load(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if path.endswith(".txt"):
+        lines = data.decode().splitlines()
+        data = b"".join(line.encode() + b"\0" for line in lines)
+    return data
+
+
+def pad(buf):
+    return buf + b"\0" * (-len(buf) % ALIGN)
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    src = sys.argv[1]
+    files = sorted(f for f in os.listdir(src)
+                   if not f.startswith(".") and os.path.isfile(os.path.join(src, f)))
+
+    slots = 1
+    while slots < 2 * max(len(files), 1):
+        slots *= 2
+
+    index_size = slots * 16
+    names = b""
+    name_offsets = []
+    base = 16 + index_size
+    for name in files:
+        name_offsets.append(base + len(names))
+        names += name.encode() + b"\0"
+
+    data = b""
+    entries = []
+    data_base = base + len(pad(names))
+    for name, name_off in zip(files, name_offsets):
+        blob = load(os.path.join(src, name))
+        entries.append((fnv1a(name), name_off, data_base + len(data), len(blob)))
+        data = pad(data + blob)
+
+    index = [(0, EMPTY, 0, 0)] * slots
+    for entry in entries:
+        slot = entry[0] & (slots - 1)
+        while index[slot][1] != EMPTY:
+            slot = (slot + 1) & (slots - 1)
+        index[slot] = entry
+
+    total = data_base + len(data)
+    out = MAGIC + struct.pack("<III", len(files), slots, total)
+    out += b"".join(struct.pack("<IIII", *e) for e in index)
+    out += pad(names) + data
+    assert len(out) == total
+
+    with open(sys.argv[2], "wb") as f:
+        f.write(out)
+    print(f"{sys.argv[2]}: {len(files)} assets, {total} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,356 @@
+/*
+ * qoi_check.c - Host check of the kernel's QOI decoder
+ *
+ * Builds src/lib/qoi.c for the host (make qoi-check) and decodes every
+ * image given on the command line row by row, as fb_draw_qoi() does,
+ * comparing each pixel against:
+ *   - a plain decoder written straight from the reference qoi.h
+ *     (https://github.com/phoboslab/qoi), always;
+ *   - a reference image, when a .ppm (P6) or .pam (P7) follows the
+ *     .qoi on the command line, e.g. the file it was encoded from
+ *     with tools/qoi_encode.py (QOI is lossless).
+ * A few hand-built streams run first, for cases encoders rarely emit
+ * (an index hit on a pixel that only ever appeared in a run).
+ *
+ * Usage: qoi_check [image.qoi [reference.ppm|reference.pam]]...
+ * Exit status is non-zero on any mismatch or unreadable file.
+ */
+
+/* Kernel types.h first: the system headers then redefine NULL cleanly */
+#include "qoi.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REF_OP_INDEX    0x00
+#define REF_OP_DIFF     0x40
+#define REF_OP_LUMA     0x80
+#define REF_OP_RUN      0xC0
+#define REF_OP_RGB      0xFE
+#define REF_OP_RGBA     0xFF
+#define REF_MASK_2      0xC0
+
+/* Mismatches printed per image before going quiet */
+#define MAX_REPORTS     8
+
+typedef struct {
+    uint8_t r, g, b, a;
+} rgba_t;
+
+static uint32_t argb(rgba_t c) {
+    return ((uint32_t)c.a << 24) | ((uint32_t)c.r << 16) | ((uint32_t)c.g << 8) | c.b;
+}
+
+/*
+ * ref_decode - Whole-image decode, following the reference decoder
+ * @data: QOI file contents
+ * @size: Bytes of data
+ * @out: width * height pixels (0xAARRGGBB)
+ */
+static void ref_decode(const uint8_t *data, uint32_t size, uint32_t *out,
+                       uint32_t width, uint32_t height) {
+    rgba_t index[64];
+    rgba_t px = { 0, 0, 0, 255 };
+    uint32_t p = QOI_HEADER_SIZE;
+    uint32_t chunks_len = size - QOI_PADDING_SIZE;
+    uint32_t run = 0;
+
+    memset(index, 0, sizeof(index));
+
+    for (uint32_t i = 0; i < width * height; i++) {
+        if (run > 0) {
+            run--;
+        } else if (p < chunks_len) {
+            uint32_t b1 = data[p++];
+
+            if (b1 == REF_OP_RGB) {
+                px.r = data[p++];
+                px.g = data[p++];
+                px.b = data[p++];
+            } else if (b1 == REF_OP_RGBA) {
+                px.r = data[p++];
+                px.g = data[p++];
+                px.b = data[p++];
+                px.a = data[p++];
+            } else if ((b1 & REF_MASK_2) == REF_OP_INDEX) {
+                px = index[b1];
+            } else if ((b1 & REF_MASK_2) == REF_OP_DIFF) {
+                px.r += ((b1 >> 4) & 0x03) - 2;
+                px.g += ((b1 >> 2) & 0x03) - 2;
+                px.b += (b1 & 0x03) - 2;
+            } else if ((b1 & REF_MASK_2) == REF_OP_LUMA) {
+                uint32_t b2 = data[p++];
+                int vg = (b1 & 0x3F) - 32;
+                px.r += vg - 8 + ((b2 >> 4) & 0x0F);
+                px.g += vg;
+                px.b += vg - 8 + (b2 & 0x0F);
+            } else {
+                run = b1 & 0x3F;
+            }
+
+            index[(px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64] = px;
+        }
+        out[i] = argb(px);
+    }
+}
+
+static uint8_t *read_file(const char *path, uint32_t *size) {
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+    long len;
+
+    if (f == NULL) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc(len > 0 ? len : 1);
+    if (buf == NULL || fread(buf, 1, len, f) != (size_t)len) {
+        free(buf);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    *size = (uint32_t)len;
+    return buf;
+}
+
+/* Next whitespace-separated PPM header token (skips # comments) */
+static const char *next_token(const uint8_t *buf, uint32_t size, uint32_t *pos, uint32_t *value) {
+    while (*pos < size) {
+        if (buf[*pos] == '#') {
+            while (*pos < size && buf[*pos] != '\n') {
+                (*pos)++;
+            }
+        } else if (buf[*pos] == ' ' || buf[*pos] == '\t' || buf[*pos] == '\r' || buf[*pos] == '\n') {
+            (*pos)++;
+        } else {
+            break;
+        }
+    }
+    if (*pos >= size || buf[*pos] < '0' || buf[*pos] > '9') {
+        return "bad header";
+    }
+    *value = 0;
+    while (*pos < size && buf[*pos] >= '0' && buf[*pos] <= '9') {
+        *value = *value * 10 + (buf[(*pos)++] - '0');
+    }
+    return NULL;
+}
+
+/*
+ * read_reference - Load a binary PPM (P6) or 8-bit RGB/RGBA PAM (P7)
+ * @out: Set to width * height pixels (0xAARRGGBB), alpha 255 for RGB
+ * Returns: NULL, or what was wrong with the file
+ */
+static const char *read_reference(const char *path, uint32_t *width, uint32_t *height,
+                                  uint32_t **out) {
+    uint32_t size, pos = 2, depth = 3, maxval = 0;
+    uint8_t *buf = read_file(path, &size);
+    const char *err = NULL;
+
+    if (buf == NULL) {
+        return "cannot read";
+    }
+
+    if (size > 2 && buf[0] == 'P' && buf[1] == '6') {
+        if ((err = next_token(buf, size, &pos, width)) ||
+            (err = next_token(buf, size, &pos, height)) ||
+            (err = next_token(buf, size, &pos, &maxval))) {
+            free(buf);
+            return err;
+        }
+        pos++;                          /* Single whitespace after maxval */
+    } else if (size > 2 && buf[0] == 'P' && buf[1] == '7') {
+        *width = *height = 0;
+        while (pos < size) {
+            char line[64];
+            uint32_t len = 0;
+
+            while (pos < size && buf[pos] != '\n') {
+                if (len < sizeof(line) - 1) {
+                    line[len++] = buf[pos];
+                }
+                pos++;
+            }
+            pos++;
+            line[len] = '\0';
+
+            if (strcmp(line, "ENDHDR") == 0) {
+                break;
+            }
+            sscanf(line, "WIDTH %u", width);
+            sscanf(line, "HEIGHT %u", height);
+            sscanf(line, "DEPTH %u", &depth);
+            sscanf(line, "MAXVAL %u", &maxval);
+        }
+    } else {
+        free(buf);
+        return "not a binary PPM (P6) or PAM (P7) file";
+    }
+
+    if (maxval != 255 || (depth != 3 && depth != 4) || *width == 0 || *height == 0) {
+        free(buf);
+        return "only 8-bit RGB/RGBA is supported";
+    }
+    if (pos > size || size - pos < (uint64_t)*width * *height * depth) {
+        free(buf);
+        return "truncated pixel data";
+    }
+
+    *out = malloc((size_t)*width * *height * sizeof(uint32_t));
+    for (uint32_t i = 0; i < *width * *height; i++) {
+        const uint8_t *s = buf + pos + i * depth;
+        rgba_t c = { s[0], s[1], s[2], depth == 4 ? s[3] : 255 };
+        (*out)[i] = argb(c);
+    }
+    free(buf);
+    return NULL;
+}
+
+/* Pixel-by-pixel comparison; returns the number of differing pixels */
+static uint32_t compare(const char *name, const char *against, const uint32_t *got,
+                        const uint32_t *want, uint32_t width, uint32_t height) {
+    uint32_t bad = 0;
+
+    for (uint32_t i = 0; i < width * height; i++) {
+        if (got[i] == want[i]) {
+            continue;
+        }
+        if (bad < MAX_REPORTS) {
+            printf("%s: (%u, %u) is %08X, %s has %08X\n", name, i % width, i / width,
+                   got[i], against, want[i]);
+        }
+        bad++;
+    }
+    if (bad > MAX_REPORTS) {
+        printf("%s: ... %u pixels differ from %s\n", name, bad, against);
+    }
+    return bad;
+}
+
+/*
+ * check_image - Decode with qoi.c, compare with the reference decoder
+ * @ref_path: Reference image, or NULL
+ * Returns: true if every pixel matched
+ */
+static bool check_image(const char *name, const uint8_t *data, uint32_t size, const char *ref_path) {
+    qoi_decoder_t dec;
+    uint32_t *got, *want;
+    uint32_t bad;
+
+    if (!qoi_decode_init(&dec, data, size)) {
+        printf("%s: rejected by qoi_decode_init()\n", name);
+        return false;
+    }
+
+    got = malloc((size_t)dec.width * dec.height * sizeof(uint32_t));
+    want = malloc((size_t)dec.width * dec.height * sizeof(uint32_t));
+    for (uint32_t y = 0; y < dec.height; y++) {
+        qoi_decode_row(&dec, got + (size_t)y * dec.width);
+    }
+    ref_decode(data, size, want, dec.width, dec.height);
+    bad = compare(name, "reference decoder", got, want, dec.width, dec.height);
+
+    if (ref_path != NULL) {
+        uint32_t rw, rh, *ref;
+        const char *err = read_reference(ref_path, &rw, &rh, &ref);
+
+        if (err != NULL) {
+            printf("%s: %s\n", ref_path, err);
+            bad++;
+        } else if (rw != dec.width || rh != dec.height) {
+            printf("%s: %ux%u, %s is %ux%u\n", name, dec.width, dec.height, ref_path, rw, rh);
+            free(ref);
+            bad++;
+        } else {
+            bad += compare(name, ref_path, got, ref, dec.width, dec.height);
+            free(ref);
+        }
+    }
+
+    printf("%s: %ux%u, %u channels, %s\n", name, dec.width, dec.height, dec.channels,
+           bad ? "MISMATCH" : "ok");
+    free(got);
+    free(want);
+    return bad == 0;
+}
+
+/* Wrap ops in a header and the end marker */
+static uint32_t build_stream(uint8_t *out, uint32_t width, uint32_t height,
+                             const uint8_t *ops, uint32_t len) {
+    static const uint8_t end[QOI_PADDING_SIZE] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    uint32_t n = 0;
+
+    memcpy(out, "qoif", 4);
+    n = 4;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out[n++] = width >> shift;
+    }
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out[n++] = height >> shift;
+    }
+    out[n++] = QOI_CHANNELS_RGBA;
+    out[n++] = 0;
+    memcpy(out + n, ops, len);
+    n += len;
+    memcpy(out + n, end, sizeof(end));
+    return n + sizeof(end);
+}
+
+/* Hand-built streams, each checked against the reference decoder */
+static bool check_builtin(void) {
+    static const struct {
+        const char *name;
+        uint32_t width, height;
+        uint8_t ops[16];
+        uint32_t len;
+    } cases[] = {
+        /* Run of the initial pixel, then an index hit on it (slot 53) */
+        { "builtin/run-index", 4, 1, { 0xC1, 0xFE, 0xFF, 0x00, 0x00, 0x35 }, 6 },
+        /* Run across a row boundary, then diff and luma from it */
+        { "builtin/run-rows", 3, 3,
+          { 0xFF, 0x10, 0x20, 0x30, 0x80, 0xC3, 0x7F, 0xA8, 0x88, 0xC1 }, 10 },
+        /* Truncated: the last pixel repeats to the end */
+        { "builtin/truncated", 5, 2, { 0xFE, 0x01, 0x02, 0x03, 0x59 }, 5 },
+    };
+    uint8_t stream[64];
+    bool ok = true;
+
+    for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        uint32_t size = build_stream(stream, cases[i].width, cases[i].height,
+                                     cases[i].ops, cases[i].len);
+        ok &= check_image(cases[i].name, stream, size, NULL);
+    }
+    return ok;
+}
+
+static bool is_reference(const char *path) {
+    size_t len = strlen(path);
+    return len > 4 && (strcmp(path + len - 4, ".ppm") == 0 || strcmp(path + len - 4, ".pam") == 0);
+}
+
+int main(int argc, char **argv) {
+    bool ok = check_builtin();
+
+    for (int i = 1; i < argc; i++) {
+        const char *ref = i + 1 < argc && is_reference(argv[i + 1]) ? argv[i + 1] : NULL;
+        uint32_t size;
+        uint8_t *data = read_file(argv[i], &size);
+
+        if (data == NULL) {
+            printf("%s: cannot read\n", argv[i]);
+            ok = false;
+        } else {
+            ok &= check_image(argv[i], data, size, ref);
+            free(data);
+        }
+        if (ref != NULL) {
+            i++;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+qoi_encode.py - Convert a PPM/PAM image to QOI for embedding in the kernel
+
+Usage: qoi_encode.py <input.ppm|input.pam> <output.qoi>
+
+Reads binary PPM (P6, RGB) or PAM (P7, RGB or RGB_ALPHA, maxval 255)
+and writes a QOI file (https://qoiformat.org). Put the result under
+assets/ and add it to ASSETS in the Makefile. Export from an image
+editor as PPM/PAM, or e.g. `convert logo.png logo.pam`.
+"""
+
+import struct
+import sys
+
+OP_INDEX = 0x00
+OP_DIFF = 0x40
+OP_LUMA = 0x80
+OP_RUN = 0xC0
+OP_RGB = 0xFE
+OP_RGBA = 0xFF
+
+END_MARKER = b"\x00" * 7 + b"\x01"
+
+
+def read_tokens(buf, pos, count):
+    """Read `count` whitespace-separated header tokens (PPM allows comments)."""
+    tokens = []
+    while len(tokens) < count:
+        while buf[pos:pos + 1].isspace():
+            pos += 1
+        if buf[pos:pos + 1] == b"#":
+            pos = buf.index(b"\n", pos) + 1
+            continue
+        start = pos
+        while not buf[pos:pos + 1].isspace():
+            pos += 1
+        tokens.append(buf[start:pos])
+    return tokens, pos + 1
+
+
+def read_image(path):
+    """Returns (width, height, channels, pixel bytes)."""
+    with open(path, "rb") as f:
+        buf = f.read()
+
+    if buf[:2] == b"P6":
+        (w, h, maxval), pos = read_tokens(buf, 2, 3)
+        if int(maxval) != 255:
+            raise ValueError("only maxval 255 is supported")
+        w, h = int(w), int(h)
+        return w, h, 3, buf[pos:pos + w * h * 3]
+
+    if buf[:2] == b"P7":
+        fields, pos = {}, 3
+        while True:
+            end = buf.index(b"\n", pos)
+            line = buf[pos:end].strip()
+            pos = end + 1
+            if line == b"ENDHDR":
+                break
+            if line and not line.startswith(b"#"):
+                key, _, value = line.partition(b" ")
+                fields[key] = value.strip()
+        w, h = int(fields[b"WIDTH"]), int(fields[b"HEIGHT"])
+        depth = int(fields[b"DEPTH"])
+        if int(fields[b"MAXVAL"]) != 255 or depth not in (3, 4):
+            raise ValueError("only 8-bit RGB/RGBA PAM is supported")
+        return w, h, depth, buf[pos:pos + w * h * depth]
+
+    raise ValueError("not a binary PPM (P6) or PAM (P7) file")
+
+
+def encode(width, height, channels, pixels):
+    out = bytearray(b"qoif")
+    out += struct.pack(">IIBB", width, height, channels, 0)
+
+    index = [(0, 0, 0, 0)] * 64
+    prev = (0, 0, 0, 255)
+    run = 0
+    total = width * height
+
+    for i in range(total):
+        o = i * channels
+        r, g, b = pixels[o], pixels[o + 1], pixels[o + 2]
+        a = pixels[o + 3] if channels == 4 else 255
+        px = (r, g, b, a)
+
+        if px == prev:
+            run += 1
+            if run == 62 or i == total - 1:
+                out.append(OP_RUN | (run - 1))
+                run = 0
+            continue
+
+        if run:
+            out.append(OP_RUN | (run - 1))
+            run = 0
+
+        h = (r * 3 + g * 5 + b * 7 + a * 11) % 64
+        if index[h] == px:
+            out.append(OP_INDEX | h)
+        else:
+            index[h] = px
+            if a == prev[3]:
+                dr = (r - prev[0] + 128) % 256 - 128
+                dg = (g - prev[1] + 128) % 256 - 128
+                db = (b - prev[2] + 128) % 256 - 128
+                dr_dg, db_dg = dr - dg, db - dg
+                if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+                    out.append(OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2))
+                elif -32 <= dg <= 31 and -8 <= dr_dg <= 7 and -8 <= db_dg <= 7:
+                    out.append(OP_LUMA | (dg + 32))
+                    out.append((dr_dg + 8) << 4 | (db_dg + 8))
+                else:
+                    out += bytes((OP_RGB, r, g, b))
+            else:
+                out += bytes((OP_RGBA, r, g, b, a))
+        prev = px
+
+    out += END_MARKER
+    return bytes(out)
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    width, height, channels, pixels = read_image(sys.argv[1])
+    if len(pixels) != width * height * channels:
+        print("%s: truncated pixel data" % sys.argv[1], file=sys.stderr)
+        return 1
+
+    data = encode(width, height, channels, pixels)
+    with open(sys.argv[2], "wb") as f:
+        f.write(data)
+
+    raw = width * height * channels
+    print("%s: %dx%d, %d channels, %d bytes (%.1f%% of raw %d)" %
+          (sys.argv[2], width, height, channels, len(data),
+           100.0 * len(data) / raw, raw))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+"""
+trace_extract.py - Pull the event trace out of a serial capture
+
+Usage: trace_extract.py <capture> [output.json]
+
+The kernel frames the Chrome Trace Event JSON written by trace_dump()
+between marker lines; everything else in the capture (boot log,
+snapshots) is skipped. If the capture holds several dumps, each one is
+written (trace.json, trace-1.json, ...). Open the result in
+chrome://tracing or https://ui.perfetto.dev.
+"""
+
+import json
+import sys
+
+START = b"--- TRACE JSON BEGIN ---"
+END = b"--- TRACE JSON END ---"
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    with open(sys.argv[1], "rb") as f:
+        buf = f.read()
+    output = sys.argv[2] if len(sys.argv) > 2 else "trace.json"
+    base, dot, ext = output.rpartition(".")
+    if not dot:
+        base, ext = output, "json"
+
+    count = 0
+    pos = buf.find(START)
+    while pos >= 0:
+        end = buf.find(END, pos)
+        if end < 0:
+            print("trace %d: truncated capture" % count, file=sys.stderr)
+            break
+        text = buf[pos + len(START):end].decode("ascii", "replace")
+        try:
+            trace = json.loads(text)
+        except ValueError as e:
+            print("trace %d: bad JSON: %s" % (count, e), file=sys.stderr)
+        else:
+            name = output if count == 0 else "%s-%d.%s" % (base, count, ext)
+            with open(name, "w") as f:
+                json.dump(trace, f)
+            events = [e for e in trace["traceEvents"] if e["ph"] != "M"]
+            print("%s: %d events" % (name, len(events)))
+            count += 1
+        pos = buf.find(START, end)
+
+    if count == 0:
+        print("no trace found", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())